@@ -57,3 +57,17 @@ if (DBUS)
         PURPOSE "Required by the DBUS feature"
     )
 endif()
+if (PLUGINS_LUAJIT)
+    include(FindPkgConfig)
+    pkg_check_modules(LuaJIT REQUIRED IMPORTED_TARGET GLOBAL "luajit>=2.1")
+    # force a fake package to show up in the feature summary
+    set_property(GLOBAL APPEND PROPERTY
+        PACKAGES_FOUND
+        "LuaJIT via pkg-config (version >= 2.1)"
+    )
+    set_package_properties("LuaJIT via pkg-config (version >= 2.1)"
+        PROPERTIES
+        TYPE REQUIRED
+        PURPOSE "Required by the PLUGINS_LUAJIT feature"
+    )
+endif()
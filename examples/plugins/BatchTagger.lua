@@ -0,0 +1,23 @@
+NAME = "Batch Tagger Example"
+VERSION = "0.1"
+
+local COMPLETED_TAG = "completed"
+
+function onTorrentsUpdated(torrents)
+    -- Mutations collected in the batch are applied all at once later,
+    -- and the affected torrents are reported via single "onTorrentsBatchApplied" call.
+    local batch = qBittorrent.TorrentsBatch()
+    for _, torrent in ipairs(torrents) do
+        if torrent.progress >= 1 and not torrent:hasTag(COMPLETED_TAG) then
+            batch:addTag(torrent, COMPLETED_TAG)
+        end
+    end
+
+    if batch.size > 0 then
+        qBittorrent.applyBatch(batch)
+    end
+end
+
+function onTorrentsBatchApplied(torrents)
+    qBittorrent.log(string.format("Tagged %d torrents as %s", #torrents, COMPLETED_TAG))
+end
@@ -0,0 +1,25 @@
+NAME = "Swarm Health Example"
+VERSION = "0.1"
+
+function onTorrentFinished(torrent)
+    -- The torrent can be removed before the data is fetched,
+    -- so don't access it from the callbacks.
+    local torrentName = torrent.name
+
+    qBittorrent.fetchPieceAvailability(torrent, function(pieces)
+        qBittorrent.log(string.format("%s: Torrent '%s' has %d pieces. Least available piece is seen %d time(s).",
+                NAME, torrentName, pieces.count, pieces.minimum))
+    end)
+
+    qBittorrent.fetchPeers(torrent, function(peers)
+        local seeds = 0
+        for i = 0, (peers.count - 1) do
+            if peers:isSeed(i) then
+                seeds = seeds + 1
+            end
+            qBittorrent.debug(string.format("  %s (%s): %.1f%%", peers:address(i), peers:client(i), peers:progress(i) * 100))
+        end
+        qBittorrent.log(string.format("%s: Torrent '%s' is connected to %d peer(s), %d of them are seeds.",
+                NAME, torrentName, peers.count, seeds))
+    end)
+end
@@ -0,0 +1,10 @@
+// Wrapper that makes LuaJIT headers available at the same location as bundled Lua ones
+
+#pragma once
+
+#include <lua.hpp>
+
+// LuaJIT implements Lua 5.1 API, so provide the missing definitions used by qBittorrent
+#ifndef LUA_GNAME
+#define LUA_GNAME "_G"
+#endif
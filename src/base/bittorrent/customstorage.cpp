@@ -28,12 +28,75 @@
 
 #include "customstorage.h"
 
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <utility>
+
 #include <libtorrent/download_priority.hpp>
 
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QHash>
+
+#include "base/global.h"
+#include "base/logger.h"
 #include "base/utils/fs.h"
 #include "common.h"
 
+namespace
+{
+    // Progress of checking for completed files is logged only for the torrents having a lot of them
+    const qsizetype FILES_FIXUP_PROGRESS_STEP = 10'000;
+
+    void fixupCompleteFiles(const Path &savePath, const PathList &incompleteFilePaths)
+    {
+        const qsizetype filesCount = incompleteFilePaths.size();
+        const bool isProgressLogged = (filesCount >= FILES_FIXUP_PROGRESS_STEP);
+        if (isProgressLogged)
+        {
+            LogMsg(QCoreApplication::translate("CustomStorage", "Checking for completed files. Save path: \"%1\". Files: %2")
+                    .arg(savePath.toString(), QString::number(filesCount)));
+        }
+
+        QElapsedTimer timer;
+        timer.start();
+
+        PathList completeFilePaths;
+        completeFilePaths.reserve(filesCount);
+        for (const Path &filePath : incompleteFilePaths)
+            completeFilePaths.append((savePath / filePath).removedExtension(QB_EXT));
+
+        Utils::Fs::FileExistenceChecker fileExistenceChecker {completeFilePaths};
+        qsizetype processedCount = 0;
+        for (const Path &filePath : incompleteFilePaths)
+        {
+            const Path incompleteFilePath = savePath / filePath;
+            const Path completeFilePath = incompleteFilePath.removedExtension(QB_EXT);
+            if (fileExistenceChecker.exists(completeFilePath))
+            {
+                if (Utils::Fs::removeFile(incompleteFilePath))
+                    Utils::Fs::renameFile(completeFilePath, incompleteFilePath);
+            }
+
+            ++processedCount;
+            if (isProgressLogged && ((processedCount % FILES_FIXUP_PROGRESS_STEP) == 0) && (processedCount < filesCount))
+            {
+                LogMsg(QCoreApplication::translate("CustomStorage", "Checking for completed files. Save path: \"%1\". Progress: %2/%3")
+                        .arg(savePath.toString(), QString::number(processedCount), QString::number(filesCount)));
+            }
+        }
+
+        if (isProgressLogged)
+        {
+            LogMsg(QCoreApplication::translate("CustomStorage", "Finished checking for completed files. Save path: \"%1\". Elapsed time: %2 ms")
+                    .arg(savePath.toString(), QString::number(timer.elapsed())));
+        }
+    }
+}
+
 #ifdef QBT_USES_LIBTORRENT2
+#include <libtorrent/disk_observer.hpp>
 #include <libtorrent/mmap_disk_io.hpp>
 #include <libtorrent/posix_disk_io.hpp>
 #if LIBTORRENT_VERSION_NUM >= 20100
@@ -41,34 +104,388 @@
 #endif
 #include <libtorrent/session.hpp>
 
+#include <boost/asio/post.hpp>
+
+#include <QMutexLocker>
+
+namespace
+{
+    qsizetype latencyBucket(const std::chrono::steady_clock::duration latency)
+    {
+        const qint64 latencyUSecs = std::chrono::duration_cast<std::chrono::microseconds>(latency).count();
+        const auto it = std::ranges::find_if(BitTorrent::DISK_IO_LATENCY_BUCKETS
+                , [latencyUSecs](const qint64 bound) { return latencyUSecs < bound; });
+        return std::distance(BitTorrent::DISK_IO_LATENCY_BUCKETS.cbegin(), it);
+    }
+
+    // Moving of storage has no size known in advance so it is considered as an expensive job
+    const qint64 MOVE_JOB_COST = 16 * 1024 * 1024;
+
+    // Relative shares of disk bandwidth, so the transfers aren't starved by rechecking or moving of storages
+    int jobClassWeight(const DiskJobClass jobClass)
+    {
+        switch (jobClass)
+        {
+        case DiskJobClass::Read:
+        case DiskJobClass::Write:
+            return 8;
+        case DiskJobClass::Hash:
+            return 2;
+        case DiskJobClass::Move:
+            return 1;
+        }
+
+        return 1;
+    }
+
+    // Owns the buffers of the blocks served from the read cache
+    class CacheBufferAllocator final : public lt::buffer_allocator_interface
+    {
+    public:
+        static CacheBufferAllocator &instance()
+        {
+            static CacheBufferAllocator allocator;
+            return allocator;
+        }
+
+        void free_disk_buffer(char *buffer) override
+        {
+            delete[] buffer;
+        }
+    };
+}
+
+void DiskIOStatsCollector::addStorage(const lt::storage_index_t storage, const BitTorrent::TorrentID &torrentID)
+{
+    const QMutexLocker locker {&m_mutex};
+    m_storageStats[storage] = {.torrentID = torrentID, .stats = {}};
+}
+
+void DiskIOStatsCollector::removeStorage(const lt::storage_index_t storage)
+{
+    const QMutexLocker locker {&m_mutex};
+    m_storageStats.remove(storage);
+}
+
+void DiskIOStatsCollector::operationSubmitted(const lt::storage_index_t storage)
+{
+    const QMutexLocker locker {&m_mutex};
+    if (const auto it = m_storageStats.find(storage); it != m_storageStats.end())
+        ++it->stats.pendingCount;
+}
+
+void DiskIOStatsCollector::operationCompleted(const lt::storage_index_t storage, const OperationType type
+        , const qint64 bytes, const std::chrono::steady_clock::duration latency)
+{
+    const qsizetype bucket = latencyBucket(latency);
+
+    const QMutexLocker locker {&m_mutex};
+    const auto it = m_storageStats.find(storage);
+    if (it == m_storageStats.end()) // storage was removed meanwhile
+        return;
+
+    BitTorrent::DiskIOStats &stats = it->stats;
+    --stats.pendingCount;
+    switch (type)
+    {
+    case OperationType::Read:
+        ++stats.readCount;
+        stats.readBytes += bytes;
+        ++stats.readLatency[bucket];
+        break;
+    case OperationType::Write:
+        ++stats.writeCount;
+        stats.writtenBytes += bytes;
+        ++stats.writeLatency[bucket];
+        break;
+    case OperationType::Hash:
+        ++stats.hashCount;
+        ++stats.hashLatency[bucket];
+        break;
+    }
+}
+
+bool DiskIOStatsCollector::isFileExtentsEnabled() const
+{
+    return m_isFileExtentsEnabled.load(std::memory_order_relaxed);
+}
+
+void DiskIOStatsCollector::setFileExtentsEnabled(const bool enabled)
+{
+    if (m_isFileExtentsEnabled.exchange(enabled, std::memory_order_relaxed) == enabled)
+        return;
+
+    if (!enabled)
+    {
+        const QMutexLocker locker {&m_mutex};
+        for (StorageStats &storageStats : m_storageStats)
+        {
+            storageStats.stats.fileExtentsCount = -1;
+            storageStats.stats.fragmentedFilesCount = -1;
+        }
+    }
+}
+
+void DiskIOStatsCollector::setFileExtents(const lt::storage_index_t storage, const qint64 extentsCount, const qint64 fragmentedFilesCount)
+{
+    const QMutexLocker locker {&m_mutex};
+    if (const auto it = m_storageStats.find(storage); it != m_storageStats.end())
+    {
+        it->stats.fileExtentsCount = extentsCount;
+        it->stats.fragmentedFilesCount = fragmentedFilesCount;
+    }
+}
+
+QHash<BitTorrent::TorrentID, BitTorrent::DiskIOStats> DiskIOStatsCollector::stats() const
+{
+    const QMutexLocker locker {&m_mutex};
+
+    QHash<BitTorrent::TorrentID, BitTorrent::DiskIOStats> result;
+    result.reserve(m_storageStats.size());
+    for (const StorageStats &storageStats : m_storageStats)
+        result.insert(storageStats.torrentID, storageStats.stats);
+    return result;
+}
+
+qint64 PieceReadCache::capacity() const
+{
+    return m_capacity;
+}
+
+void PieceReadCache::setCapacity(const qint64 capacity)
+{
+    m_capacity = std::max<qint64>(capacity, 0);
+}
+
+bool PieceReadCache::isEnabled() const
+{
+    return (m_capacity > 0);
+}
+
+qint64 PieceReadCache::usedBytes() const
+{
+    return m_usedBytes;
+}
+
+qint64 PieceReadCache::hitCount() const
+{
+    return m_hitCount;
+}
+
+qint64 PieceReadCache::missCount() const
+{
+    return m_missCount;
+}
+
+bool PieceReadCache::containsPiece(const lt::storage_index_t storage, const lt::piece_index_t piece) const
+{
+    return m_pieces.contains(makeKey(storage, piece));
+}
+
+QByteArray PieceReadCache::findBlock(const lt::storage_index_t storage, const lt::peer_request &request)
+{
+    const auto pieceIter = m_pieces.find(makeKey(storage, request.piece));
+    if (pieceIter != m_pieces.end())
+    {
+        const QByteArray block = pieceIter->blocks.value(request.start);
+        if (block.size() == request.length)
+        {
+            ++m_hitCount;
+            m_lruList.splice(m_lruList.begin(), m_lruList, pieceIter->lruPos);
+            return block;
+        }
+    }
+
+    ++m_missCount;
+    return {};
+}
+
+void PieceReadCache::addPiece(const lt::storage_index_t storage, const lt::piece_index_t piece)
+{
+    const PieceKey key = makeKey(storage, piece);
+    if (m_pieces.contains(key))
+        return;
+
+    m_lruList.push_front(key);
+    m_pieces.insert(key, {.storage = storage, .blocks = {}, .size = 0, .lruPos = m_lruList.begin()});
+}
+
+void PieceReadCache::addBlock(const lt::storage_index_t storage, const lt::peer_request &request, const char *data)
+{
+    const auto pieceIter = m_pieces.find(makeKey(storage, request.piece));
+    if (pieceIter == m_pieces.end()) // piece was evicted or invalidated meanwhile
+        return;
+
+    CachedPiece &cachedPiece = *pieceIter;
+    if (cachedPiece.blocks.contains(request.start))
+        return;
+
+    cachedPiece.blocks.insert(request.start, QByteArray(data, request.length));
+    cachedPiece.size += request.length;
+    m_usedBytes += request.length;
+
+    trim();
+}
+
+void PieceReadCache::removePiece(const lt::storage_index_t storage, const lt::piece_index_t piece)
+{
+    removePiece(makeKey(storage, piece));
+}
+
+void PieceReadCache::removeStorage(const lt::storage_index_t storage)
+{
+    for (auto it = m_lruList.begin(); it != m_lruList.end();)
+    {
+        const PieceKey key = *it;
+        ++it;
+        if (m_pieces.value(key).storage == storage)
+            removePiece(key);
+    }
+}
+
+void PieceReadCache::trim()
+{
+    while (!m_lruList.empty() && ((m_capacity == 0) || (m_usedBytes > m_capacity)))
+        removePiece(m_lruList.back());
+}
+
+PieceReadCache::PieceKey PieceReadCache::makeKey(const lt::storage_index_t storage, const lt::piece_index_t piece)
+{
+    return (static_cast<PieceKey>(static_cast<std::uint32_t>(storage)) << 32)
+            | static_cast<std::uint32_t>(static_cast<int>(piece));
+}
+
+void PieceReadCache::removePiece(const PieceKey key)
+{
+    const auto pieceIter = m_pieces.find(key);
+    if (pieceIter == m_pieces.end())
+        return;
+
+    m_usedBytes -= pieceIter->size;
+    m_lruList.erase(pieceIter->lruPos);
+    m_pieces.erase(pieceIter);
+}
+
+int DiskJobLimits::totalLimit() const
+{
+    return m_totalLimit;
+}
+
+void DiskJobLimits::setTotalLimit(const int limit)
+{
+    m_totalLimit = std::max(limit, 0);
+}
+
+int DiskJobLimits::limit(const DiskJobClass jobClass) const
+{
+    return m_limits[static_cast<int>(jobClass)];
+}
+
+void DiskJobLimits::setLimit(const DiskJobClass jobClass, const int limit)
+{
+    m_limits[static_cast<int>(jobClass)] = std::max(limit, 0);
+}
+
+qint64 PreallocationPolicy::minFileSize() const
+{
+    const QMutexLocker locker {&m_mutex};
+    return m_minFileSize;
+}
+
+void PreallocationPolicy::setMinFileSize(const qint64 size)
+{
+    const QMutexLocker locker {&m_mutex};
+    m_minFileSize = std::max<qint64>(size, 0);
+}
+
+PathList PreallocationPolicy::savePaths() const
+{
+    const QMutexLocker locker {&m_mutex};
+    return m_savePaths;
+}
+
+void PreallocationPolicy::setSavePaths(const PathList &paths)
+{
+    const QMutexLocker locker {&m_mutex};
+    m_savePaths = paths;
+}
+
+bool PreallocationPolicy::isEnabled() const
+{
+#if defined(Q_OS_LINUX) || defined(Q_OS_MACOS)
+    const QMutexLocker locker {&m_mutex};
+    return ((m_minFileSize > 0) || !m_savePaths.isEmpty());
+#else
+    // files can't be preallocated on this platform (see Utils::Fs::preallocateFile())
+    return false;
+#endif
+}
+
+bool PreallocationPolicy::matchesSavePath(const Path &savePath) const
+{
+    const QMutexLocker locker {&m_mutex};
+    if (m_savePaths.isEmpty())
+        return true;
+
+    return std::ranges::any_of(m_savePaths, [&savePath](const Path &path)
+    {
+        return ((savePath == path) || savePath.hasAncestor(path));
+    });
+}
+
+bool PreallocationPolicy::matchesFileSize(const qint64 fileSize) const
+{
+    const QMutexLocker locker {&m_mutex};
+    return (fileSize >= m_minFileSize);
+}
+
 std::unique_ptr<lt::disk_interface> customDiskIOConstructor(
-        lt::io_context &ioContext, const lt::settings_interface &settings, lt::counters &counters)
+        lt::io_context &ioContext, const lt::settings_interface &settings, lt::counters &counters
+        , std::shared_ptr<DiskIOStatsCollector> statsCollector, std::shared_ptr<PieceReadCache> readCache
+        , std::shared_ptr<DiskJobLimits> jobLimits, std::shared_ptr<PreallocationPolicy> preallocationPolicy)
 {
-    return std::make_unique<CustomDiskIOThread>(lt::default_disk_io_constructor(ioContext, settings, counters));
+    return std::make_unique<CustomDiskIOThread>(ioContext, lt::default_disk_io_constructor(ioContext, settings, counters)
+            , std::move(statsCollector), std::move(readCache), std::move(jobLimits), std::move(preallocationPolicy));
 }
 
 std::unique_ptr<lt::disk_interface> customPosixDiskIOConstructor(
-        lt::io_context &ioContext, const lt::settings_interface &settings, lt::counters &counters)
+        lt::io_context &ioContext, const lt::settings_interface &settings, lt::counters &counters
+        , std::shared_ptr<DiskIOStatsCollector> statsCollector, std::shared_ptr<PieceReadCache> readCache
+        , std::shared_ptr<DiskJobLimits> jobLimits, std::shared_ptr<PreallocationPolicy> preallocationPolicy)
 {
-    return std::make_unique<CustomDiskIOThread>(lt::posix_disk_io_constructor(ioContext, settings, counters));
+    return std::make_unique<CustomDiskIOThread>(ioContext, lt::posix_disk_io_constructor(ioContext, settings, counters)
+            , std::move(statsCollector), std::move(readCache), std::move(jobLimits), std::move(preallocationPolicy));
 }
 
 std::unique_ptr<lt::disk_interface> customMMapDiskIOConstructor(
-        lt::io_context &ioContext, const lt::settings_interface &settings, lt::counters &counters)
+        lt::io_context &ioContext, const lt::settings_interface &settings, lt::counters &counters
+        , std::shared_ptr<DiskIOStatsCollector> statsCollector, std::shared_ptr<PieceReadCache> readCache
+        , std::shared_ptr<DiskJobLimits> jobLimits, std::shared_ptr<PreallocationPolicy> preallocationPolicy)
 {
-    return std::make_unique<CustomDiskIOThread>(lt::mmap_disk_io_constructor(ioContext, settings, counters));
+    return std::make_unique<CustomDiskIOThread>(ioContext, lt::mmap_disk_io_constructor(ioContext, settings, counters)
+            , std::move(statsCollector), std::move(readCache), std::move(jobLimits), std::move(preallocationPolicy));
 }
 
 #if LIBTORRENT_VERSION_NUM >= 20100
 std::unique_ptr<lt::disk_interface> customPreadDiskIOConstructor(
-        lt::io_context &ioContext, const lt::settings_interface &settings, lt::counters &counters)
+        lt::io_context &ioContext, const lt::settings_interface &settings, lt::counters &counters
+        , std::shared_ptr<DiskIOStatsCollector> statsCollector, std::shared_ptr<PieceReadCache> readCache
+        , std::shared_ptr<DiskJobLimits> jobLimits, std::shared_ptr<PreallocationPolicy> preallocationPolicy)
 {
-    return std::make_unique<CustomDiskIOThread>(lt::pread_disk_io_constructor(ioContext, settings, counters));
+    return std::make_unique<CustomDiskIOThread>(ioContext, lt::pread_disk_io_constructor(ioContext, settings, counters)
+            , std::move(statsCollector), std::move(readCache), std::move(jobLimits), std::move(preallocationPolicy));
 }
 #endif
 
-CustomDiskIOThread::CustomDiskIOThread(std::unique_ptr<libtorrent::disk_interface> nativeDiskIOThread)
-    : m_nativeDiskIO {std::move(nativeDiskIOThread)}
+CustomDiskIOThread::CustomDiskIOThread(lt::io_context &ioContext, std::unique_ptr<libtorrent::disk_interface> nativeDiskIOThread
+        , std::shared_ptr<DiskIOStatsCollector> statsCollector, std::shared_ptr<PieceReadCache> readCache
+        , std::shared_ptr<DiskJobLimits> jobLimits, std::shared_ptr<PreallocationPolicy> preallocationPolicy)
+    : m_ioContext {ioContext}
+    , m_nativeDiskIO {std::move(nativeDiskIOThread)}
+    , m_statsCollector {std::move(statsCollector)}
+    , m_readCache {std::move(readCache)}
+    , m_jobLimits {std::move(jobLimits)}
+    , m_preallocationPolicy {std::move(preallocationPolicy)}
 {
 }
 
@@ -84,13 +501,19 @@ lt::storage_holder CustomDiskIOThread::new_torrent(const lt::storage_params &sto
 #else
         .files = storageParams.mapped_files ? *storageParams.mapped_files : storageParams.files,
 #endif
-        .filePriorities = storageParams.priorities
+        .filePriorities = storageParams.priorities,
+        .isSparse = (storageParams.mode == lt::storage_mode_sparse)
     };
+    m_statsCollector->addStorage(storageHolder, BitTorrent::TorrentID(storageParams.info_hash));
     return storageHolder;
 }
 
 void CustomDiskIOThread::remove_torrent(lt::storage_index_t storage)
 {
+    dispatchQueuedJobs(storage);
+    m_statsCollector->removeStorage(storage);
+    m_readCache->removeStorage(storage);
+    std::erase_if(m_pendingReads, [storage](const auto &item) { return (std::get<0>(item.first) == storage); });
     m_nativeDiskIO->remove_torrent(storage);
 }
 
@@ -98,28 +521,218 @@ void CustomDiskIOThread::async_read(lt::storage_index_t storage, const lt::peer_
                                     , std::function<void (lt::disk_buffer_holder, const lt::storage_error &)> handler
                                     , lt::disk_job_flags_t flags)
 {
-    m_nativeDiskIO->async_read(storage, peerRequest, std::move(handler), flags);
+    m_statsCollector->operationSubmitted(storage);
+    const auto submitTime = std::chrono::steady_clock::now();
+
+    quint64 readID = 0;
+    // Capacity can be changed from another thread so the cache is trimmed lazily here
+    m_readCache->trim();
+    if (m_readCache->isEnabled())
+    {
+        if (const QByteArray block = m_readCache->findBlock(storage, peerRequest); !block.isNull())
+        {
+            // The handler must not be invoked before this function returns
+            boost::asio::post(m_ioContext, [=, this, handler = std::move(handler)]
+            {
+                auto *buffer = new char[block.size()];
+                std::memcpy(buffer, block.constData(), block.size());
+                m_statsCollector->operationCompleted(storage, DiskIOStatsCollector::OperationType::Read
+                        , peerRequest.length, (std::chrono::steady_clock::now() - submitTime));
+                handler(lt::disk_buffer_holder(CacheBufferAllocator::instance(), buffer, block.size()), {});
+            });
+            return;
+        }
+
+        // Peers request the blocks of a piece in sequence, so they usually arrive while the piece is read ahead
+        if (const auto pendingReadIter = m_pendingReads.find({storage, peerRequest.piece, peerRequest.start});
+                (pendingReadIter != m_pendingReads.end()) && (pendingReadIter->second.length == peerRequest.length))
+        {
+            pendingReadIter->second.waiters.append([=, this, handler = std::move(handler)](lt::disk_buffer_holder buffer, const lt::storage_error &error)
+            {
+                m_statsCollector->operationCompleted(storage, DiskIOStatsCollector::OperationType::Read
+                        , (error ? 0 : peerRequest.length), (std::chrono::steady_clock::now() - submitTime));
+                handler(std::move(buffer), error);
+            });
+            return;
+        }
+
+        if (!m_readCache->containsPiece(storage, peerRequest.piece))
+        {
+            // The piece that doesn't fit the cache would be evicted before its blocks are requested
+            const int pieceSize = m_storageData[storage].files.piece_size(peerRequest.piece);
+            if (pieceSize <= m_readCache->capacity())
+            {
+                m_readCache->addPiece(storage, peerRequest.piece);
+                readAhead(storage, peerRequest, flags);
+            }
+        }
+
+        if (m_readCache->containsPiece(storage, peerRequest.piece))
+            readID = addPendingRead(storage, peerRequest);
+    }
+
+    enqueueJob(DiskJobClass::Read, storage, peerRequest.length, [=, this, handler = std::move(handler)]() mutable
+    {
+        m_nativeDiskIO->async_read(storage, peerRequest
+                , [=, this, handler = std::move(handler)](lt::disk_buffer_holder buffer, const lt::storage_error &error)
+        {
+            m_statsCollector->operationCompleted(storage, DiskIOStatsCollector::OperationType::Read
+                    , (error ? 0 : peerRequest.length), (std::chrono::steady_clock::now() - submitTime));
+            if (readID != 0)
+                finishPendingRead(storage, peerRequest, readID, (buffer ? buffer.data() : nullptr), error);
+            handler(std::move(buffer), error);
+            finishJob(DiskJobClass::Read);
+        }, flags);
+    });
+}
+
+void CustomDiskIOThread::readAhead(const lt::storage_index_t storage, const lt::peer_request &peerRequest, const lt::disk_job_flags_t flags)
+{
+    const int pieceSize = m_storageData[storage].files.piece_size(peerRequest.piece);
+    for (int offset = 0; offset < pieceSize; offset += lt::default_block_size)
+    {
+        if (offset == peerRequest.start)
+            continue;
+
+        const lt::peer_request blockRequest
+        {
+            .piece = peerRequest.piece,
+            .start = offset,
+            .length = std::min(lt::default_block_size, (pieceSize - offset))
+        };
+
+        const quint64 readID = addPendingRead(storage, blockRequest);
+        if (readID == 0)
+            continue;
+
+        m_statsCollector->operationSubmitted(storage);
+        enqueueJob(DiskJobClass::Read, storage, blockRequest.length
+                , [=, this, submitTime = std::chrono::steady_clock::now()]
+        {
+            m_nativeDiskIO->async_read(storage, blockRequest
+                    , [=, this](const lt::disk_buffer_holder &buffer, const lt::storage_error &error)
+            {
+                m_statsCollector->operationCompleted(storage, DiskIOStatsCollector::OperationType::Read
+                        , (error ? 0 : blockRequest.length), (std::chrono::steady_clock::now() - submitTime));
+                finishPendingRead(storage, blockRequest, readID, (buffer ? buffer.data() : nullptr), error);
+                finishJob(DiskJobClass::Read);
+            }, (flags | lt::disk_interface::sequential_access));
+        });
+    }
+}
+
+quint64 CustomDiskIOThread::addPendingRead(const lt::storage_index_t storage, const lt::peer_request &request)
+{
+    const auto [pendingReadIter, isInserted] = m_pendingReads.try_emplace({storage, request.piece, request.start});
+    if (!isInserted)
+        return 0;
+
+    pendingReadIter->second.id = ++m_lastPendingReadID;
+    pendingReadIter->second.length = request.length;
+    return pendingReadIter->second.id;
+}
+
+void CustomDiskIOThread::finishPendingRead(const lt::storage_index_t storage, const lt::peer_request &request
+        , const quint64 readID, const char *data, const lt::storage_error &error)
+{
+    const auto pendingReadIter = m_pendingReads.find({storage, request.piece, request.start});
+    if ((pendingReadIter == m_pendingReads.end()) || (pendingReadIter->second.id != readID))
+        return;
+
+    const QList<ReadHandler> waiters = std::move(pendingReadIter->second.waiters);
+    m_pendingReads.erase(pendingReadIter);
+
+    if (!error && data)
+        m_readCache->addBlock(storage, request, data);
+
+    for (const ReadHandler &waiter : waiters)
+    {
+        if (error || !data)
+        {
+            waiter(lt::disk_buffer_holder(), error);
+            continue;
+        }
+
+        auto *buffer = new char[request.length];
+        std::memcpy(buffer, data, request.length);
+        waiter(lt::disk_buffer_holder(CacheBufferAllocator::instance(), buffer, request.length), {});
+    }
 }
 
 bool CustomDiskIOThread::async_write(lt::storage_index_t storage, const lt::peer_request &peerRequest
                                      , const char *buf, std::shared_ptr<lt::disk_observer> diskObserver
                                      , std::function<void (const lt::storage_error &)> handler, lt::disk_job_flags_t flags)
 {
-    return m_nativeDiskIO->async_write(storage, peerRequest, buf, std::move(diskObserver), std::move(handler), flags);
+    m_readCache->removePiece(storage, peerRequest.piece);
+    m_statsCollector->operationSubmitted(storage);
+
+    const auto submitWrite = [=, this, handler = std::move(handler), submitTime = std::chrono::steady_clock::now()]
+            (const char *buffer, std::shared_ptr<lt::disk_observer> observer)
+    {
+        return m_nativeDiskIO->async_write(storage, peerRequest, buffer, std::move(observer)
+                , [=, this](const lt::storage_error &error)
+        {
+            m_statsCollector->operationCompleted(storage, DiskIOStatsCollector::OperationType::Write
+                    , (error ? 0 : peerRequest.length), (std::chrono::steady_clock::now() - submitTime));
+            handler(error);
+            finishJob(DiskJobClass::Write);
+        }, flags);
+    };
+
+    if (!isJobDeferred(DiskJobClass::Write))
+    {
+        startJob(DiskJobClass::Write, peerRequest.length);
+        return submitWrite(buf, std::move(diskObserver));
+    }
+
+    // The buffer is owned by the caller for the duration of the call only, so the deferred write keeps its copy.
+    // The peer is told to stop receiving until the deferred writes are dispatched.
+    if (diskObserver)
+        m_writeObservers.push_back(std::move(diskObserver));
+    const auto buffer = std::make_shared<std::vector<char>>(buf, (buf + peerRequest.length));
+    enqueueJob(DiskJobClass::Write, storage, peerRequest.length, [submitWrite, buffer]
+    {
+        submitWrite(buffer->data(), nullptr);
+    });
+    return true;
 }
 
 void CustomDiskIOThread::async_hash(lt::storage_index_t storage, lt::piece_index_t piece
                                     , lt::span<lt::sha256_hash> hash, lt::disk_job_flags_t flags
                                     , std::function<void (lt::piece_index_t, const lt::sha1_hash &, const lt::storage_error &)> handler)
 {
-    m_nativeDiskIO->async_hash(storage, piece, hash, flags, std::move(handler));
+    m_statsCollector->operationSubmitted(storage);
+    enqueueJob(DiskJobClass::Hash, storage, m_storageData[storage].files.piece_size(piece)
+            , [=, this, handler = std::move(handler), submitTime = std::chrono::steady_clock::now()]() mutable
+    {
+        m_nativeDiskIO->async_hash(storage, piece, hash, flags
+                , [=, this, handler = std::move(handler)](lt::piece_index_t piece, const lt::sha1_hash &hash, const lt::storage_error &error)
+        {
+            m_statsCollector->operationCompleted(storage, DiskIOStatsCollector::OperationType::Hash
+                    , 0, (std::chrono::steady_clock::now() - submitTime));
+            handler(piece, hash, error);
+            finishJob(DiskJobClass::Hash);
+        });
+    });
 }
 
 void CustomDiskIOThread::async_hash2(lt::storage_index_t storage, lt::piece_index_t piece
                                      , int offset, lt::disk_job_flags_t flags
                                      , std::function<void (lt::piece_index_t, const lt::sha256_hash &, const lt::storage_error &)> handler)
 {
-    m_nativeDiskIO->async_hash2(storage, piece, offset, flags, std::move(handler));
+    m_statsCollector->operationSubmitted(storage);
+    enqueueJob(DiskJobClass::Hash, storage, lt::default_block_size
+            , [=, this, handler = std::move(handler), submitTime = std::chrono::steady_clock::now()]() mutable
+    {
+        m_nativeDiskIO->async_hash2(storage, piece, offset, flags
+                , [=, this, handler = std::move(handler)](lt::piece_index_t piece, const lt::sha256_hash &hash, const lt::storage_error &error)
+        {
+            m_statsCollector->operationCompleted(storage, DiskIOStatsCollector::OperationType::Hash
+                    , 0, (std::chrono::steady_clock::now() - submitTime));
+            handler(piece, hash, error);
+            finishJob(DiskJobClass::Hash);
+        });
+    });
 }
 
 void CustomDiskIOThread::async_move_storage(lt::storage_index_t storage, std::string path, lt::move_flags_t flags
@@ -127,38 +740,68 @@ void CustomDiskIOThread::async_move_storage(lt::storage_index_t storage, std::st
 {
     const Path newSavePath {path};
 
-    if (flags == lt::move_flags_t::dont_replace)
-        handleCompleteFiles(storage, newSavePath);
+    m_readCache->removeStorage(storage);
+    // the jobs requested before moving of storage shouldn't be performed after it
+    dispatchQueuedJobs(storage);
 
-    m_nativeDiskIO->async_move_storage(storage, path, flags
-            , [=, this, handler = std::move(handler)](lt::status_t status, const std::string &path, const lt::storage_error &error)
+    enqueueJob(DiskJobClass::Move, storage, MOVE_JOB_COST, [=, this, handler = std::move(handler)]() mutable
     {
+        auto moveStorage = [=, this, handler = std::move(handler)]() mutable
+        {
+            m_nativeDiskIO->async_move_storage(storage, path, flags
+                    , [=, this, handler = std::move(handler)](lt::status_t status, const std::string &path, const lt::storage_error &error)
+            {
 #if LIBTORRENT_VERSION_NUM < 20100
-        if ((status != lt::status_t::fatal_disk_error) && (status != lt::status_t::file_exist))
+                if ((status != lt::status_t::fatal_disk_error) && (status != lt::status_t::file_exist))
 #else
-        if ((status != lt::disk_status::fatal_disk_error) && (status != lt::disk_status::file_exist))
+                if ((status != lt::disk_status::fatal_disk_error) && (status != lt::disk_status::file_exist))
 #endif
-            m_storageData[storage].savePath = newSavePath;
+                    m_storageData[storage].savePath = newSavePath;
+
+                handler(status, path, error);
+                finishJob(DiskJobClass::Move);
+            });
+        };
 
-        handler(status, path, error);
+        if (flags == lt::move_flags_t::dont_replace)
+            handleCompleteFiles(storage, newSavePath, std::move(moveStorage));
+        else
+            moveStorage();
     });
 }
 
 void CustomDiskIOThread::async_release_files(lt::storage_index_t storage, std::function<void ()> handler)
 {
+    m_readCache->removeStorage(storage);
+    dispatchQueuedJobs(storage);
     m_nativeDiskIO->async_release_files(storage, std::move(handler));
+    // files are released when torrent is finished, so it's a good time to update their layout statistics
+    handleFilesLayout(storage, false);
 }
 
 void CustomDiskIOThread::async_check_files(lt::storage_index_t storage, const lt::add_torrent_params *resume_data
                                            , lt::aux::vector<std::string, lt::file_index_t> links
                                            , std::function<void (lt::status_t, const lt::storage_error &)> handler)
 {
-    handleCompleteFiles(storage, m_storageData[storage].savePath);
-    m_nativeDiskIO->async_check_files(storage, resume_data, std::move(links), std::move(handler));
+    handleCompleteFiles(storage, m_storageData[storage].savePath
+            , [=, this, links = std::move(links), handler = std::move(handler)]() mutable
+    {
+        m_nativeDiskIO->async_check_files(storage, resume_data, std::move(links)
+                , [=, this, handler = std::move(handler)](const lt::status_t status, const lt::storage_error &error) mutable
+        {
+            // files are allocated without changing their size, so it doesn't affect the checking results
+            handleFilesLayout(storage, !error, [status, error, handler = std::move(handler)]
+            {
+                handler(status, error);
+            });
+        });
+    });
 }
 
 void CustomDiskIOThread::async_stop_torrent(lt::storage_index_t storage, std::function<void ()> handler)
 {
+    m_readCache->removeStorage(storage);
+    dispatchQueuedJobs(storage);
     m_nativeDiskIO->async_stop_torrent(storage, std::move(handler));
 }
 
@@ -181,6 +824,8 @@ void CustomDiskIOThread::async_rename_file(lt::storage_index_t storage, lt::file
 void CustomDiskIOThread::async_delete_files(lt::storage_index_t storage, lt::remove_flags_t options
                                             , std::function<void (const lt::storage_error &)> handler)
 {
+    m_readCache->removeStorage(storage);
+    dispatchQueuedJobs(storage);
     m_nativeDiskIO->async_delete_files(storage, options, std::move(handler));
 }
 
@@ -198,6 +843,7 @@ void CustomDiskIOThread::async_set_file_priority(lt::storage_index_t storage, lt
 void CustomDiskIOThread::async_clear_piece(lt::storage_index_t storage, lt::piece_index_t index
                                            , std::function<void (lt::piece_index_t)> handler)
 {
+    m_readCache->removePiece(storage, index);
     m_nativeDiskIO->async_clear_piece(storage, index, std::move(handler));
 }
 
@@ -213,11 +859,16 @@ std::vector<lt::open_file_state> CustomDiskIOThread::get_status(lt::storage_inde
 
 void CustomDiskIOThread::abort(bool wait)
 {
+    // native disk I/O is responsible for completing all the jobs on abort
+    m_filesFixupPool.join();
+    runFinishedFixups();
+    dispatchQueuedJobs();
     m_nativeDiskIO->abort(wait);
 }
 
 void CustomDiskIOThread::submit_jobs()
 {
+    dispatchJobs();
     m_nativeDiskIO->submit_jobs();
 }
 
@@ -226,15 +877,148 @@ void CustomDiskIOThread::settings_updated()
     m_nativeDiskIO->settings_updated();
 }
 
-void CustomDiskIOThread::handleCompleteFiles(lt::storage_index_t storage, const Path &savePath)
+void CustomDiskIOThread::enqueueJob(const DiskJobClass jobClass, const lt::storage_index_t storage, const qint64 cost, std::function<void ()> submit)
+{
+    JobClassState &classState = m_jobClasses[static_cast<int>(jobClass)];
+    if (classState.queue.empty())
+    {
+        // Idle class shouldn't accumulate the credit to starve the others when it becomes active again
+        for (const JobClassState &otherClassState : m_jobClasses)
+        {
+            if (!otherClassState.queue.empty())
+                classState.virtualTime = std::max(classState.virtualTime, otherClassState.virtualTime);
+        }
+    }
+
+    classState.queue.push_back({.storage = storage, .cost = cost, .submit = std::move(submit)});
+    dispatchJobs();
+}
+
+void CustomDiskIOThread::startJob(const DiskJobClass jobClass, const qint64 cost)
+{
+    JobClassState &classState = m_jobClasses[static_cast<int>(jobClass)];
+    ++classState.runningCount;
+    classState.virtualTime += std::max<qint64>((cost / jobClassWeight(jobClass)), 1);
+    if (jobClass != DiskJobClass::Write)
+        ++m_runningJobsCount;
+}
+
+void CustomDiskIOThread::finishJob(const DiskJobClass jobClass)
 {
-    const StorageData storageData = m_storageData[storage];
+    --m_jobClasses[static_cast<int>(jobClass)].runningCount;
+    if (jobClass != DiskJobClass::Write)
+        --m_runningJobsCount;
+
+    if (dispatchJobs())
+        m_nativeDiskIO->submit_jobs();
+}
+
+bool CustomDiskIOThread::isJobDeferred(const DiskJobClass jobClass) const
+{
+    const JobClassState &classState = m_jobClasses[static_cast<int>(jobClass)];
+    if (!classState.queue.empty())
+        return true;
+
+    const int limit = m_jobLimits->limit(jobClass);
+    return ((limit > 0) && (classState.runningCount >= limit));
+}
+
+bool CustomDiskIOThread::dispatchJobs()
+{
+    bool isDispatched = false;
+    while (true)
+    {
+        const int totalLimit = m_jobLimits->totalLimit();
+        const bool isTotalLimitReached = ((totalLimit > 0) && (m_runningJobsCount >= totalLimit));
+
+        // Pick the class with the least virtual time among the ones that can start a job
+        std::optional<DiskJobClass> nextJobClass;
+        for (int i = 0; i < DISK_JOB_CLASS_COUNT; ++i)
+        {
+            const auto jobClass = static_cast<DiskJobClass>(i);
+            const JobClassState &classState = m_jobClasses[i];
+            if (classState.queue.empty())
+                continue;
+
+            // Downloading shouldn't hold back the other jobs, so writes are limited by their class only
+            if (isTotalLimitReached && (jobClass != DiskJobClass::Write))
+                continue;
+
+            const int limit = m_jobLimits->limit(jobClass);
+            if ((limit > 0) && (classState.runningCount >= limit))
+                continue;
+
+            if (!nextJobClass || (classState.virtualTime < m_jobClasses[static_cast<int>(*nextJobClass)].virtualTime))
+                nextJobClass = jobClass;
+        }
+
+        if (!nextJobClass)
+            break;
+
+        std::deque<QueuedJob> &queue = m_jobClasses[static_cast<int>(*nextJobClass)].queue;
+        const QueuedJob job = std::move(queue.front());
+        queue.pop_front();
+
+        startJob(*nextJobClass, job.cost);
+        job.submit();
+        isDispatched = true;
+    }
+
+    notifyWriteObservers();
+    return isDispatched;
+}
+
+void CustomDiskIOThread::dispatchQueuedJobs(const std::optional<lt::storage_index_t> storage)
+{
+    for (int i = 0; i < DISK_JOB_CLASS_COUNT; ++i)
+    {
+        std::deque<QueuedJob> &queue = m_jobClasses[i].queue;
+        std::deque<QueuedJob> jobs;
+        if (storage)
+        {
+            const auto it = std::stable_partition(queue.begin(), queue.end()
+                    , [storage](const QueuedJob &job) { return (job.storage != *storage); });
+            std::move(it, queue.end(), std::back_inserter(jobs));
+            queue.erase(it, queue.end());
+        }
+        else
+        {
+            jobs.swap(queue);
+        }
+
+        for (const QueuedJob &job : jobs)
+        {
+            startJob(static_cast<DiskJobClass>(i), job.cost);
+            job.submit();
+        }
+    }
+
+    notifyWriteObservers();
+}
+
+void CustomDiskIOThread::notifyWriteObservers()
+{
+    if (m_writeObservers.empty() || !m_jobClasses[static_cast<int>(DiskJobClass::Write)].queue.empty())
+        return;
+
+    // The observers can submit new jobs so they are notified outside of the current call
+    boost::asio::post(m_ioContext, [observers = std::exchange(m_writeObservers, {})]
+    {
+        for (const std::shared_ptr<lt::disk_observer> &observer : observers)
+            observer->on_disk();
+    });
+}
+
+void CustomDiskIOThread::handleCompleteFiles(const lt::storage_index_t storage, const Path &savePath, std::function<void ()> continuation)
+{
+    const StorageData &storageData = m_storageData[storage];
 #if LIBTORRENT_VERSION_NUM >= 20100
     const lt::filenames fileNames {storageData.files, storageData.renamedFiles};
     const auto &fileStorage = fileNames;
 #else
     const lt::file_storage &fileStorage = storageData.files;
 #endif
+    PathList incompleteFilePaths;
     for (const lt::file_index_t fileIndex : fileStorage.file_range())
     {
         // ignore files that have priority 0
@@ -246,16 +1030,146 @@ void CustomDiskIOThread::handleCompleteFiles(lt::storage_index_t storage, const
 
         const Path filePath {fileStorage.file_path(fileIndex)};
         if (filePath.hasExtension(QB_EXT))
+            incompleteFilePaths.append(filePath);
+    }
+
+    if (incompleteFilePaths.isEmpty())
+    {
+        continuation();
+        return;
+    }
+
+    // File system is accessed on the worker so the other disk jobs aren't blocked meanwhile
+    boost::asio::post(m_filesFixupPool, [this, savePath, incompleteFilePaths, continuation = std::move(continuation)]() mutable
+    {
+        fixupCompleteFiles(savePath, incompleteFilePaths);
+        postFinishedFixup(std::move(continuation));
+    });
+}
+
+void CustomDiskIOThread::handleFilesLayout(const lt::storage_index_t storage, const bool preallocate, std::function<void ()> continuation)
+{
+    const StorageData &storageData = m_storageData[storage];
+    const bool isPreallocationApplied = preallocate && storageData.isSparse
+            && m_preallocationPolicy->isEnabled() && m_preallocationPolicy->matchesSavePath(storageData.savePath);
+    const bool isFileExtentsEnabled = m_statsCollector->isFileExtentsEnabled();
+    if (!isPreallocationApplied && !isFileExtentsEnabled)
+    {
+        if (continuation)
+            continuation();
+        return;
+    }
+
+#if LIBTORRENT_VERSION_NUM >= 20100
+    const lt::filenames fileNames {storageData.files, storageData.renamedFiles};
+    const auto &fileStorage = fileNames;
+#else
+    const lt::file_storage &fileStorage = storageData.files;
+#endif
+
+    struct FileEntry
+    {
+        Path path;
+        qint64 size = 0;
+        bool preallocate = false;
+    };
+
+    QList<FileEntry> files;
+    for (const lt::file_index_t fileIndex : fileStorage.file_range())
+    {
+        // ignore files that have priority 0
+        if ((storageData.filePriorities.end_index() > fileIndex) && (storageData.filePriorities[fileIndex] == lt::dont_download))
+            continue;
+
+        // ignore pad files
+        if (fileStorage.pad_file_at(fileIndex)) continue;
+
+        const qint64 fileSize = fileStorage.file_size(fileIndex);
+        const bool isPreallocated = isPreallocationApplied && (fileSize > 0) && m_preallocationPolicy->matchesFileSize(fileSize);
+        if (!isPreallocated && !isFileExtentsEnabled)
+            continue;
+
+        files.append({.path = (storageData.savePath / Path(fileStorage.file_path(fileIndex))), .size = fileSize, .preallocate = isPreallocated});
+    }
+
+    boost::asio::post(m_filesFixupPool, [this, storage, files, isFileExtentsEnabled, continuation = std::move(continuation)]() mutable
+    {
+        for (const FileEntry &file : asConst(files))
         {
-            const Path incompleteFilePath = savePath / filePath;
-            const Path completeFilePath = incompleteFilePath.removedExtension(QB_EXT);
-            if (completeFilePath.exists())
+            if (!file.preallocate)
+                continue;
+
+            // the folders of new torrent may not be created yet
+            const Path folderPath = file.path.parentPath();
+            if (!folderPath.exists() && !Utils::Fs::mkpath(folderPath))
             {
-                if (Utils::Fs::removeFile(incompleteFilePath))
-                    Utils::Fs::renameFile(completeFilePath, incompleteFilePath);
+                LogMsg(QCoreApplication::translate("CustomStorage", "Failed to preallocate file. File: \"%1\". Error: \"%2\"")
+                        .arg(file.path.toString(), QCoreApplication::translate("CustomStorage", "Cannot create folder")), Log::WARNING);
+                continue;
             }
+
+            if (const auto result = Utils::Fs::preallocateFile(file.path, file.size); !result)
+            {
+                LogMsg(QCoreApplication::translate("CustomStorage", "Failed to preallocate file. File: \"%1\". Error: \"%2\"")
+                        .arg(file.path.toString(), result.error()), Log::WARNING);
+            }
+        }
+
+        // don't hold the caller until the statistics are updated
+        if (continuation)
+            postFinishedFixup(std::move(continuation));
+
+        if (!isFileExtentsEnabled)
+            return;
+
+        qint64 extentsCount = 0;
+        qint64 fragmentedFilesCount = 0;
+        for (const FileEntry &file : asConst(files))
+        {
+            if (!file.path.exists())
+                continue;
+
+            const qint64 fileExtentsCount = Utils::Fs::fileExtentsCount(file.path);
+            if (fileExtentsCount < 0)
+            {
+                // layout of the files isn't available on this platform or file system
+                extentsCount = -1;
+                fragmentedFilesCount = -1;
+                break;
+            }
+
+            extentsCount += fileExtentsCount;
+            if (fileExtentsCount > 1)
+                ++fragmentedFilesCount;
         }
+
+        m_statsCollector->setFileExtents(storage, extentsCount, fragmentedFilesCount);
+    });
+}
+
+void CustomDiskIOThread::postFinishedFixup(std::function<void ()> continuation)
+{
+    {
+        const QMutexLocker locker {&m_finishedFixupsMutex};
+        m_finishedFixups.append(std::move(continuation));
     }
+    boost::asio::post(m_ioContext, [this] { runFinishedFixups(); });
+}
+
+void CustomDiskIOThread::runFinishedFixups()
+{
+    QList<std::function<void ()>> continuations;
+    {
+        const QMutexLocker locker {&m_finishedFixupsMutex};
+        continuations.swap(m_finishedFixups);
+    }
+
+    if (continuations.isEmpty())
+        return;
+
+    for (const std::function<void ()> &continuation : asConst(continuations))
+        continuation();
+    m_nativeDiskIO->submit_jobs();
 }
 
 #else
@@ -300,6 +1214,7 @@ lt::status_t CustomStorage::move_storage(const std::string &savePath, lt::move_f
 void CustomStorage::handleCompleteFiles(const Path &savePath)
 {
     const lt::file_storage &fileStorage = files();
+    PathList incompleteFilePaths;
     for (const lt::file_index_t fileIndex : fileStorage.file_range())
     {
         // ignore files that have priority 0
@@ -311,15 +1226,9 @@ void CustomStorage::handleCompleteFiles(const Path &savePath)
 
         const Path filePath {fileStorage.file_path(fileIndex)};
         if (filePath.hasExtension(QB_EXT))
-        {
-            const Path incompleteFilePath = savePath / filePath;
-            const Path completeFilePath = incompleteFilePath.removedExtension(QB_EXT);
-            if (completeFilePath.exists())
-            {
-                if (Utils::Fs::removeFile(incompleteFilePath))
-                    Utils::Fs::renameFile(completeFilePath, incompleteFilePath);
-            }
-        }
+            incompleteFilePaths.append(filePath);
     }
+
+    fixupCompleteFiles(savePath, incompleteFilePaths);
 }
 #endif
@@ -36,32 +36,194 @@
 #include "base/path.h"
 
 #ifdef QBT_USES_LIBTORRENT2
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <optional>
+#include <tuple>
+#include <vector>
+
 #include <libtorrent/disk_interface.hpp>
 #include <libtorrent/file_storage.hpp>
 #include <libtorrent/io_context.hpp>
 #include <libtorrent/version.hpp>
 
+#include <boost/asio/thread_pool.hpp>
+
+#include <QByteArray>
 #include <QHash>
+#include <QList>
+#include <QMutex>
+
+#include "diskiostats.h"
+#include "infohash.h"
 #else
 #include <libtorrent/storage.hpp>
 #endif
 
 #ifdef QBT_USES_LIBTORRENT2
+// Collects disk I/O statistics of the storages.
+// It is updated from libtorrent network thread and can be queried from any thread.
+class DiskIOStatsCollector
+{
+public:
+    enum class OperationType
+    {
+        Read,
+        Write,
+        Hash
+    };
+
+    void addStorage(lt::storage_index_t storage, const BitTorrent::TorrentID &torrentID);
+    void removeStorage(lt::storage_index_t storage);
+    void operationSubmitted(lt::storage_index_t storage);
+    void operationCompleted(lt::storage_index_t storage, OperationType type, qint64 bytes
+            , std::chrono::steady_clock::duration latency);
+    // Counting the file extents requires to access all the files of the storages,
+    // so they are collected only if enabled (it can be changed from any thread)
+    bool isFileExtentsEnabled() const;
+    void setFileExtentsEnabled(bool enabled);
+    void setFileExtents(lt::storage_index_t storage, qint64 extentsCount, qint64 fragmentedFilesCount);
+
+    QHash<BitTorrent::TorrentID, BitTorrent::DiskIOStats> stats() const;
+
+private:
+    struct StorageStats
+    {
+        BitTorrent::TorrentID torrentID;
+        BitTorrent::DiskIOStats stats;
+    };
+
+    mutable QMutex m_mutex;
+    QHash<lt::storage_index_t, StorageStats> m_storageStats;
+    std::atomic_bool m_isFileExtentsEnabled = false;
+};
+
+// Piece granular cache of the blocks read from storages.
+// It is used in libtorrent network thread, except for capacity and statistics that can be accessed from any thread.
+class PieceReadCache
+{
+public:
+    qint64 capacity() const;
+    void setCapacity(qint64 capacity);
+    bool isEnabled() const;
+
+    qint64 usedBytes() const;
+    qint64 hitCount() const;
+    qint64 missCount() const;
+
+    bool containsPiece(lt::storage_index_t storage, lt::piece_index_t piece) const;
+    // Returns null byte array if the block isn't cached
+    QByteArray findBlock(lt::storage_index_t storage, const lt::peer_request &request);
+    // Blocks can be added only to the pieces that are added to the cache before
+    void addPiece(lt::storage_index_t storage, lt::piece_index_t piece);
+    void addBlock(lt::storage_index_t storage, const lt::peer_request &request, const char *data);
+    void removePiece(lt::storage_index_t storage, lt::piece_index_t piece);
+    void removeStorage(lt::storage_index_t storage);
+    // Evicts the least recently used pieces until the cache fits its capacity
+    void trim();
+
+private:
+    using PieceKey = quint64;
+
+    struct CachedPiece
+    {
+        lt::storage_index_t storage;
+        // blocks by their offsets
+        QHash<int, QByteArray> blocks;
+        qint64 size = 0;
+        std::list<PieceKey>::iterator lruPos;
+    };
+
+    static PieceKey makeKey(lt::storage_index_t storage, lt::piece_index_t piece);
+    void removePiece(PieceKey key);
+
+    std::atomic<qint64> m_capacity = 0;
+    std::atomic<qint64> m_usedBytes = 0;
+    std::atomic<qint64> m_hitCount = 0;
+    std::atomic<qint64> m_missCount = 0;
+    QHash<PieceKey, CachedPiece> m_pieces;
+    // the most recently used pieces come first
+    std::list<PieceKey> m_lruList;
+};
+
+enum class DiskJobClass
+{
+    Read,
+    Write,
+    Hash,
+    Move
+};
+
+inline constexpr int DISK_JOB_CLASS_COUNT = 4;
+
+// Limits of the disk jobs that are dispatched to native disk I/O at the same time (0 means no limit).
+// Writes aren't counted against the total limit, only against the limit of their class.
+// They can be changed from any thread.
+class DiskJobLimits
+{
+public:
+    int totalLimit() const;
+    void setTotalLimit(int limit);
+    int limit(DiskJobClass jobClass) const;
+    void setLimit(DiskJobClass jobClass, int limit);
+
+private:
+    std::atomic<int> m_totalLimit = 0;
+    std::array<std::atomic<int>, DISK_JOB_CLASS_COUNT> m_limits {};
+};
+
+// Selects the files that are preallocated in sparse storages, so they aren't fragmented
+// while they are downloaded. The conditions that aren't set are ignored, so the policy
+// is disabled until any of them is set. It can be changed from any thread.
+class PreallocationPolicy
+{
+public:
+    qint64 minFileSize() const;
+    void setMinFileSize(qint64 size);
+    PathList savePaths() const;
+    void setSavePaths(const PathList &paths);
+
+    bool isEnabled() const;
+    bool matchesSavePath(const Path &savePath) const;
+    bool matchesFileSize(qint64 fileSize) const;
+
+private:
+    mutable QMutex m_mutex;
+    qint64 m_minFileSize = 0;
+    PathList m_savePaths;
+};
+
 std::unique_ptr<lt::disk_interface> customDiskIOConstructor(
-        lt::io_context &ioContext, lt::settings_interface const &settings, lt::counters &counters);
+        lt::io_context &ioContext, lt::settings_interface const &settings, lt::counters &counters
+        , std::shared_ptr<DiskIOStatsCollector> statsCollector, std::shared_ptr<PieceReadCache> readCache
+        , std::shared_ptr<DiskJobLimits> jobLimits, std::shared_ptr<PreallocationPolicy> preallocationPolicy);
 std::unique_ptr<lt::disk_interface> customPosixDiskIOConstructor(
-        lt::io_context &ioContext, lt::settings_interface const &settings, lt::counters &counters);
+        lt::io_context &ioContext, lt::settings_interface const &settings, lt::counters &counters
+        , std::shared_ptr<DiskIOStatsCollector> statsCollector, std::shared_ptr<PieceReadCache> readCache
+        , std::shared_ptr<DiskJobLimits> jobLimits, std::shared_ptr<PreallocationPolicy> preallocationPolicy);
 std::unique_ptr<lt::disk_interface> customMMapDiskIOConstructor(
-        lt::io_context &ioContext, lt::settings_interface const &settings, lt::counters &counters);
+        lt::io_context &ioContext, lt::settings_interface const &settings, lt::counters &counters
+        , std::shared_ptr<DiskIOStatsCollector> statsCollector, std::shared_ptr<PieceReadCache> readCache
+        , std::shared_ptr<DiskJobLimits> jobLimits, std::shared_ptr<PreallocationPolicy> preallocationPolicy);
 #if LIBTORRENT_VERSION_NUM >= 20100
 std::unique_ptr<lt::disk_interface> customPreadDiskIOConstructor(
-        lt::io_context &ioContext, lt::settings_interface const &settings, lt::counters &counters);
+        lt::io_context &ioContext, lt::settings_interface const &settings, lt::counters &counters
+        , std::shared_ptr<DiskIOStatsCollector> statsCollector, std::shared_ptr<PieceReadCache> readCache
+        , std::shared_ptr<DiskJobLimits> jobLimits, std::shared_ptr<PreallocationPolicy> preallocationPolicy);
 #endif
 
 class CustomDiskIOThread final : public lt::disk_interface
 {
 public:
-    explicit CustomDiskIOThread(std::unique_ptr<libtorrent::disk_interface> nativeDiskIOThread);
+    CustomDiskIOThread(lt::io_context &ioContext, std::unique_ptr<libtorrent::disk_interface> nativeDiskIOThread
+            , std::shared_ptr<DiskIOStatsCollector> statsCollector, std::shared_ptr<PieceReadCache> readCache
+            , std::shared_ptr<DiskJobLimits> jobLimits, std::shared_ptr<PreallocationPolicy> preallocationPolicy);
 
     lt::storage_holder new_torrent(const lt::storage_params &storageParams, const std::shared_ptr<void> &torrent) override;
     void remove_torrent(lt::storage_index_t storageIndex) override;
@@ -95,9 +257,73 @@ public:
     void settings_updated() override;
 
 private:
-    void handleCompleteFiles(libtorrent::storage_index_t storage, const Path &savePath);
+    struct QueuedJob
+    {
+        lt::storage_index_t storage;
+        qint64 cost = 0;
+        std::function<void ()> submit;
+    };
+
+    struct JobClassState
+    {
+        std::deque<QueuedJob> queue;
+        int runningCount = 0;
+        // it grows by the cost of dispatched jobs divided by class weight
+        qint64 virtualTime = 0;
+    };
+
+    // Invokes continuation once the files are handled
+    void handleCompleteFiles(lt::storage_index_t storage, const Path &savePath, std::function<void ()> continuation);
+    // Preallocates the files selected by the policy (if requested) and updates the statistics of
+    // their extents on the worker. Continuation is invoked afterwards, if there is any.
+    void handleFilesLayout(lt::storage_index_t storage, bool preallocate, std::function<void ()> continuation = {});
+    void postFinishedFixup(std::function<void ()> continuation);
+    void runFinishedFixups();
+    void readAhead(lt::storage_index_t storage, const lt::peer_request &peerRequest, lt::disk_job_flags_t flags);
+    // Registers the read of the block, so the requests for it received meanwhile wait for it
+    // instead of reading it again. Returns 0 if the block is being read already.
+    quint64 addPendingRead(lt::storage_index_t storage, const lt::peer_request &request);
+    // Caches the block and passes it to the requests waiting for it
+    void finishPendingRead(lt::storage_index_t storage, const lt::peer_request &request, quint64 readID
+            , const char *data, const lt::storage_error &error);
 
+    void enqueueJob(DiskJobClass jobClass, lt::storage_index_t storage, qint64 cost, std::function<void ()> submit);
+    void startJob(DiskJobClass jobClass, qint64 cost);
+    void finishJob(DiskJobClass jobClass);
+    bool isJobDeferred(DiskJobClass jobClass) const;
+    bool dispatchJobs();
+    // Dispatches queued jobs regardless of the limits
+    void dispatchQueuedJobs(std::optional<lt::storage_index_t> storage = std::nullopt);
+    // Resumes the peers which writes were deferred, once all the deferred writes are dispatched
+    void notifyWriteObservers();
+
+    lt::io_context &m_ioContext;
     std::unique_ptr<lt::disk_interface> m_nativeDiskIO;
+    std::shared_ptr<DiskIOStatsCollector> m_statsCollector;
+    std::shared_ptr<PieceReadCache> m_readCache;
+    std::shared_ptr<DiskJobLimits> m_jobLimits;
+    std::shared_ptr<PreallocationPolicy> m_preallocationPolicy;
+    std::array<JobClassState, DISK_JOB_CLASS_COUNT> m_jobClasses;
+    // writes aren't counted here
+    int m_runningJobsCount = 0;
+    std::vector<std::shared_ptr<lt::disk_observer>> m_writeObservers;
+
+    using ReadHandler = std::function<void (lt::disk_buffer_holder, const lt::storage_error &)>;
+    // storage, piece and offset of the block
+    using BlockKey = std::tuple<lt::storage_index_t, lt::piece_index_t, int>;
+
+    struct PendingRead
+    {
+        // storage index can be reused while the read is pending, so it is checked on completion
+        quint64 id = 0;
+        int length = 0;
+        QList<ReadHandler> waiters;
+    };
+    std::map<BlockKey, PendingRead> m_pendingReads;
+    quint64 m_lastPendingReadID = 0;
+
+    QMutex m_finishedFixupsMutex;
+    QList<std::function<void ()>> m_finishedFixups;
 
     struct StorageData
     {
@@ -107,8 +333,12 @@ private:
         lt::renamed_files renamedFiles;
 #endif
         lt::aux::vector<lt::download_priority_t, lt::file_index_t> filePriorities;
+        bool isSparse = true;
     };
     QHash<lt::storage_index_t, StorageData> m_storageData;
+
+    // it must be destroyed before the data used by its jobs
+    boost::asio::thread_pool m_filesFixupPool {1};
 };
 
 #else
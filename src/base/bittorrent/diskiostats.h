@@ -0,0 +1,61 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <array>
+
+#include <QtTypes>
+
+namespace BitTorrent
+{
+    // Upper bounds (in microseconds) of all but the last latency histogram buckets
+    inline constexpr std::array<qint64, 5> DISK_IO_LATENCY_BUCKETS {100, 1'000, 10'000, 100'000, 1'000'000};
+
+    // Number of operations by latency bucket, the last bucket counts operations exceeding all the bounds
+    using DiskIOLatencyHistogram = std::array<qint64, DISK_IO_LATENCY_BUCKETS.size() + 1>;
+
+    struct DiskIOStats
+    {
+        qint64 readBytes = 0;
+        qint64 writtenBytes = 0;
+        qint64 readCount = 0;
+        qint64 writeCount = 0;
+        qint64 hashCount = 0;
+        // operations that are submitted but not completed yet
+        qint64 pendingCount = 0;
+        // latency is measured from operation submission to its completion
+        DiskIOLatencyHistogram readLatency {};
+        DiskIOLatencyHistogram writeLatency {};
+        DiskIOLatencyHistogram hashLatency {};
+        // layout of the files on disk, it is updated when the files are checked or released,
+        // -1 means that it is unknown
+        qint64 fileExtentsCount = -1;
+        qint64 fragmentedFilesCount = -1;
+    };
+}
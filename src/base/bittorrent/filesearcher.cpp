@@ -28,25 +28,40 @@
 
 #include "filesearcher.h"
 
+#include <QFuture>
 #include <QPromise>
 
 #include "base/bittorrent/common.h"
+#include "base/global.h"
+#include "base/utils/fs.h"
 
 namespace
 {
+    // Searching is limited mostly by storage latency rather than by CPU
+    const int MAX_CONCURRENT_SEARCHES = 4;
+
     bool findInDir(const Path &dirPath, PathList &fileNames, const bool forceAppendExt)
     {
+        PathList filePaths;
+        filePaths.reserve(fileNames.size() * 2);
+        for (const Path &fileName : asConst(fileNames))
+        {
+            filePaths.append(dirPath / fileName);
+            filePaths.append(dirPath / (fileName + QB_EXT));
+        }
+
+        Utils::Fs::FileExistenceChecker fileExistenceChecker {filePaths};
         bool found = false;
         for (Path &fileName : fileNames)
         {
-            if ((dirPath / fileName).exists())
+            if (fileExistenceChecker.exists(dirPath / fileName))
             {
                 found = true;
             }
             else
             {
                 const Path incompleteFilename = fileName + QB_EXT;
-                if ((dirPath / incompleteFilename).exists())
+                if (fileExistenceChecker.exists(dirPath / incompleteFilename))
                 {
                     found = true;
                     fileName = incompleteFilename;
@@ -60,19 +75,42 @@ namespace
 
         return found;
     }
+
+    FileSearchResult searchFiles(const PathList &originalFileNames, const Path &savePath
+            , const Path &downloadPath, const bool forceAppendExt)
+    {
+        Path usedPath = savePath;
+        PathList adjustedFileNames = originalFileNames;
+        const bool found = findInDir(usedPath, adjustedFileNames, (forceAppendExt && downloadPath.isEmpty()));
+        if (!found && !downloadPath.isEmpty())
+        {
+            usedPath = downloadPath;
+            findInDir(usedPath, adjustedFileNames, forceAppendExt);
+        }
+
+        return {.savePath = usedPath, .fileNames = adjustedFileNames};
+    }
 }
 
-void FileSearcher::search(const PathList &originalFileNames, const Path &savePath
-        , const Path &downloadPath, const bool forceAppendExt, QPromise<FileSearchResult> &promise)
+FileSearcher::FileSearcher(QObject *parent)
+    : QObject(parent)
+    , m_threadPool(this)
 {
-    Path usedPath = savePath;
-    PathList adjustedFileNames = originalFileNames;
-    const bool found = findInDir(usedPath, adjustedFileNames, (forceAppendExt && downloadPath.isEmpty()));
-    if (!found && !downloadPath.isEmpty())
+    m_threadPool.setObjectName("FileSearcher m_threadPool");
+    m_threadPool.setMaxThreadCount(MAX_CONCURRENT_SEARCHES);
+}
+
+QFuture<FileSearchResult> FileSearcher::search(const PathList &originalFileNames, const Path &savePath
+        , const Path &downloadPath, const bool forceAppendExt)
+{
+    QPromise<FileSearchResult> promise;
+    QFuture<FileSearchResult> future = promise.future();
+    promise.start();
+    m_threadPool.start([=, promise = std::move(promise)]() mutable
     {
-        usedPath = downloadPath;
-        findInDir(usedPath, adjustedFileNames, forceAppendExt);
-    }
+        promise.addResult(searchFiles(originalFileNames, savePath, downloadPath, forceAppendExt));
+        promise.finish();
+    });
 
-    promise.addResult(FileSearchResult {.savePath = usedPath, .fileNames = adjustedFileNames});
+    return future;
 }
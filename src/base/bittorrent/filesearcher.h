@@ -29,10 +29,11 @@
 #pragma once
 
 #include <QObject>
+#include <QThreadPool>
 
 #include "base/path.h"
 
-template <typename T> class QPromise;
+template <typename T> class QFuture;
 
 struct FileSearchResult
 {
@@ -46,8 +47,12 @@ class FileSearcher final : public QObject
     Q_DISABLE_COPY_MOVE(FileSearcher)
 
 public:
-    using QObject::QObject;
+    explicit FileSearcher(QObject *parent = nullptr);
 
-    void search(const PathList &originalFileNames, const Path &savePath
-            , const Path &downloadPath, bool forceAppendExt, QPromise<FileSearchResult> &promise);
+    // It can be called from any thread. The searches are performed concurrently.
+    QFuture<FileSearchResult> search(const PathList &originalFileNames, const Path &savePath
+            , const Path &downloadPath, bool forceAppendExt);
+
+private:
+    QThreadPool m_threadPool;
 };
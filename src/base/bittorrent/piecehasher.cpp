@@ -0,0 +1,304 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "piecehasher.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+
+#include <libtorrent/hasher.hpp>
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSemaphore>
+#include <QThreadPool>
+
+#include "base/exceptions.h"
+#include "lttypecast.h"
+
+namespace
+{
+    // Pieces are read by chunks of at least this size to make I/O efficient for small pieces
+    const qint64 READ_CHUNK_SIZE = 4 * 1024 * 1024;
+    // Maximum amount of data read ahead of hashing
+    const qint64 MAX_BUFFERED_SIZE = 256 * 1024 * 1024;
+    const int WAIT_INTERVAL = 100; // ms
+
+    // Hashing threads are shared by all the hashers so that the torrents
+    // created at the same time don't oversubscribe CPU
+    QThreadPool *hashingThreadPool()
+    {
+        static QThreadPool threadPool;
+        return &threadPool;
+    }
+
+    struct Chunk
+    {
+        std::vector<lt::piece_index_t> pieces;
+        QByteArray data;
+    };
+
+    // Keeps the last read file opened since the files are read sequentially
+    class FileReader
+    {
+    public:
+        explicit FileReader(Path basePath)
+            : m_basePath {std::move(basePath)}
+        {
+        }
+
+        void read(const Path &filePath, const qint64 offset, char *buffer, const qint64 size)
+        {
+            if (filePath != m_filePath)
+            {
+                m_file.close();
+                m_file.setFileName((m_basePath / filePath).data());
+                if (!m_file.open(QIODevice::ReadOnly))
+                {
+                    throw RuntimeError(QCoreApplication::translate("BitTorrent::PieceHasher", "Couldn't open file. Path: \"%1\". Error: \"%2\"")
+                            .arg(m_file.fileName(), m_file.errorString()));
+                }
+
+                m_filePath = filePath;
+            }
+
+            if (!m_file.seek(offset) || (m_file.read(buffer, size) != size))
+            {
+                throw RuntimeError(QCoreApplication::translate("BitTorrent::PieceHasher", "Couldn't read file. Path: \"%1\". Error: \"%2\"")
+                        .arg(m_file.fileName(), m_file.errorString()));
+            }
+        }
+
+    private:
+        Path m_basePath;
+        Path m_filePath;
+        QFile m_file;
+    };
+
+    Chunk readChunk(const lt::file_storage &files, FileReader &fileReader
+            , const std::vector<lt::piece_index_t> &pieces, std::size_t &nextPieceIndex)
+    {
+        Chunk chunk;
+        qint64 chunkSize = 0;
+        // chunk should contain only consecutive pieces
+        while ((nextPieceIndex < pieces.size()) && (chunkSize < READ_CHUNK_SIZE)
+               && (chunk.pieces.empty() || (BitTorrent::LT::toUnderlyingType(pieces[nextPieceIndex]) == (BitTorrent::LT::toUnderlyingType(chunk.pieces.back()) + 1))))
+        {
+            const lt::piece_index_t piece = pieces[nextPieceIndex];
+            chunk.pieces.push_back(piece);
+            chunkSize += files.piece_size(piece);
+            ++nextPieceIndex;
+        }
+
+        chunk.data = QByteArray(chunkSize, 0);
+        qint64 dataOffset = 0;
+        for (const lt::file_slice &slice : files.map_block(chunk.pieces.front(), 0, chunkSize))
+        {
+            // pad files are filled with zeros
+            if (!files.pad_file_at(slice.file_index))
+                fileReader.read(Path(files.file_path(slice.file_index)), slice.offset, (chunk.data.data() + dataOffset), slice.size);
+            dataOffset += slice.size;
+        }
+
+        return chunk;
+    }
+
+#ifdef QBT_USES_LIBTORRENT2
+    lt::sha256_hash calculateV2PieceHash(const lt::file_storage &files, const lt::piece_index_t piece, const char *pieceData)
+    {
+        const lt::file_index_t fileIndex = files.file_index_at_piece(piece);
+        const qint64 fileSize = files.file_size(fileIndex);
+        if (files.pad_file_at(fileIndex) || (fileSize == 0))
+            return {};
+
+        // files are aligned to piece boundaries in v2 torrents
+        const int pieceLength = files.piece_length();
+        const qint64 pieceOffset = (static_cast<qint64>(BitTorrent::LT::toUnderlyingType(piece)) * pieceLength) - files.file_offset(fileIndex);
+        const int dataSize = static_cast<int>(std::min<qint64>(pieceLength, (fileSize - pieceOffset)));
+        const int blocksCount = (dataSize + lt::default_block_size - 1) / lt::default_block_size;
+        const auto fileBlocksCount = static_cast<quint64>((fileSize + lt::default_block_size - 1) / lt::default_block_size);
+        // the tree of the file smaller than piece is padded up to the nearest power of 2 only
+        const auto leavesCount = static_cast<std::size_t>(std::min<quint64>((pieceLength / lt::default_block_size), std::bit_ceil(fileBlocksCount)));
+
+        // the leaves beyond the end of file are zero
+        std::vector<lt::sha256_hash> tree(leavesCount);
+        for (int i = 0; i < blocksCount; ++i)
+        {
+            const int blockOffset = i * lt::default_block_size;
+            tree[i] = lt::hasher256((pieceData + blockOffset), std::min(lt::default_block_size, (dataSize - blockOffset))).final();
+        }
+
+        for (std::size_t levelSize = leavesCount; levelSize > 1; levelSize /= 2)
+        {
+            for (std::size_t i = 0; i < (levelSize / 2); ++i)
+            {
+                lt::hasher256 hasher;
+                hasher.update(tree[2 * i]);
+                hasher.update(tree[(2 * i) + 1]);
+                tree[i] = hasher.final();
+            }
+        }
+
+        return tree[0];
+    }
+#endif
+
+    std::vector<BitTorrent::PieceHashes> hashChunk(const lt::file_storage &files, const Chunk &chunk
+            , [[maybe_unused]] const bool hasV1Hashes, [[maybe_unused]] const bool hasV2Hashes)
+    {
+        std::vector<BitTorrent::PieceHashes> result;
+        result.reserve(chunk.pieces.size());
+
+        qint64 pieceOffset = 0;
+        for (const lt::piece_index_t piece : chunk.pieces)
+        {
+            const char *pieceData = chunk.data.constData() + pieceOffset;
+            const int pieceSize = files.piece_size(piece);
+
+            BitTorrent::PieceHashes hashes {.piece = piece};
+#ifdef QBT_USES_LIBTORRENT2
+            if (hasV1Hashes)
+                hashes.v1Hash = lt::hasher(pieceData, pieceSize).final();
+            if (hasV2Hashes)
+                hashes.v2Hash = calculateV2PieceHash(files, piece, pieceData);
+#else
+            hashes.v1Hash = lt::hasher(pieceData, pieceSize).final();
+#endif
+            result.push_back(hashes);
+
+            pieceOffset += pieceSize;
+        }
+
+        return result;
+    }
+}
+
+BitTorrent::PieceHasher::PieceHasher(const lt::create_torrent &torrent, Path basePath, const int threadCount)
+    : m_files {torrent.files()}
+    , m_basePath {std::move(basePath)}
+    , m_threadCount {std::max(threadCount, 1)}
+#ifdef QBT_USES_LIBTORRENT2
+    , m_hasV1Hashes {!torrent.is_v2_only()}
+    , m_hasV2Hashes {!torrent.is_v1_only()}
+#endif
+{
+}
+
+void BitTorrent::PieceHasher::hashPieces(const std::vector<lt::piece_index_t> &pieces, const ResultHandler &resultHandler
+        , const InterruptionChecker &checkInterruption) const
+{
+    if (pieces.empty())
+        return;
+
+    const qint64 chunkSize = std::max<qint64>(READ_CHUNK_SIZE, m_files.piece_length());
+    const auto maxChunksCount = static_cast<int>(std::clamp<qint64>((MAX_BUFFERED_SIZE / chunkSize), 1, (m_threadCount + 1)));
+    QSemaphore freeChunksSemaphore {maxChunksCount};
+
+    QMutex resultsMutex;
+    std::vector<PieceHashes> results;
+
+    const auto deliverResults = [&resultsMutex, &results, &resultHandler]
+    {
+        std::vector<PieceHashes> readyResults;
+        {
+            const QMutexLocker locker {&resultsMutex};
+            readyResults.swap(results);
+        }
+
+        for (const PieceHashes &hashes : readyResults)
+            resultHandler(hashes);
+    };
+
+    // hashing of the chunks that are still queued is skipped once the hashing is failed or interrupted
+    std::atomic_bool isCanceled = false;
+
+    try
+    {
+        FileReader fileReader {m_basePath};
+        std::size_t nextPieceIndex = 0;
+        while (nextPieceIndex < pieces.size())
+        {
+            checkInterruption();
+
+            Chunk chunk = readChunk(m_files, fileReader, pieces, nextPieceIndex);
+            while (!freeChunksSemaphore.tryAcquire(1, WAIT_INTERVAL))
+            {
+                deliverResults();
+                checkInterruption();
+            }
+
+            hashingThreadPool()->start([this, &freeChunksSemaphore, &resultsMutex, &results, &isCanceled, chunk = std::move(chunk)]
+            {
+                if (!isCanceled)
+                {
+                    const std::vector<PieceHashes> chunkResults = hashChunk(m_files, chunk, m_hasV1Hashes, m_hasV2Hashes);
+                    const QMutexLocker locker {&resultsMutex};
+                    results.insert(results.end(), chunkResults.cbegin(), chunkResults.cend());
+                }
+                freeChunksSemaphore.release();
+            });
+
+            deliverResults();
+        }
+
+        // all the chunks are hashed once all the semaphore resources are released
+        while (!freeChunksSemaphore.tryAcquire(maxChunksCount, WAIT_INTERVAL))
+        {
+            deliverResults();
+            checkInterruption();
+        }
+        deliverResults();
+    }
+    catch (...)
+    {
+        isCanceled = true;
+        freeChunksSemaphore.acquire(maxChunksCount);
+        throw;
+    }
+}
+
+void BitTorrent::PieceHasher::setPieceHashes(lt::create_torrent &torrent, const PieceHashes &hashes)
+{
+#ifdef QBT_USES_LIBTORRENT2
+    if (!torrent.is_v2_only())
+        torrent.set_hash(hashes.piece, hashes.v1Hash);
+
+    if (!torrent.is_v1_only() && !hashes.v2Hash.is_all_zeros())
+    {
+        const lt::file_storage &files = torrent.files();
+        const lt::file_index_t fileIndex = files.file_index_at_piece(hashes.piece);
+        const auto filePiecesOffset = static_cast<lt::piece_index_t::diff_type>(files.file_offset(fileIndex) / files.piece_length());
+        torrent.set_hash2(fileIndex, ((hashes.piece - lt::piece_index_t(0)) - filePiecesOffset), hashes.v2Hash);
+    }
+#else
+    torrent.set_hash(hashes.piece, hashes.v1Hash);
+#endif
+}
@@ -0,0 +1,78 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#include <libtorrent/create_torrent.hpp>
+#include <libtorrent/file_storage.hpp>
+#include <libtorrent/sha1_hash.hpp>
+#include <libtorrent/units.hpp>
+
+#include "base/path.h"
+
+namespace BitTorrent
+{
+    struct PieceHashes
+    {
+        lt::piece_index_t piece;
+        lt::sha1_hash v1Hash;
+#ifdef QBT_USES_LIBTORRENT2
+        // root of the merkle subtree of the piece, it is empty if there is no file data in the piece
+        lt::sha256_hash v2Hash;
+#endif
+    };
+
+    // Hashes the pieces of new torrent on the threads shared by all the hashers.
+    // The data is read sequentially by large chunks on the calling thread,
+    // thread count limits the number of chunks of this hasher that are hashed at the same time.
+    class PieceHasher
+    {
+    public:
+        using ResultHandler = std::function<void (const PieceHashes &hashes)>;
+        using InterruptionChecker = std::function<void ()>;
+
+        PieceHasher(const lt::create_torrent &torrent, Path basePath, int threadCount);
+
+        // Pieces must be in ascending order. Both the callbacks are invoked on the calling thread,
+        // the results are delivered in arbitrary order. Interruption checker can throw to stop hashing.
+        void hashPieces(const std::vector<lt::piece_index_t> &pieces, const ResultHandler &resultHandler
+                , const InterruptionChecker &checkInterruption) const;
+
+        static void setPieceHashes(lt::create_torrent &torrent, const PieceHashes &hashes);
+
+    private:
+        lt::file_storage m_files;
+        Path m_basePath;
+        int m_threadCount = 1;
+        bool m_hasV1Hashes = true;
+        bool m_hasV2Hashes = false;
+    };
+}
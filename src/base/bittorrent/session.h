@@ -53,6 +53,7 @@ namespace BitTorrent
     class TorrentID;
     class TorrentInfo;
     struct CacheStatus;
+    struct DiskIOStats;
     struct SessionStatus;
 
     enum class TorrentRemoveOption
@@ -230,6 +231,12 @@ namespace BitTorrent
         virtual void setRefreshInterval(int value) = 0;
         virtual bool isPreallocationEnabled() const = 0;
         virtual void setPreallocationEnabled(bool enabled) = 0;
+        virtual int preallocationMinFileSize() const = 0;
+        virtual void setPreallocationMinFileSize(int size) = 0;
+        virtual PathList preallocationPaths() const = 0;
+        virtual void setPreallocationPaths(const PathList &paths) = 0;
+        virtual bool isFileExtentsStatsEnabled() const = 0;
+        virtual void setFileExtentsStatsEnabled(bool enabled) = 0;
 
         virtual bool isTorrentFileBackupEnabled() const = 0;
         virtual void setTorrentFileBackupEnabled(bool enabled) = 0;
@@ -347,6 +354,18 @@ namespace BitTorrent
         virtual void setDiskCacheTTL(int ttl) = 0;
         virtual qint64 diskQueueSize() const = 0;
         virtual void setDiskQueueSize(qint64 size) = 0;
+        virtual int readCacheSize() const = 0;
+        virtual void setReadCacheSize(int size) = 0;
+        virtual int diskIOJobsLimit() const = 0;
+        virtual void setDiskIOJobsLimit(int limit) = 0;
+        virtual int diskIOReadingJobsLimit() const = 0;
+        virtual void setDiskIOReadingJobsLimit(int limit) = 0;
+        virtual int diskIOWritingJobsLimit() const = 0;
+        virtual void setDiskIOWritingJobsLimit(int limit) = 0;
+        virtual int diskIOHashingJobsLimit() const = 0;
+        virtual void setDiskIOHashingJobsLimit(int limit) = 0;
+        virtual int diskIOMovingJobsLimit() const = 0;
+        virtual void setDiskIOMovingJobsLimit(int limit) = 0;
         virtual DiskIOType diskIOType() const = 0;
         virtual void setDiskIOType(DiskIOType type) = 0;
         virtual DiskIOReadMode diskIOReadMode() const = 0;
@@ -474,6 +493,7 @@ namespace BitTorrent
         virtual qsizetype torrentsCount() const = 0;
         virtual const SessionStatus &status() const = 0;
         virtual const CacheStatus &cacheStatus() const = 0;
+        virtual QHash<TorrentID, DiskIOStats> diskIOStats() const = 0;
         virtual bool isListening() const = 0;
 
         virtual void banIP(const QString &ip) = 0;
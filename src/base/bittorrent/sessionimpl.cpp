@@ -100,6 +100,7 @@
 #include "bencoderesumedatastorage.h"
 #include "customstorage.h"
 #include "dbresumedatastorage.h"
+#include "diskiostats.h"
 #include "downloadpriority.h"
 #include "extensiondata.h"
 #include "filesearcher.h"
@@ -498,6 +499,12 @@ SessionImpl::SessionImpl(QObject *parent)
 #else
     , m_diskQueueSize(BITTORRENT_SESSION_KEY(u"DiskQueueSize"_s), (1024 * 1024))
 #endif
+    , m_readCacheSize(BITTORRENT_SESSION_KEY(u"ReadCacheSize"_s), 0, lowerLimited(0))
+    , m_diskIOJobsLimit(BITTORRENT_SESSION_KEY(u"DiskIOJobsLimit"_s), 64, lowerLimited(0))
+    , m_diskIOReadingJobsLimit(BITTORRENT_SESSION_KEY(u"DiskIOReadingJobsLimit"_s), 0, lowerLimited(0))
+    , m_diskIOWritingJobsLimit(BITTORRENT_SESSION_KEY(u"DiskIOWritingJobsLimit"_s), 0, lowerLimited(0))
+    , m_diskIOHashingJobsLimit(BITTORRENT_SESSION_KEY(u"DiskIOHashingJobsLimit"_s), 8, lowerLimited(0))
+    , m_diskIOMovingJobsLimit(BITTORRENT_SESSION_KEY(u"DiskIOMovingJobsLimit"_s), 1, lowerLimited(0))
     , m_diskIOType(BITTORRENT_SESSION_KEY(u"DiskIOType"_s), DiskIOType::Default)
     , m_diskIOReadMode(BITTORRENT_SESSION_KEY(u"DiskIOReadMode"_s), DiskIOReadMode::EnableOSCache)
     , m_diskIOWriteMode(BITTORRENT_SESSION_KEY(u"DiskIOWriteMode"_s), DiskIOWriteMode::EnableOSCache)
@@ -569,6 +576,9 @@ SessionImpl::SessionImpl(QObject *parent)
     , m_isUnwantedFolderEnabled(BITTORRENT_SESSION_KEY(u"UseUnwantedFolder"_s), false)
     , m_refreshInterval(BITTORRENT_SESSION_KEY(u"RefreshInterval"_s), 1500)
     , m_isPreallocationEnabled(BITTORRENT_SESSION_KEY(u"Preallocation"_s), false)
+    , m_preallocationMinFileSize(BITTORRENT_SESSION_KEY(u"PreallocationMinFileSize"_s), 0, lowerLimited(0))
+    , m_preallocationPaths(BITTORRENT_SESSION_KEY(u"PreallocationPaths"_s))
+    , m_isFileExtentsStatsEnabled(BITTORRENT_SESSION_KEY(u"FileExtentsStatsEnabled"_s), false)
     , m_isTorrentFileBackupEnabled(BITTORRENT_SESSION_KEY(u"TorrentBackupEnabled"_s), false)
     , m_torrentBackupDirectory(BITTORRENT_SESSION_KEY(u"TorrentBackupDirectory"_s))
     , m_isFinishedTorrentBackupDirectoryEnabled(BITTORRENT_SESSION_KEY(u"FinishedTorrentBackupDirectoryEnabled"_s), false)
@@ -713,9 +723,7 @@ SessionImpl::SessionImpl(QObject *parent)
         emit freeDiskSpaceChecked(m_freeDiskSpace);
     });
 
-    m_fileSearcher = new FileSearcher;
-    m_fileSearcher->moveToThread(m_ioThread.get());
-    connect(m_ioThread.get(), &QThread::finished, m_fileSearcher, &QObject::deleteLater);
+    m_fileSearcher = new FileSearcher(this);
 
     m_torrentContentRemover = new TorrentContentRemover;
     m_torrentContentRemover->moveToThread(m_ioThread.get());
@@ -934,6 +942,68 @@ void SessionImpl::setPreallocationEnabled(const bool enabled)
     m_isPreallocationEnabled = enabled;
 }
 
+int SessionImpl::preallocationMinFileSize() const
+{
+    return m_preallocationMinFileSize;
+}
+
+void SessionImpl::setPreallocationMinFileSize(const int size)
+{
+    if (size == m_preallocationMinFileSize)
+        return;
+
+    m_preallocationMinFileSize = size;
+#ifdef QBT_USES_LIBTORRENT2
+    m_preallocationPolicy->setMinFileSize(static_cast<qint64>(preallocationMinFileSize()) * 1024 * 1024);
+#endif
+}
+
+PathList SessionImpl::preallocationPaths() const
+{
+    const QStringList pathStrings = m_preallocationPaths;
+
+    PathList paths;
+    paths.reserve(pathStrings.size());
+    for (const QString &pathString : pathStrings)
+        paths.append(Path(pathString));
+    return paths;
+}
+
+void SessionImpl::setPreallocationPaths(const PathList &paths)
+{
+    QStringList pathStrings;
+    pathStrings.reserve(paths.size());
+    for (const Path &path : paths)
+    {
+        if (path.isAbsolute() && !pathStrings.contains(path.data()))
+            pathStrings.append(path.data());
+    }
+
+    if (pathStrings == m_preallocationPaths.get())
+        return;
+
+    m_preallocationPaths = pathStrings;
+#ifdef QBT_USES_LIBTORRENT2
+    m_preallocationPolicy->setSavePaths(preallocationPaths());
+#endif
+}
+
+bool SessionImpl::isFileExtentsStatsEnabled() const
+{
+    return m_isFileExtentsStatsEnabled;
+}
+
+void SessionImpl::setFileExtentsStatsEnabled(const bool enabled)
+{
+    if (enabled == m_isFileExtentsStatsEnabled)
+        return;
+
+    m_isFileExtentsStatsEnabled = enabled;
+#ifdef QBT_USES_LIBTORRENT2
+    m_diskIOStatsCollector->setFileExtentsEnabled(enabled);
+#endif
+}
+
 bool SessionImpl::isTorrentFileBackupEnabled() const
 {
     return m_isTorrentFileBackupEnabled;
@@ -1810,22 +1880,45 @@ void SessionImpl::initializeNativeSession()
 
     lt::session_params sessionParams {std::move(pack), {}};
 #ifdef QBT_USES_LIBTORRENT2
+    m_diskIOStatsCollector = std::make_shared<DiskIOStatsCollector>();
+    m_diskIOStatsCollector->setFileExtentsEnabled(isFileExtentsStatsEnabled());
+    m_readCache = std::make_shared<PieceReadCache>();
+    m_readCache->setCapacity(static_cast<qint64>(readCacheSize()) * 1024 * 1024);
+    m_diskJobLimits = std::make_shared<DiskJobLimits>();
+    m_diskJobLimits->setTotalLimit(diskIOJobsLimit());
+    m_diskJobLimits->setLimit(DiskJobClass::Read, diskIOReadingJobsLimit());
+    m_diskJobLimits->setLimit(DiskJobClass::Write, diskIOWritingJobsLimit());
+    m_diskJobLimits->setLimit(DiskJobClass::Hash, diskIOHashingJobsLimit());
+    m_diskJobLimits->setLimit(DiskJobClass::Move, diskIOMovingJobsLimit());
+    m_preallocationPolicy = std::make_shared<PreallocationPolicy>();
+    m_preallocationPolicy->setMinFileSize(static_cast<qint64>(preallocationMinFileSize()) * 1024 * 1024);
+    m_preallocationPolicy->setSavePaths(preallocationPaths());
+    const auto withSharedData = [statsCollector = m_diskIOStatsCollector, readCache = m_readCache, jobLimits = m_diskJobLimits
+            , preallocationPolicy = m_preallocationPolicy](const auto diskIOConstructor) -> lt::disk_io_constructor_type
+    {
+        return [statsCollector, readCache, jobLimits, preallocationPolicy, diskIOConstructor]
+                (lt::io_context &ioContext, const lt::settings_interface &settings, lt::counters &counters)
+        {
+            return diskIOConstructor(ioContext, settings, counters, statsCollector, readCache, jobLimits, preallocationPolicy);
+        };
+    };
+
     switch (diskIOType())
     {
     case DiskIOType::Posix:
-        sessionParams.disk_io_constructor = customPosixDiskIOConstructor;
+        sessionParams.disk_io_constructor = withSharedData(customPosixDiskIOConstructor);
         break;
     case DiskIOType::MMap:
     case DiskIOType::SimplePreadPwrite:
-        sessionParams.disk_io_constructor = customMMapDiskIOConstructor;
+        sessionParams.disk_io_constructor = withSharedData(customMMapDiskIOConstructor);
         break;
 #if LIBTORRENT_VERSION_NUM >= 20100
     case DiskIOType::PreadPwrite:
-        sessionParams.disk_io_constructor = customPreadDiskIOConstructor;
+        sessionParams.disk_io_constructor = withSharedData(customPreadDiskIOConstructor);
         break;
 #endif
     default:
-        sessionParams.disk_io_constructor = customDiskIOConstructor;
+        sessionParams.disk_io_constructor = withSharedData(customDiskIOConstructor);
         break;
     }
 #endif
@@ -2554,6 +2647,14 @@ void SessionImpl::torrentContentRemovingFinished(const QString &torrentName, con
         LogMsg(tr("Failed to remove torrent content. Torrent: \"%1\". Error: \"%2\"")
             .arg(torrentName, errorMessage), Log::WARNING);
     }
+
+    --m_pendingContentRemovingJobsCount;
+    if (m_pendingContentRemovingJobsCount == 0)
+    {
+        const QList<std::function<void ()>> deferredFileSearches = std::exchange(m_deferredFileSearches, {});
+        for (const std::function<void ()> &search : deferredFileSearches)
+            search();
+    }
 }
 
 Torrent *SessionImpl::getTorrent(const TorrentID &id) const
@@ -3142,13 +3243,22 @@ bool SessionImpl::addTorrent_impl(const TorrentDescriptor &torrentDescr, const A
 
 QFuture<FileSearchResult> SessionImpl::findIncompleteFiles(const Path &savePath, const Path &downloadPath, const PathList &filePaths) const
 {
-    QPromise<FileSearchResult> promise;
-    QFuture<FileSearchResult> future = promise.future();
-    promise.start();
-    QMetaObject::invokeMethod(m_fileSearcher, [=, this, promise = std::move(promise)]() mutable
+    if (m_pendingContentRemovingJobsCount == 0)
+        return m_fileSearcher->search(filePaths, savePath, downloadPath, isAppendExtensionEnabled());
+
+    // Searches are performed concurrently with removing of torrent content so they could find
+    // the files that are about to be removed (e.g. when torrent is added again just after removing)
+    auto promise = std::make_shared<QPromise<FileSearchResult>>();
+    QFuture<FileSearchResult> future = promise->future();
+    promise->start();
+    m_deferredFileSearches.append([this, promise, savePath, downloadPath, filePaths]
     {
-        m_fileSearcher->search(filePaths, savePath, downloadPath, isAppendExtensionEnabled(), promise);
-        promise.finish();
+        m_fileSearcher->search(filePaths, savePath, downloadPath, isAppendExtensionEnabled())
+                .then([promise](const FileSearchResult &result)
+        {
+            promise->addResult(result);
+            promise->finish();
+        });
     });
 
     return future;
@@ -4679,6 +4789,102 @@ void SessionImpl::setDiskQueueSize(const qint64 size)
     configureDeferred();
 }
 
+int SessionImpl::readCacheSize() const
+{
+    return m_readCacheSize;
+}
+
+void SessionImpl::setReadCacheSize(const int size)
+{
+    if (size == m_readCacheSize)
+        return;
+
+    m_readCacheSize = size;
+#ifdef QBT_USES_LIBTORRENT2
+    m_readCache->setCapacity(static_cast<qint64>(readCacheSize()) * 1024 * 1024);
+#endif
+}
+
+int SessionImpl::diskIOJobsLimit() const
+{
+    return m_diskIOJobsLimit;
+}
+
+void SessionImpl::setDiskIOJobsLimit(const int limit)
+{
+    if (limit == m_diskIOJobsLimit)
+        return;
+
+    m_diskIOJobsLimit = limit;
+#ifdef QBT_USES_LIBTORRENT2
+    m_diskJobLimits->setTotalLimit(diskIOJobsLimit());
+#endif
+}
+
+int SessionImpl::diskIOReadingJobsLimit() const
+{
+    return m_diskIOReadingJobsLimit;
+}
+
+void SessionImpl::setDiskIOReadingJobsLimit(const int limit)
+{
+    if (limit == m_diskIOReadingJobsLimit)
+        return;
+
+    m_diskIOReadingJobsLimit = limit;
+#ifdef QBT_USES_LIBTORRENT2
+    m_diskJobLimits->setLimit(DiskJobClass::Read, diskIOReadingJobsLimit());
+#endif
+}
+
+int SessionImpl::diskIOWritingJobsLimit() const
+{
+    return m_diskIOWritingJobsLimit;
+}
+
+void SessionImpl::setDiskIOWritingJobsLimit(const int limit)
+{
+    if (limit == m_diskIOWritingJobsLimit)
+        return;
+
+    m_diskIOWritingJobsLimit = limit;
+#ifdef QBT_USES_LIBTORRENT2
+    m_diskJobLimits->setLimit(DiskJobClass::Write, diskIOWritingJobsLimit());
+#endif
+}
+
+int SessionImpl::diskIOHashingJobsLimit() const
+{
+    return m_diskIOHashingJobsLimit;
+}
+
+void SessionImpl::setDiskIOHashingJobsLimit(const int limit)
+{
+    if (limit == m_diskIOHashingJobsLimit)
+        return;
+
+    m_diskIOHashingJobsLimit = limit;
+#ifdef QBT_USES_LIBTORRENT2
+    m_diskJobLimits->setLimit(DiskJobClass::Hash, diskIOHashingJobsLimit());
+#endif
+}
+
+int SessionImpl::diskIOMovingJobsLimit() const
+{
+    return m_diskIOMovingJobsLimit;
+}
+
+void SessionImpl::setDiskIOMovingJobsLimit(const int limit)
+{
+    if (limit == m_diskIOMovingJobsLimit)
+        return;
+
+    m_diskIOMovingJobsLimit = limit;
+#ifdef QBT_USES_LIBTORRENT2
+    m_diskJobLimits->setLimit(DiskJobClass::Move, diskIOMovingJobsLimit());
+#endif
+}
+
 DiskIOReadMode SessionImpl::diskIOReadMode() const
 {
     return m_diskIOReadMode;
@@ -5925,6 +6131,15 @@ const CacheStatus &SessionImpl::cacheStatus() const
     return m_cacheStatus;
 }
 
+QHash<TorrentID, DiskIOStats> SessionImpl::diskIOStats() const
+{
+#ifdef QBT_USES_LIBTORRENT2
+    return m_diskIOStatsCollector->stats();
+#else
+    return {};
+#endif
+}
+
 void SessionImpl::enqueueRefresh()
 {
     Q_ASSERT(!m_refreshEnqueued);
@@ -6556,7 +6771,11 @@ void SessionImpl::handleSessionStatsAlert(const lt::session_stats_alert *alert)
     m_cacheStatus.totalUsedBuffers = stats[m_metricIndices.disk.diskBlocksInUse];
     m_cacheStatus.jobQueueLength = stats[m_metricIndices.disk.queuedDiskJobs];
 
-#ifndef QBT_USES_LIBTORRENT2
+#ifdef QBT_USES_LIBTORRENT2
+    const qint64 numBlocksCacheHits = m_readCache->hitCount();
+    const qint64 numBlocksCacheMisses = m_readCache->missCount();
+    m_cacheStatus.readRatio = static_cast<qreal>(numBlocksCacheHits) / std::max<qint64>((numBlocksCacheHits + numBlocksCacheMisses), 1);
+#else
     const int64_t numBlocksRead = stats[m_metricIndices.disk.numBlocksRead];
     const int64_t numBlocksCacheHits = stats[m_metricIndices.disk.numBlocksCacheHits];
     m_cacheStatus.readRatio = static_cast<qreal>(numBlocksCacheHits) / std::max<int64_t>((numBlocksCacheHits + numBlocksRead), 1);
@@ -6950,6 +7169,7 @@ void SessionImpl::handleRemovedTorrent(const TorrentID &torrentID, const QString
     if ((removingTorrentDataIter->removeOption == TorrentRemoveOption::RemoveContent)
             && !removingTorrentDataIter->contentStoragePath.isEmpty())
     {
+        ++m_pendingContentRemovingJobsCount;
         QMetaObject::invokeMethod(m_torrentContentRemover, [this, jobData = *removingTorrentDataIter]
         {
             m_torrentContentRemover->performJob(jobData.name, jobData.contentStoragePath
@@ -31,6 +31,7 @@
 
 #include <chrono>
 #include <functional>
+#include <memory>
 #include <utility>
 #include <vector>
 
@@ -65,6 +66,10 @@ class QUrl;
 template <typename T> class QFuture;
 
 class BandwidthScheduler;
+class DiskIOStatsCollector;
+class DiskJobLimits;
+class PreallocationPolicy;
+class PieceReadCache;
 class FileSearcher;
 class FilterParserThread;
 class FreeDiskSpaceChecker;
@@ -213,6 +218,12 @@ namespace BitTorrent
         void setRefreshInterval(int value) override;
         bool isPreallocationEnabled() const override;
         void setPreallocationEnabled(bool enabled) override;
+        int preallocationMinFileSize() const override;
+        void setPreallocationMinFileSize(int size) override;
+        PathList preallocationPaths() const override;
+        void setPreallocationPaths(const PathList &paths) override;
+        bool isFileExtentsStatsEnabled() const override;
+        void setFileExtentsStatsEnabled(bool enabled) override;
 
         bool isTorrentFileBackupEnabled() const override;
         void setTorrentFileBackupEnabled(bool enabled) override;
@@ -324,6 +335,18 @@ namespace BitTorrent
         void setDiskCacheTTL(int ttl) override;
         qint64 diskQueueSize() const override;
         void setDiskQueueSize(qint64 size) override;
+        int readCacheSize() const override;
+        void setReadCacheSize(int size) override;
+        int diskIOJobsLimit() const override;
+        void setDiskIOJobsLimit(int limit) override;
+        int diskIOReadingJobsLimit() const override;
+        void setDiskIOReadingJobsLimit(int limit) override;
+        int diskIOWritingJobsLimit() const override;
+        void setDiskIOWritingJobsLimit(int limit) override;
+        int diskIOHashingJobsLimit() const override;
+        void setDiskIOHashingJobsLimit(int limit) override;
+        int diskIOMovingJobsLimit() const override;
+        void setDiskIOMovingJobsLimit(int limit) override;
         DiskIOType diskIOType() const override;
         void setDiskIOType(DiskIOType type) override;
         DiskIOReadMode diskIOReadMode() const override;
@@ -451,6 +474,7 @@ namespace BitTorrent
         qsizetype torrentsCount() const override;
         const SessionStatus &status() const override;
         const CacheStatus &cacheStatus() const override;
+        QHash<TorrentID, DiskIOStats> diskIOStats() const override;
         bool isListening() const override;
 
         void banIP(const QString &ip) override;
@@ -684,6 +708,12 @@ namespace BitTorrent
         CachedSettingValue<int> m_diskCacheSize;
         CachedSettingValue<int> m_diskCacheTTL;
         CachedSettingValue<qint64> m_diskQueueSize;
+        CachedSettingValue<int> m_readCacheSize;
+        CachedSettingValue<int> m_diskIOJobsLimit;
+        CachedSettingValue<int> m_diskIOReadingJobsLimit;
+        CachedSettingValue<int> m_diskIOWritingJobsLimit;
+        CachedSettingValue<int> m_diskIOHashingJobsLimit;
+        CachedSettingValue<int> m_diskIOMovingJobsLimit;
         CachedSettingValue<DiskIOType> m_diskIOType;
         CachedSettingValue<DiskIOReadMode> m_diskIOReadMode;
         CachedSettingValue<DiskIOWriteMode> m_diskIOWriteMode;
@@ -747,6 +777,9 @@ namespace BitTorrent
         CachedSettingValue<bool> m_isUnwantedFolderEnabled;
         CachedSettingValue<int> m_refreshInterval;
         CachedSettingValue<bool> m_isPreallocationEnabled;
+        CachedSettingValue<int> m_preallocationMinFileSize;
+        CachedSettingValue<QStringList> m_preallocationPaths;
+        CachedSettingValue<bool> m_isFileExtentsStatsEnabled;
         CachedSettingValue<bool> m_isTorrentFileBackupEnabled;
         CachedSettingValue<Path> m_torrentBackupDirectory;
         CachedSettingValue<bool> m_isFinishedTorrentBackupDirectoryEnabled;
@@ -851,6 +884,9 @@ namespace BitTorrent
         ResumeDataStorage *m_resumeDataStorage = nullptr;
         FileSearcher *m_fileSearcher = nullptr;
         TorrentContentRemover *m_torrentContentRemover = nullptr;
+        int m_pendingContentRemovingJobsCount = 0;
+        // file searches requested while the content of removed torrents is still being removed
+        mutable QList<std::function<void ()>> m_deferredFileSearches;
 
         using AddTorrentAlertHandler = std::function<void (const lt::add_torrent_alert *alert)>;
         QList<AddTorrentAlertHandler> m_addTorrentAlertHandlers;
@@ -882,6 +918,13 @@ namespace BitTorrent
 
         SessionStatus m_status;
         CacheStatus m_cacheStatus;
+#ifdef QBT_USES_LIBTORRENT2
+        // they are shared with custom disk I/O of native session
+        std::shared_ptr<DiskIOStatsCollector> m_diskIOStatsCollector;
+        std::shared_ptr<PieceReadCache> m_readCache;
+        std::shared_ptr<DiskJobLimits> m_diskJobLimits;
+        std::shared_ptr<PreallocationPolicy> m_preallocationPolicy;
+#endif
 
         QList<MoveStorageJob> m_moveStorageQueue;
 
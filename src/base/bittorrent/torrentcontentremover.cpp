@@ -28,40 +28,182 @@
 
 #include "torrentcontentremover.h"
 
+#include <atomic>
+
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QHash>
+#include <QMutex>
 #include <QSet>
 
+#include "base/global.h"
 #include "base/utils/fs.h"
 
+namespace
+{
+    // Removing is I/O bound, so using more threads than CPU cores
+    // helps to hide the latency of network storages
+    const int MAX_REMOVING_THREADS = 8;
+    const int REMOVING_BATCH_SIZE = 256;
+
+    nonstd::expected<void, QString> removeItem(const Path &path, const BitTorrent::TorrentContentRemoveOption option)
+    {
+        return ((option == BitTorrent::TorrentContentRemoveOption::MoveToTrash)
+                ? Utils::Fs::moveFileToTrash : Utils::Fs::removeFile)(path);
+    }
+
+    // Returns the top level folder of the torrent if it contains nothing but the files of the torrent
+    Path findOwnRootFolder(const Path &basePath, const PathList &fileNames)
+    {
+        const Path rootFolder = fileNames.first().rootItem();
+        if (rootFolder == fileNames.first())
+            return {};
+
+        QSet<Path> files;
+        files.reserve(fileNames.size());
+        for (const Path &fileName : fileNames)
+        {
+            if (fileName.rootItem() != rootFolder)
+                return {};
+
+            files.insert(fileName);
+        }
+
+        const Path rootFolderPath = basePath / rootFolder;
+        if (!Utils::Fs::isDir(rootFolderPath))
+            return {};
+
+        QDirIterator iter {rootFolderPath.data(), (QDir::AllEntries | QDir::Hidden | QDir::System | QDir::NoDotAndDotDot), QDirIterator::Subdirectories};
+        while (iter.hasNext())
+        {
+            const QFileInfo entryInfo = iter.nextFileInfo();
+            if (entryInfo.isDir() && !entryInfo.isSymLink())
+                continue;
+
+            if (!files.contains(basePath.relativePathOf(Path(entryInfo.filePath()))))
+                return {};
+        }
+
+        return rootFolder;
+    }
+
+    QList<PathList> groupByFolder(const PathList &fileNames)
+    {
+        QHash<Path, PathList> folders;
+        for (const Path &fileName : fileNames)
+            folders[fileName.parentPath()].append(fileName);
+
+        QList<PathList> batches;
+        batches.reserve(folders.size());
+        for (const PathList &folderFiles : asConst(folders))
+        {
+            for (qsizetype i = 0; i < folderFiles.size(); i += REMOVING_BATCH_SIZE)
+                batches.append(folderFiles.mid(i, REMOVING_BATCH_SIZE));
+        }
+
+        return batches;
+    }
+}
+
+class BitTorrent::TorrentContentRemover::Job
+{
+public:
+    Job(const QString &torrentName, const Path &basePath, const TorrentContentRemoveOption option)
+        : torrentName {torrentName}
+        , basePath {basePath}
+        , option {option}
+    {
+    }
+
+    void addError(const QString &message)
+    {
+        const QMutexLocker locker {&m_mutex};
+        if (m_errorMessage.isEmpty())
+            m_errorMessage = message;
+    }
+
+    QString errorMessage() const
+    {
+        const QMutexLocker locker {&m_mutex};
+        return m_errorMessage;
+    }
+
+    const QString torrentName;
+    const Path basePath;
+    const TorrentContentRemoveOption option;
+    QSet<Path> topLevelFolders;
+    std::atomic_int pendingBatchesCount = 0;
+
+private:
+    mutable QMutex m_mutex;
+    QString m_errorMessage;
+};
+
+BitTorrent::TorrentContentRemover::TorrentContentRemover(QObject *parent)
+    : QObject(parent)
+    , m_threadPool(this)
+{
+    m_threadPool.setObjectName("TorrentContentRemover m_threadPool");
+    m_threadPool.setMaxThreadCount(MAX_REMOVING_THREADS);
+}
+
 void BitTorrent::TorrentContentRemover::performJob(const QString &torrentName, const Path &basePath
         , const PathList &fileNames, const TorrentContentRemoveOption option)
 {
-    QString errorMessage;
+    if (fileNames.isEmpty())
+    {
+        emit jobFinished(torrentName, {});
+        return;
+    }
 
-    if (!fileNames.isEmpty())
+    m_threadPool.start([this, job = std::make_shared<Job>(torrentName, basePath, option), fileNames]
     {
-        const auto removeFileFn = [&option](const Path &filePath) -> nonstd::expected<void, QString>
+        // Remove (or move to trash) the whole folder at once if it belongs to the torrent
+        if (const Path rootFolder = findOwnRootFolder(job->basePath, fileNames); !rootFolder.isEmpty())
         {
-            return ((option == TorrentContentRemoveOption::MoveToTrash)
-                    ? Utils::Fs::moveFileToTrash : Utils::Fs::removeFile)(filePath);
-        };
+            const Path rootFolderPath = job->basePath / rootFolder;
+            const bool isRemoved = (job->option == TorrentContentRemoveOption::MoveToTrash)
+                    ? Utils::Fs::moveFileToTrash(rootFolderPath).has_value()
+                    : QDir(rootFolderPath.data()).removeRecursively();
+            if (isRemoved)
+            {
+                emit jobFinished(job->torrentName, {});
+                return;
+            }
+        }
 
-        QSet<Path> topLevelFolders;
         for (const Path &fileName : fileNames)
         {
             const Path rootItem = fileName.rootItem();
             if (rootItem != fileName)
-                topLevelFolders.insert(rootItem);
+                job->topLevelFolders.insert(rootItem);
+        }
 
-            if (const auto result = removeFileFn(basePath / fileName)
-                    ; !result && errorMessage.isEmpty())
-            {
-                errorMessage = result.error();
-            }
+        const QList<PathList> batches = groupByFolder(fileNames);
+        job->pendingBatchesCount = static_cast<int>(batches.size());
+        for (const PathList &batch : batches)
+            removeFiles(job, batch);
+    });
+}
+
+void BitTorrent::TorrentContentRemover::removeFiles(std::shared_ptr<Job> job, PathList fileNames)
+{
+    m_threadPool.start([this, job = std::move(job), fileNames = std::move(fileNames)]
+    {
+        for (const Path &fileName : fileNames)
+        {
+            if (const auto result = removeItem((job->basePath / fileName), job->option); !result)
+                job->addError(result.error());
         }
 
-        for (const Path &topLevelFolder : asConst(topLevelFolders))
-            Utils::Fs::smartRemoveEmptyFolderTree(basePath / topLevelFolder);
-    }
+        // the last finished batch completes the job
+        if (job->pendingBatchesCount.fetch_sub(1) > 1)
+            return;
+
+        for (const Path &topLevelFolder : asConst(job->topLevelFolders))
+            Utils::Fs::smartRemoveEmptyFolderTree(job->basePath / topLevelFolder);
 
-    emit jobFinished(torrentName, errorMessage);
+        emit jobFinished(job->torrentName, job->errorMessage());
+    });
 }
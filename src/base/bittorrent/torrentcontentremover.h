@@ -28,7 +28,10 @@
 
 #pragma once
 
+#include <memory>
+
 #include <QObject>
+#include <QThreadPool>
 
 #include "base/path.h"
 #include "torrentcontentremoveoption.h"
@@ -41,13 +44,22 @@ namespace BitTorrent
         Q_DISABLE_COPY_MOVE(TorrentContentRemover)
 
     public:
-        using QObject::QObject;
+        explicit TorrentContentRemover(QObject *parent = nullptr);
 
     public slots:
+        // The job is performed asynchronously, the files are removed concurrently
+        // grouped by the folders containing them
         void performJob(const QString &torrentName, const Path &basePath
                 , const PathList &fileNames, TorrentContentRemoveOption option);
 
     signals:
         void jobFinished(const QString &torrentName, const QString &errorMessage);
+
+    private:
+        class Job;
+
+        void removeFiles(std::shared_ptr<Job> job, PathList fileNames);
+
+        QThreadPool m_threadPool;
     };
 }
@@ -29,6 +29,7 @@
 
 #include "torrentcreationmanager.h"
 
+#include <tuple>
 #include <utility>
 
 #include <boost/multi_index_container.hpp>
@@ -36,10 +37,112 @@
 #include <boost/multi_index/key.hpp>
 #include <boost/multi_index/ordered_index.hpp>
 
+#include <QDir>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSet>
 #include <QUuid>
 
+#include "base/global.h"
+#include "base/logger.h"
+#include "base/profile.h"
+#include "base/utils/fs.h"
+#include "base/utils/io.h"
+
 #define SETTINGS_KEY(name) u"TorrentCreator/Manager/" name
 
+const Path DATA_FOLDER {u"TorrentCreator"_s};
+const QString TASKS_FILE_NAME = u"Tasks.json"_s;
+const QString CHECKPOINT_FILE_EXTENSION = u".checkpoint"_s;
+const int TASKS_FILE_MAX_SIZE = 10 * 1024 * 1024; // 10 MiB
+
+const QString KEY_TASKS = u"Tasks"_s;
+const QString KEY_TASK_ID = u"ID"_s;
+const QString KEY_TASK_TIME_ADDED = u"TimeAdded"_s;
+const QString KEY_TASK_START_SEEDING = u"StartSeeding"_s;
+const QString KEY_PARAM_IGNORE_DOTFILES = u"IgnoreDotfiles"_s;
+const QString KEY_PARAM_PRIVATE = u"Private"_s;
+#ifdef QBT_USES_LIBTORRENT2
+const QString KEY_PARAM_FORMAT = u"Format"_s;
+#else
+const QString KEY_PARAM_OPTIMIZE_ALIGNMENT = u"OptimizeAlignment"_s;
+const QString KEY_PARAM_PADDED_FILE_SIZE_LIMIT = u"PaddedFileSizeLimit"_s;
+#endif
+const QString KEY_PARAM_PIECE_SIZE = u"PieceSize"_s;
+const QString KEY_PARAM_SOURCE_PATH = u"SourcePath"_s;
+const QString KEY_PARAM_TORRENT_FILE_PATH = u"TorrentFilePath"_s;
+const QString KEY_PARAM_COMMENT = u"Comment"_s;
+const QString KEY_PARAM_SOURCE = u"Source"_s;
+const QString KEY_PARAM_TRACKERS = u"Trackers"_s;
+const QString KEY_PARAM_URL_SEEDS = u"URLSeeds"_s;
+
+namespace
+{
+    Path makeDataFilePath(const QString &fileName)
+    {
+        return specialFolderLocation(SpecialFolder::Data) / DATA_FOLDER / Path(fileName);
+    }
+
+    Path makeCheckpointFilePath(const QString &taskID)
+    {
+        return makeDataFilePath(taskID + CHECKPOINT_FILE_EXTENSION);
+    }
+
+    QJsonObject serializeParams(const BitTorrent::TorrentCreatorParams &params)
+    {
+        return {
+            {KEY_PARAM_IGNORE_DOTFILES, params.ignoreDotfiles},
+            {KEY_PARAM_PRIVATE, params.isPrivate},
+#ifdef QBT_USES_LIBTORRENT2
+            {KEY_PARAM_FORMAT, static_cast<int>(params.torrentFormat)},
+#else
+            {KEY_PARAM_OPTIMIZE_ALIGNMENT, params.isAlignmentOptimized},
+            {KEY_PARAM_PADDED_FILE_SIZE_LIMIT, params.paddedFileSizeLimit},
+#endif
+            {KEY_PARAM_PIECE_SIZE, params.pieceSize},
+            {KEY_PARAM_SOURCE_PATH, params.sourcePath.data()},
+            {KEY_PARAM_TORRENT_FILE_PATH, params.torrentFilePath.data()},
+            {KEY_PARAM_COMMENT, params.comment},
+            {KEY_PARAM_SOURCE, params.source},
+            {KEY_PARAM_TRACKERS, QJsonArray::fromStringList(params.trackers)},
+            {KEY_PARAM_URL_SEEDS, QJsonArray::fromStringList(params.urlSeeds)}
+        };
+    }
+
+    QStringList parseStringList(const QJsonArray &jsonArray)
+    {
+        QStringList strings;
+        strings.reserve(jsonArray.size());
+        for (const QJsonValue &jsonValue : jsonArray)
+            strings.append(jsonValue.toString());
+        return strings;
+    }
+
+    BitTorrent::TorrentCreatorParams parseParams(const QJsonObject &jsonObj)
+    {
+        BitTorrent::TorrentCreatorParams params;
+        params.ignoreDotfiles = jsonObj[KEY_PARAM_IGNORE_DOTFILES].toBool(params.ignoreDotfiles);
+        params.isPrivate = jsonObj[KEY_PARAM_PRIVATE].toBool();
+#ifdef QBT_USES_LIBTORRENT2
+        const int format = jsonObj[KEY_PARAM_FORMAT].toInt(static_cast<int>(params.torrentFormat));
+        if ((format >= static_cast<int>(BitTorrent::TorrentFormat::V1)) && (format <= static_cast<int>(BitTorrent::TorrentFormat::Hybrid)))
+            params.torrentFormat = static_cast<BitTorrent::TorrentFormat>(format);
+#else
+        params.isAlignmentOptimized = jsonObj[KEY_PARAM_OPTIMIZE_ALIGNMENT].toBool();
+        params.paddedFileSizeLimit = jsonObj[KEY_PARAM_PADDED_FILE_SIZE_LIMIT].toInt();
+#endif
+        params.pieceSize = jsonObj[KEY_PARAM_PIECE_SIZE].toInt();
+        params.sourcePath = Path(jsonObj[KEY_PARAM_SOURCE_PATH].toString());
+        params.torrentFilePath = Path(jsonObj[KEY_PARAM_TORRENT_FILE_PATH].toString());
+        params.comment = jsonObj[KEY_PARAM_COMMENT].toString();
+        params.source = jsonObj[KEY_PARAM_SOURCE].toString();
+        params.trackers = parseStringList(jsonObj[KEY_PARAM_TRACKERS].toArray());
+        params.urlSeeds = parseStringList(jsonObj[KEY_PARAM_URL_SEEDS].toArray());
+        return params;
+    }
+}
+
 namespace BitTorrent
 {
     using namespace boost::multi_index;
@@ -65,9 +168,18 @@ BitTorrent::TorrentCreationManager::TorrentCreationManager(IApplication *app, QO
 
     if (m_numThreads > 0)
         m_threadPool.setMaxThreadCount(m_numThreads);
+
+    loadTasks();
 }
 
-BitTorrent::TorrentCreationManager::~TorrentCreationManager() = default;
+BitTorrent::TorrentCreationManager::~TorrentCreationManager()
+{
+    // Interrupt unfinished tasks so that they save their progress
+    // and can be resumed the next time the manager is created
+    m_threadPool.clear();
+    m_tasks->clear();
+    m_threadPool.waitForDone();
+}
 
 std::shared_ptr<BitTorrent::TorrentCreationTask> BitTorrent::TorrentCreationManager::createTask(const TorrentCreatorParams &params, const bool startSeeding)
 {
@@ -84,11 +196,21 @@ std::shared_ptr<BitTorrent::TorrentCreationTask> BitTorrent::TorrentCreationMana
     if (std::cmp_greater_equal(m_tasks->size(), m_maxTasks.get()))
         return {};
 
-    const QString taskID = generateTaskID();
+    auto creationTask = addTask(generateTaskID(), params, startSeeding, QDateTime::currentDateTime());
+    saveTasks();
 
+    return creationTask;
+}
+
+std::shared_ptr<BitTorrent::TorrentCreationTask> BitTorrent::TorrentCreationManager::addTask(const QString &id
+        , const TorrentCreatorParams &params, const bool startSeeding, const QDateTime &timeAdded)
+{
     auto *torrentCreator = new TorrentCreator(params, this);
-    auto creationTask = std::make_shared<TorrentCreationTask>(app(), taskID, torrentCreator, startSeeding);
+    torrentCreator->setCheckpointPath(makeCheckpointFilePath(id));
+    auto creationTask = std::make_shared<TorrentCreationTask>(app(), id, torrentCreator, startSeeding, timeAdded);
     connect(creationTask.get(), &QObject::destroyed, torrentCreator, &BitTorrent::TorrentCreator::requestInterruption);
+    connect(torrentCreator, &BitTorrent::TorrentCreator::creationSuccess, this, [this, id] { handleTaskFinished(id); });
+    connect(torrentCreator, &BitTorrent::TorrentCreator::creationFailure, this, [this, id] { handleTaskFinished(id); });
 
     m_tasks->get<ByID>().insert(creationTask);
     m_threadPool.start(torrentCreator);
@@ -96,6 +218,93 @@ std::shared_ptr<BitTorrent::TorrentCreationTask> BitTorrent::TorrentCreationMana
     return creationTask;
 }
 
+void BitTorrent::TorrentCreationManager::handleTaskFinished(const QString &id)
+{
+    std::ignore = Utils::Fs::removeFile(makeCheckpointFilePath(id));
+    saveTasks();
+}
+
+void BitTorrent::TorrentCreationManager::loadTasks()
+{
+    const Path tasksFilePath = makeDataFilePath(TASKS_FILE_NAME);
+    const auto readResult = Utils::IO::readFile(tasksFilePath, TASKS_FILE_MAX_SIZE);
+    if (!readResult)
+    {
+        if (readResult.error().status != Utils::IO::ReadError::NotExist)
+        {
+            LogMsg(tr("Failed to load torrent creation tasks. File: \"%1\". Error: \"%2\"")
+                    .arg(tasksFilePath.toString(), readResult.error().message), Log::WARNING);
+        }
+        return;
+    }
+
+    QJsonParseError jsonError;
+    const QJsonDocument jsonDoc = QJsonDocument::fromJson(readResult.value(), &jsonError);
+    if (jsonError.error != QJsonParseError::NoError)
+    {
+        LogMsg(tr("Failed to parse torrent creation tasks. File: \"%1\". Error: \"%2\"")
+                .arg(tasksFilePath.toString(), jsonError.errorString()), Log::WARNING);
+        return;
+    }
+
+    QSet<QString> taskIDs;
+    const QJsonArray tasksArray = jsonDoc.object()[KEY_TASKS].toArray();
+    for (const QJsonValue &taskValue : tasksArray)
+    {
+        if (std::cmp_greater_equal(m_tasks->size(), m_maxTasks.get()))
+            break;
+
+        const QJsonObject taskObj = taskValue.toObject();
+        const QString taskID = taskObj[KEY_TASK_ID].toString();
+        const TorrentCreatorParams params = parseParams(taskObj);
+        if (taskID.isEmpty() || taskIDs.contains(taskID) || params.sourcePath.isEmpty())
+            continue;
+
+        const QDateTime timeAdded = QDateTime::fromSecsSinceEpoch(taskObj[KEY_TASK_TIME_ADDED].toInteger());
+        addTask(taskID, params, taskObj[KEY_TASK_START_SEEDING].toBool(), timeAdded);
+        taskIDs.insert(taskID);
+    }
+
+    // Remove the checkpoints of the tasks that aren't resumed
+    const Path dataFolderPath = specialFolderLocation(SpecialFolder::Data) / DATA_FOLDER;
+    const QStringList checkpointFileNames = QDir(dataFolderPath.data()).entryList({u'*' + CHECKPOINT_FILE_EXTENSION}, QDir::Files);
+    for (const QString &fileName : checkpointFileNames)
+    {
+        if (!taskIDs.contains(fileName.chopped(CHECKPOINT_FILE_EXTENSION.size())))
+            std::ignore = Utils::Fs::removeFile(dataFolderPath / Path(fileName));
+    }
+}
+
+void BitTorrent::TorrentCreationManager::saveTasks() const
+{
+    // Only unfinished tasks are saved so they can be resumed
+    QJsonArray tasksArray;
+    for (const std::shared_ptr<TorrentCreationTask> &task : asConst(tasks()))
+    {
+        if (task->isFinished())
+            continue;
+
+        QJsonObject taskObj = serializeParams(task->params());
+        taskObj[KEY_TASK_ID] = task->id();
+        taskObj[KEY_TASK_TIME_ADDED] = task->timeAdded().toSecsSinceEpoch();
+        taskObj[KEY_TASK_START_SEEDING] = task->isStartSeeding();
+        tasksArray.append(taskObj);
+    }
+
+    const Path tasksFilePath = makeDataFilePath(TASKS_FILE_NAME);
+
+    // Ensure directory exists
+    Utils::Fs::mkpath(tasksFilePath.parentPath());
+
+    const QJsonObject jsonObj {{KEY_TASKS, tasksArray}};
+    const auto saveResult = Utils::IO::saveToFile(tasksFilePath, QJsonDocument(jsonObj).toJson());
+    if (!saveResult)
+    {
+        LogMsg(tr("Failed to save torrent creation tasks. File: \"%1\". Error: \"%2\"")
+                .arg(tasksFilePath.toString(), saveResult.error()), Log::WARNING);
+    }
+}
+
 QString BitTorrent::TorrentCreationManager::generateTaskID() const
 {
     const auto &tasksByID = m_tasks->get<ByID>();
@@ -130,5 +339,7 @@ bool BitTorrent::TorrentCreationManager::deleteTask(const QString &id)
         return false;
 
     tasksByID.erase(iter);
+    std::ignore = Utils::Fs::removeFile(makeCheckpointFilePath(id));
+    saveTasks();
     return true;
 }
@@ -32,6 +32,7 @@
 #include <memory>
 
 #include <QtContainerFwd>
+#include <QDateTime>
 #include <QObject>
 #include <QThreadPool>
 
@@ -58,6 +59,11 @@ namespace BitTorrent
 
     private:
         QString generateTaskID() const;
+        std::shared_ptr<TorrentCreationTask> addTask(const QString &id, const TorrentCreatorParams &params
+                , bool startSeeding, const QDateTime &timeAdded);
+        void loadTasks();
+        void saveTasks() const;
+        void handleTaskFinished(const QString &id);
 
         CachedSettingValue<qint32> m_maxTasks;
         CachedSettingValue<qint32> m_numThreads;
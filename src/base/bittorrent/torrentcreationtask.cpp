@@ -34,11 +34,12 @@
 #include "base/bittorrent/addtorrentparams.h"
 
 BitTorrent::TorrentCreationTask::TorrentCreationTask(IApplication *app, const QString &id
-        , TorrentCreator *torrentCreator, bool startSeeding, QObject *parent)
+        , TorrentCreator *torrentCreator, const bool startSeeding, const QDateTime &timeAdded, QObject *parent)
     : ApplicationComponent(app, parent)
     , m_id {id}
     , m_params {torrentCreator->params()}
-    , m_timeAdded {QDateTime::currentDateTime()}
+    , m_startSeeding {startSeeding}
+    , m_timeAdded {timeAdded}
 {
     Q_ASSERT(torrentCreator);
 
@@ -94,6 +95,11 @@ const BitTorrent::TorrentCreatorParams &BitTorrent::TorrentCreationTask::params(
     return m_params;
 }
 
+bool BitTorrent::TorrentCreationTask::isStartSeeding() const
+{
+    return m_startSeeding;
+}
+
 BitTorrent::TorrentCreationTask::State BitTorrent::TorrentCreationTask::state() const
 {
     if (m_timeStarted.isNull())
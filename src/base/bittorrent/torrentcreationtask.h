@@ -52,10 +52,11 @@ namespace BitTorrent
         };
 
         TorrentCreationTask(IApplication *app, const QString &id, TorrentCreator *torrentCreator
-                , bool startSeeding, QObject *parent = nullptr);
+                , bool startSeeding, const QDateTime &timeAdded, QObject *parent = nullptr);
 
         QString id() const;
         const TorrentCreatorParams &params() const;
+        bool isStartSeeding() const;
         State state() const;
         bool isQueued() const;
         bool isRunning() const;
@@ -71,6 +72,7 @@ namespace BitTorrent
     private:
         QString m_id;
         TorrentCreatorParams m_params;
+        bool m_startSeeding = false;
         QDateTime m_timeAdded;
         QDateTime m_timeStarted;
         QDateTime m_timeFinished;
@@ -30,28 +30,53 @@
 
 #include "torrentcreator.h"
 
+#include <algorithm>
 #include <functional>
+#include <memory>
 #include <string_view>
+#include <tuple>
+#include <vector>
 
+#include <libtorrent/bdecode.hpp>
 #include <libtorrent/create_torrent.hpp>
 #include <libtorrent/file_storage.hpp>
 #include <libtorrent/torrent_info.hpp>
 #include <libtorrent/version.hpp>
 
+#include <QtEndian>
 #include <QtSystemDetection>
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDateTime>
 #include <QDirIterator>
+#include <QElapsedTimer>
 #include <QFileInfo>
+#include <QFuture>
 #include <QHash>
+#include <QPromise>
+#include <QThread>
 
 #include "base/exceptions.h"
 #include "base/global.h"
+#include "base/logger.h"
 #include "base/utils/compare.h"
+#include "base/utils/fs.h"
 #include "base/utils/io.h"
 #include "base/version.h"
-#include "lttypecast.h"
+#include "piecehasher.h"
+#include "session.h"
+#include "torrent.h"
 
 namespace
 {
+    const qint64 CHECKPOINT_INTERVAL = 60 * 1000; // 1 min
+
+#ifdef QBT_USES_LIBTORRENT2
+    const std::size_t HASHES_RECORD_SIZE = 4 + lt::sha1_hash::size() + lt::sha256_hash::size();
+#else
+    const std::size_t HASHES_RECORD_SIZE = 4 + lt::sha1_hash::size();
+#endif
+
     bool isDotfile(const Path &path)
     {
         return path.filename().startsWith(u'.');
@@ -83,7 +108,199 @@ namespace
         }
         return {};
     }
+
+    lt::sha256_hash sourcePieceV2Hash(const lt::torrent_info &sourceInfo, const lt::file_index_t sourceFile, const lt::piece_index_t piece)
+    {
+        const lt::file_storage &sourceFiles = sourceInfo.files();
+        if (sourceFiles.file_size(sourceFile) <= sourceFiles.piece_length())
+            return sourceFiles.root(sourceFile);
+
+        const auto hashSize = static_cast<qint64>(lt::sha256_hash::size());
+        const qint64 pieceInFile = static_cast<int>(piece) - (sourceFiles.file_offset(sourceFile) / sourceFiles.piece_length());
+        const lt::span<const char> pieceLayer = sourceInfo.piece_layer(sourceFile);
+        // piece layers aren't always kept in loaded torrent metadata
+        if (pieceLayer.size() < ((pieceInFile + 1) * hashSize))
+            return {};
+
+        return lt::sha256_hash(pieceLayer.data() + (pieceInFile * hashSize));
+    }
+#endif
+
+    // Sets the hashes of the pieces of new torrent that have the same content in the source torrent.
+    // Such pieces must be verified by the source torrent and consist of the same files
+    // (and padding) located at the same offsets. Returns the number of reused pieces.
+    int reusePieceHashes(lt::create_torrent &torrent, const Path &basePath, const lt::torrent_info &sourceInfo
+            , const std::vector<Path> &sourceFilePaths, const QBitArray &sourcePieces, std::vector<bool> &hashedPieces)
+    {
+        const lt::file_storage &files = torrent.files();
+        const lt::file_storage &sourceFiles = sourceInfo.files();
+        if (sourceFiles.piece_length() != files.piece_length())
+            return 0;
+
+#ifdef QBT_USES_LIBTORRENT2
+        const bool needV1Hashes = !torrent.is_v2_only();
+        const bool needV2Hashes = !torrent.is_v1_only();
+        if ((needV1Hashes && !sourceInfo.info_hashes().has_v1()) || (needV2Hashes && !sourceInfo.v2()))
+            return 0;
+#endif
+
+        const auto isMatchingSlice = [&files, &sourceFiles, &sourceFilePaths, &basePath](const lt::file_slice &slice)
+        {
+            const qint64 offset = files.file_offset(slice.file_index) + slice.offset;
+            const lt::file_index_t sourceFile = sourceFiles.file_index_at_offset(offset);
+            if (files.pad_file_at(slice.file_index))
+            {
+                return sourceFiles.pad_file_at(sourceFile)
+                        && ((offset + slice.size) <= (sourceFiles.file_offset(sourceFile) + sourceFiles.file_size(sourceFile)));
+            }
+
+            return !sourceFiles.pad_file_at(sourceFile)
+                    && (sourceFiles.file_offset(sourceFile) == files.file_offset(slice.file_index))
+                    && (sourceFiles.file_size(sourceFile) == files.file_size(slice.file_index))
+                    && (sourceFilePaths[static_cast<int>(sourceFile)] == (basePath / Path(files.file_path(slice.file_index))));
+        };
+
+        int reusedPiecesCount = 0;
+        for (const lt::piece_index_t piece : files.piece_range())
+        {
+            const int pieceIndex = static_cast<int>(piece);
+            if (hashedPieces[pieceIndex] || (pieceIndex >= sourceFiles.num_pieces()) || !sourcePieces.testBit(pieceIndex))
+                continue;
+
+            const int pieceSize = files.piece_size(piece);
+            if (sourceFiles.piece_size(piece) != pieceSize)
+                continue;
+
+            const std::vector<lt::file_slice> slices = files.map_block(piece, 0, pieceSize);
+            if (!std::ranges::all_of(slices, isMatchingSlice))
+                continue;
+
+            BitTorrent::PieceHashes hashes {.piece = piece};
+#ifdef QBT_USES_LIBTORRENT2
+            if (needV1Hashes)
+                hashes.v1Hash = sourceInfo.hash_for_piece(piece);
+
+            if (needV2Hashes)
+            {
+                // pieces of v2 torrent contain the data of a single file
+                const auto dataSliceIter = std::ranges::find_if(slices, [&files](const lt::file_slice &slice)
+                {
+                    return !files.pad_file_at(slice.file_index);
+                });
+                if (dataSliceIter == slices.end())
+                    continue;
+
+                const lt::file_index_t sourceFile = sourceFiles.file_index_at_offset(files.file_offset(dataSliceIter->file_index));
+                hashes.v2Hash = sourcePieceV2Hash(sourceInfo, sourceFile, piece);
+                if (hashes.v2Hash.is_all_zeros())
+                    continue;
+            }
+#else
+            hashes.v1Hash = sourceInfo.hash_for_piece(piece);
+#endif
+
+            BitTorrent::PieceHasher::setPieceHashes(torrent, hashes);
+            hashedPieces[pieceIndex] = true;
+            ++reusedPiecesCount;
+        }
+
+        return reusedPiecesCount;
+    }
+
+    // Identifies the content and the layout of new torrent, so the checkpoint
+    // becomes invalid when any of the files is modified or the parameters are changed
+    QByteArray makeCheckpointFingerprint(const lt::create_torrent &torrent, const Path &basePath)
+    {
+        const lt::file_storage &files = torrent.files();
+
+        QCryptographicHash hash {QCryptographicHash::Sha1};
+        hash.addData(QByteArray::number(files.piece_length()) + '\n' + QByteArray::number(HASHES_RECORD_SIZE) + '\n');
+#ifdef QBT_USES_LIBTORRENT2
+        hash.addData(QByteArray::number(torrent.is_v1_only()) + QByteArray::number(torrent.is_v2_only()) + '\n');
+#endif
+        for (const lt::file_index_t index : files.file_range())
+        {
+            QByteArray fileEntry = QByteArray::number(files.file_size(index));
+            if (files.pad_file_at(index))
+            {
+                fileEntry += " pad";
+            }
+            else
+            {
+                const std::string filePath = files.file_path(index);
+                const QDateTime lastModified = QFileInfo((basePath / Path(filePath)).data()).lastModified();
+                fileEntry += ' ' + QByteArray::number(lastModified.toMSecsSinceEpoch()) + ' ' + QByteArray::fromStdString(filePath);
+            }
+            hash.addData(fileEntry + '\n');
+        }
+
+        return hash.result();
+    }
+
+    std::vector<BitTorrent::PieceHashes> loadCheckpoint(const Path &path, const QByteArray &fingerprint, const int piecesCount)
+    {
+        const auto readResult = Utils::IO::readFile(path, -1);
+        if (!readResult)
+            return {};
+
+        lt::error_code ec;
+        const lt::bdecode_node root = lt::bdecode(readResult.value(), ec);
+        if (ec || (root.type() != lt::bdecode_node::dict_t))
+            return {};
+        const auto storedFingerprint = root.dict_find_string_value("fingerprint");
+        if (QByteArrayView(storedFingerprint.data(), static_cast<qsizetype>(storedFingerprint.size())) != fingerprint)
+            return {};
+
+        const auto data = root.dict_find_string_value("hashes");
+        if ((data.size() % HASHES_RECORD_SIZE) != 0)
+            return {};
+
+        std::vector<BitTorrent::PieceHashes> hashesList;
+        hashesList.reserve(data.size() / HASHES_RECORD_SIZE);
+        for (std::size_t offset = 0; offset < data.size(); offset += HASHES_RECORD_SIZE)
+        {
+            const char *record = data.data() + offset;
+            const auto pieceIndex = qFromLittleEndian<qint32>(record);
+            if ((pieceIndex < 0) || (pieceIndex >= piecesCount))
+                return {};
+
+            BitTorrent::PieceHashes hashes {.piece = lt::piece_index_t(pieceIndex)};
+            hashes.v1Hash = lt::sha1_hash(record + 4);
+#ifdef QBT_USES_LIBTORRENT2
+            hashes.v2Hash = lt::sha256_hash(record + 4 + lt::sha1_hash::size());
 #endif
+            hashesList.push_back(hashes);
+        }
+
+        return hashesList;
+    }
+
+    void saveCheckpoint(const Path &path, const QByteArray &fingerprint, const std::vector<BitTorrent::PieceHashes> &hashesList)
+    {
+        std::string data;
+        data.reserve(hashesList.size() * HASHES_RECORD_SIZE);
+        for (const BitTorrent::PieceHashes &hashes : hashesList)
+        {
+            char pieceIndex[4];
+            qToLittleEndian<qint32>(static_cast<int>(hashes.piece), pieceIndex);
+            data.append(pieceIndex, sizeof(pieceIndex));
+            data.append(hashes.v1Hash.data(), hashes.v1Hash.size());
+#ifdef QBT_USES_LIBTORRENT2
+            data.append(hashes.v2Hash.data(), hashes.v2Hash.size());
+#endif
+        }
+
+        lt::entry checkpoint;
+        checkpoint["fingerprint"] = fingerprint.toStdString();
+        checkpoint["hashes"] = std::move(data);
+
+        const nonstd::expected<void, QString> result = Utils::IO::saveToFile(path, checkpoint);
+        if (!result)
+        {
+            LogMsg(QCoreApplication::translate("BitTorrent::TorrentCreator", "Failed to save torrent creation checkpoint. File: \"%1\". Error: \"%2\"")
+                    .arg(path.toString(), result.error()), Log::WARNING);
+        }
+    }
 }
 
 using namespace BitTorrent;
@@ -94,6 +311,61 @@ TorrentCreator::TorrentCreator(const TorrentCreatorParams &params, QObject *pare
 {
 }
 
+QList<TorrentCreator::HashSource> TorrentCreator::fetchHashSources() const
+{
+    // Torrents can be accessed only from the main thread. The sources are requested
+    // when hashing starts, since the resumed tasks are created before torrents are loaded.
+    auto promise = std::make_shared<QPromise<QList<HashSource>>>();
+    QFuture<QList<HashSource>> future = promise->future();
+    promise->start();
+
+    Session *session = Session::instance();
+    QMetaObject::invokeMethod(session, [session, promise, sourcePath = m_params.sourcePath]
+    {
+        const auto finish = [promise, sourcePath]
+        {
+            promise->addResult(findHashSources(sourcePath));
+            promise->finish();
+        };
+
+        if (session->isRestored())
+            finish();
+        else
+            QObject::connect(session, &Session::restored, session, finish, Qt::SingleShotConnection);
+    }, Qt::QueuedConnection);
+
+    // The main thread doesn't handle the request when the application is shutting down,
+    // but the task is interrupted in this case so it doesn't wait forever
+    while (!future.isFinished())
+    {
+        checkInterruptionRequested();
+        QThread::msleep(100);
+    }
+
+    return future.result();
+}
+
+QList<TorrentCreator::HashSource> TorrentCreator::findHashSources(const Path &sourcePath)
+{
+    QList<HashSource> hashSources;
+    for (const Torrent *torrent : asConst(Session::instance()->torrents()))
+    {
+        if (!torrent->hasMetadata() || torrent->isChecking() || (torrent->piecesHave() == 0))
+            continue;
+        if (torrent->contentPath() != sourcePath)
+            continue;
+
+        const Path storageLocation = torrent->actualStorageLocation();
+        PathList filePaths = torrent->actualFilePaths();
+        for (Path &filePath : filePaths)
+            filePath = storageLocation / filePath;
+
+        hashSources.append({.torrentInfo = torrent->info(), .filePaths = filePaths, .pieces = torrent->pieces()});
+    }
+
+    return hashSources;
+}
+
 void TorrentCreator::sendProgressSignal(const int currentPieceIdx, const int totalPieces)
 {
     Q_ASSERT(totalPieces > 0);
@@ -250,13 +522,85 @@ void TorrentCreator::run()
                 newTorrent.add_tracker(tracker.trimmed().toStdString(), tier);
         }
 
-        // calculate the hash for all pieces
-        lt::set_piece_hashes(newTorrent, parentPath.toString().toStdString()
-            , [this, &newTorrent](const lt::piece_index_t n)
+        std::vector<bool> hashedPieces(static_cast<std::size_t>(newTorrent.num_pieces()), false);
+        int hashedPiecesCount = 0;
+
+        // restore the hashes calculated before the task was interrupted
+        QByteArray checkpointFingerprint;
+        std::vector<PieceHashes> calculatedHashes;
+        if (!m_checkpointPath.isEmpty())
+        {
+            checkpointFingerprint = makeCheckpointFingerprint(newTorrent, parentPath);
+            calculatedHashes = loadCheckpoint(m_checkpointPath, checkpointFingerprint, newTorrent.num_pieces());
+            for (const PieceHashes &hashes : calculatedHashes)
+            {
+                const int pieceIndex = static_cast<int>(hashes.piece);
+                if (hashedPieces[pieceIndex])
+                    continue;
+
+                PieceHasher::setPieceHashes(newTorrent, hashes);
+                hashedPieces[pieceIndex] = true;
+                ++hashedPiecesCount;
+            }
+        }
+
+        // reuse the hashes of the pieces that are already verified by the torrents with the same content
+        const QList<HashSource> hashSources = (hashedPiecesCount < newTorrent.num_pieces()) ? fetchHashSources() : QList<HashSource>();
+        for (const HashSource &hashSource : hashSources)
         {
+            const std::shared_ptr<const lt::torrent_info> sourceInfo = hashSource.torrentInfo.nativeInfo();
+            if (!sourceInfo)
+                continue;
+
+            std::vector<Path> sourceFilePaths(static_cast<std::size_t>(sourceInfo->files().num_files()));
+            const QList<lt::file_index_t> nativeIndexes = hashSource.torrentInfo.nativeIndexes();
+            for (int i = 0; i < nativeIndexes.size(); ++i)
+                sourceFilePaths[static_cast<int>(nativeIndexes[i])] = hashSource.filePaths.value(i);
+
+            hashedPiecesCount += reusePieceHashes(newTorrent, parentPath, *sourceInfo, sourceFilePaths, hashSource.pieces, hashedPieces);
             checkInterruptionRequested();
-            sendProgressSignal(LT::toUnderlyingType(n), newTorrent.num_pieces());
-        });
+        }
+        if (hashedPiecesCount > 0)
+            sendProgressSignal(hashedPiecesCount, newTorrent.num_pieces());
+
+        // calculate the hash for the rest of pieces
+        std::vector<lt::piece_index_t> pieces;
+        pieces.reserve(static_cast<std::size_t>(newTorrent.num_pieces() - hashedPiecesCount));
+        for (const lt::piece_index_t piece : newTorrent.piece_range())
+        {
+            if (!hashedPieces[static_cast<int>(piece)])
+                pieces.push_back(piece);
+        }
+
+        const PieceHasher pieceHasher {newTorrent, parentPath, QThread::idealThreadCount()};
+        QElapsedTimer checkpointTimer;
+        checkpointTimer.start();
+        try
+        {
+            pieceHasher.hashPieces(pieces, [this, &newTorrent, &hashedPiecesCount, &calculatedHashes
+                    , &checkpointFingerprint, &checkpointTimer](const PieceHashes &hashes)
+            {
+                PieceHasher::setPieceHashes(newTorrent, hashes);
+                ++hashedPiecesCount;
+                sendProgressSignal(hashedPiecesCount, newTorrent.num_pieces());
+
+                if (m_checkpointPath.isEmpty())
+                    return;
+
+                calculatedHashes.push_back(hashes);
+                if (checkpointTimer.hasExpired(CHECKPOINT_INTERVAL))
+                {
+                    saveCheckpoint(m_checkpointPath, checkpointFingerprint, calculatedHashes);
+                    checkpointTimer.restart();
+                }
+            }, [this] { checkInterruptionRequested(); });
+        }
+        catch (const RuntimeError &)
+        {
+            if (!m_checkpointPath.isEmpty() && !calculatedHashes.empty())
+                saveCheckpoint(m_checkpointPath, checkpointFingerprint, calculatedHashes);
+            throw;
+        }
 
         // Set qBittorrent as creator and add user comment to
         // torrent_info structure
@@ -296,6 +640,9 @@ void TorrentCreator::run()
             .pieceSize = newTorrent.piece_length()
         };
 
+        if (!m_checkpointPath.isEmpty())
+            std::ignore = Utils::Fs::removeFile(m_checkpointPath);
+
         emit progressUpdated(100);
         emit creationSuccess(creatorResult);
     }
@@ -318,6 +665,16 @@ const TorrentCreatorParams &TorrentCreator::params() const
     return m_params;
 }
 
+Path TorrentCreator::checkpointPath() const
+{
+    return m_checkpointPath;
+}
+
+void TorrentCreator::setCheckpointPath(const Path &path)
+{
+    m_checkpointPath = path;
+}
+
 #ifdef QBT_USES_LIBTORRENT2
 int TorrentCreator::calculateTotalPieces(const Path &inputPath, const int pieceSize, const bool ignoreDotfiles, const TorrentFormat torrentFormat)
 #else
@@ -32,11 +32,14 @@
 
 #include <atomic>
 
+#include <QBitArray>
+#include <QList>
 #include <QObject>
 #include <QRunnable>
 #include <QStringList>
 
 #include "base/path.h"
+#include "torrentinfo.h"
 
 namespace BitTorrent
 {
@@ -86,6 +89,11 @@ namespace BitTorrent
         const TorrentCreatorParams &params() const;
         bool isInterruptionRequested() const;
 
+        // If set, the calculated piece hashes are periodically saved to the given file,
+        // so the creation can be resumed after interruption. It must be set before starting.
+        Path checkpointPath() const;
+        void setCheckpointPath(const Path &path);
+
         void run() override;
 
 #ifdef QBT_USES_LIBTORRENT2
@@ -104,10 +112,22 @@ namespace BitTorrent
         void progressUpdated(int progress);
 
     private:
+        // Loaded torrent whose content is the source of new torrent
+        struct HashSource
+        {
+            TorrentInfo torrentInfo;
+            PathList filePaths;  // absolute paths, indexed as in torrentInfo
+            QBitArray pieces;
+        };
+
+        static QList<HashSource> findHashSources(const Path &sourcePath);
+        QList<HashSource> fetchHashSources() const;
+
         void sendProgressSignal(int currentPieceIdx, int totalPieces);
         void checkInterruptionRequested() const;
 
         TorrentCreatorParams m_params;
+        Path m_checkpointPath;
         std::atomic_bool m_interruptionRequested;
     };
 }
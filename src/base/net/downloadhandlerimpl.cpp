@@ -127,6 +127,14 @@ void Net::DownloadHandlerImpl::processFinishedDownload()
         return;
     }
 
+    // Conditional request was made and the resource isn't modified
+    if (m_reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() == 304)
+    {
+        m_result.status = DownloadStatus::NotModified;
+        finish();
+        return;
+    }
+
     // Check if the server ask us to redirect somewhere else
     const QVariant redirection = m_reply->attribute(QNetworkRequest::RedirectionTargetAttribute);
     if (redirection.isValid())
@@ -136,6 +144,9 @@ void Net::DownloadHandlerImpl::processFinishedDownload()
     }
 
     // Success
+    m_result.eTag = QString::fromLatin1(m_reply->rawHeader("ETag"));
+    m_result.lastModified = QString::fromLatin1(m_reply->rawHeader("Last-Modified"));
+
 #ifdef QT_NO_COMPRESS
     m_result.data = (m_reply->rawHeader("Content-Encoding") == "gzip")
                     ? Utils::Gzip::decompress(m_reply->readAll())
@@ -330,6 +330,11 @@ void Net::DownloadManager::processRequest(DownloadHandlerImpl *downloadHandler)
     // gzip encoding and manually decompress the reply data.
     request.setRawHeader("Accept-Encoding", "gzip");
 #endif
+    if (!downloadRequest.ifNoneMatch().isEmpty())
+        request.setRawHeader("If-None-Match", downloadRequest.ifNoneMatch().toUtf8());
+    if (!downloadRequest.ifModifiedSince().isEmpty())
+        request.setRawHeader("If-Modified-Since", downloadRequest.ifModifiedSince().toUtf8());
+
     // Qt doesn't support Magnet protocol so we need to handle redirections manually
     request.setAttribute(QNetworkRequest::RedirectPolicyAttribute, QNetworkRequest::ManualRedirectPolicy);
 
@@ -403,6 +408,28 @@ Net::DownloadRequest &Net::DownloadRequest::destFileName(const Path &value)
     return *this;
 }
 
+QString Net::DownloadRequest::ifNoneMatch() const
+{
+    return m_ifNoneMatch;
+}
+
+Net::DownloadRequest &Net::DownloadRequest::ifNoneMatch(const QString &value)
+{
+    m_ifNoneMatch = value;
+    return *this;
+}
+
+QString Net::DownloadRequest::ifModifiedSince() const
+{
+    return m_ifModifiedSince;
+}
+
+Net::DownloadRequest &Net::DownloadRequest::ifModifiedSince(const QString &value)
+{
+    m_ifModifiedSince = value;
+    return *this;
+}
+
 Net::ServiceID Net::ServiceID::fromURL(const QUrl &url)
 {
     return {url.host(), url.port(80)};
@@ -64,6 +64,8 @@ namespace Net
     {
         Success,
         RedirectedToMagnet,
+        // the resource isn't modified since it was downloaded last time (see DownloadRequest::ifNoneMatch)
+        NotModified,
         Failed
     };
 
@@ -91,12 +93,22 @@ namespace Net
         Path destFileName() const;
         DownloadRequest &destFileName(const Path &value);
 
+        // Validators of previously downloaded resource (see DownloadResult::eTag
+        // and DownloadResult::lastModified) used to make the request conditional
+        QString ifNoneMatch() const;
+        DownloadRequest &ifNoneMatch(const QString &value);
+
+        QString ifModifiedSince() const;
+        DownloadRequest &ifModifiedSince(const QString &value);
+
     private:
         QString m_url;
         QString m_userAgent;
         qint64 m_limit = 0;
         bool m_saveToFile = false;
         Path m_destFileName;
+        QString m_ifNoneMatch;
+        QString m_ifModifiedSince;
     };
 
     struct DownloadResult
@@ -107,6 +119,8 @@ namespace Net
         QByteArray data;
         Path filePath;
         QString magnetURI;
+        QString eTag;
+        QString lastModified;
     };
 
     class DownloadHandler : public QObject
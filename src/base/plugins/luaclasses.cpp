@@ -41,6 +41,8 @@
 #include "base/bittorrent/trackerentrystatus.h"
 #include "luanamespace.h"
 #include "luastack.h"
+#include "luaviews.h"
+#include "torrentsbatch.h"
 
 namespace
 {
@@ -128,6 +130,51 @@ namespace
         cls.addFunction("stop", &Torrent::stop);
     }
 
+    void registerLuaClassTorrentsBatch(lua_State *luaState)
+    {
+        auto qBittorrentNS = luabridge::getGlobalNamespace(luaState).beginNamespace(QBT_NAMESPACE);
+        auto cls = qBittorrentNS.beginClass<TorrentsBatch>("TorrentsBatch");
+
+        cls.addConstructor<void ()>();
+        cls.addProperty("size", &TorrentsBatch::size);
+        cls.addFunction("setCategory", &TorrentsBatch::setCategory);
+        cls.addFunction("addTag", &TorrentsBatch::addTag);
+        cls.addFunction("removeTag", &TorrentsBatch::removeTag);
+        cls.addFunction("setSavePath", &TorrentsBatch::setSavePath);
+        cls.addFunction("start", &TorrentsBatch::start);
+        cls.addFunction("stop", &TorrentsBatch::stop);
+    }
+
+    void registerLuaClassPeersView(lua_State *luaState)
+    {
+        auto qBittorrentNS = luabridge::getGlobalNamespace(luaState).beginNamespace(QBT_NAMESPACE);
+        auto cls = qBittorrentNS.beginClass<PeersView>("PeersView");
+
+        cls.addProperty("count", &PeersView::count);
+        cls.addFunction("address", &PeersView::address);
+        cls.addFunction("client", &PeersView::client);
+        cls.addFunction("country", &PeersView::country);
+        cls.addFunction("connectionType", &PeersView::connectionType);
+        cls.addFunction("flags", &PeersView::flags);
+        cls.addFunction("progress", &PeersView::progress);
+        cls.addFunction("relevance", &PeersView::relevance);
+        cls.addFunction("downloadSpeed", &PeersView::downloadSpeed);
+        cls.addFunction("uploadSpeed", &PeersView::uploadSpeed);
+        cls.addFunction("totalDownload", &PeersView::totalDownload);
+        cls.addFunction("totalUpload", &PeersView::totalUpload);
+        cls.addFunction("isSeed", &PeersView::isSeed);
+    }
+
+    void registerLuaClassPieceAvailabilityView(lua_State *luaState)
+    {
+        auto qBittorrentNS = luabridge::getGlobalNamespace(luaState).beginNamespace(QBT_NAMESPACE);
+        auto cls = qBittorrentNS.beginClass<PieceAvailabilityView>("PieceAvailabilityView");
+
+        cls.addProperty("count", &PieceAvailabilityView::count);
+        cls.addProperty("minimum", &PieceAvailabilityView::minimum);
+        cls.addFunction("availability", &PieceAvailabilityView::availability);
+    }
+
     void registerLuaClassTrackerEntry(lua_State *luaState)
     {
         using TrackerEntry = BitTorrent::TrackerEntry;
@@ -245,6 +292,10 @@ namespace
 void registerLuaClasses(lua_State *luaState)
 {
     registerLuaClassTorrent(luaState);
+    registerLuaClassTorrentsBatch(luaState);
+
+    registerLuaClassPeersView(luaState);
+    registerLuaClassPieceAvailabilityView(luaState);
 
     registerLuaClassTrackerEntry(luaState);
 
@@ -0,0 +1,155 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "luaviews.h"
+
+#include <algorithm>
+#include <utility>
+
+#include <QString>
+
+#include "base/bittorrent/peeraddress.h"
+
+PeersView::PeersView(QList<BitTorrent::PeerInfo> peers)
+    : m_peers {std::move(peers)}
+{
+}
+
+int PeersView::count() const
+{
+    return m_peers.size();
+}
+
+QString PeersView::address(const int index) const
+{
+    const BitTorrent::PeerInfo *peer = peerAt(index);
+    if (!peer)
+        return {};
+
+    return peer->useI2PSocket() ? peer->I2PAddress() : peer->address().toString();
+}
+
+QString PeersView::client(const int index) const
+{
+    const BitTorrent::PeerInfo *peer = peerAt(index);
+    return peer ? peer->client() : QString();
+}
+
+QString PeersView::country(const int index) const
+{
+    const BitTorrent::PeerInfo *peer = peerAt(index);
+    return peer ? peer->country() : QString();
+}
+
+QString PeersView::connectionType(const int index) const
+{
+    const BitTorrent::PeerInfo *peer = peerAt(index);
+    return peer ? peer->connectionType() : QString();
+}
+
+QString PeersView::flags(const int index) const
+{
+    const BitTorrent::PeerInfo *peer = peerAt(index);
+    return peer ? peer->flags() : QString();
+}
+
+qreal PeersView::progress(const int index) const
+{
+    const BitTorrent::PeerInfo *peer = peerAt(index);
+    return peer ? peer->progress() : 0;
+}
+
+qreal PeersView::relevance(const int index) const
+{
+    const BitTorrent::PeerInfo *peer = peerAt(index);
+    return peer ? peer->relevance() : 0;
+}
+
+int PeersView::downloadSpeed(const int index) const
+{
+    const BitTorrent::PeerInfo *peer = peerAt(index);
+    return peer ? peer->payloadDownSpeed() : 0;
+}
+
+int PeersView::uploadSpeed(const int index) const
+{
+    const BitTorrent::PeerInfo *peer = peerAt(index);
+    return peer ? peer->payloadUpSpeed() : 0;
+}
+
+qlonglong PeersView::totalDownload(const int index) const
+{
+    const BitTorrent::PeerInfo *peer = peerAt(index);
+    return peer ? peer->totalDownload() : 0;
+}
+
+qlonglong PeersView::totalUpload(const int index) const
+{
+    const BitTorrent::PeerInfo *peer = peerAt(index);
+    return peer ? peer->totalUpload() : 0;
+}
+
+bool PeersView::isSeed(const int index) const
+{
+    const BitTorrent::PeerInfo *peer = peerAt(index);
+    return peer && peer->isSeed();
+}
+
+const BitTorrent::PeerInfo *PeersView::peerAt(const int index) const
+{
+    if ((index < 0) || (index >= m_peers.size()))
+        return nullptr;
+
+    return &m_peers[index];
+}
+
+PieceAvailabilityView::PieceAvailabilityView(QList<int> availability)
+    : m_availability {std::move(availability)}
+{
+}
+
+int PieceAvailabilityView::count() const
+{
+    return m_availability.size();
+}
+
+int PieceAvailabilityView::availability(const int index) const
+{
+    if ((index < 0) || (index >= m_availability.size()))
+        return 0;
+
+    return m_availability[index];
+}
+
+int PieceAvailabilityView::minimum() const
+{
+    if (m_availability.isEmpty())
+        return 0;
+
+    return *std::ranges::min_element(m_availability);
+}
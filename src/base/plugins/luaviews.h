@@ -0,0 +1,80 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <QList>
+
+#include "base/bittorrent/peerinfo.h"
+
+class QString;
+
+// Read-only views over the data fetched asynchronously from torrent.
+// They share (rather than copy) the underlying C++ buffers and provide
+// indexed accessors so no per-item Lua objects need to be created.
+
+class PeersView
+{
+public:
+    PeersView() = default;
+    explicit PeersView(QList<BitTorrent::PeerInfo> peers);
+
+    int count() const;
+
+    QString address(int index) const;
+    QString client(int index) const;
+    QString country(int index) const;
+    QString connectionType(int index) const;
+    QString flags(int index) const;
+    qreal progress(int index) const;
+    qreal relevance(int index) const;
+    int downloadSpeed(int index) const;
+    int uploadSpeed(int index) const;
+    qlonglong totalDownload(int index) const;
+    qlonglong totalUpload(int index) const;
+    bool isSeed(int index) const;
+
+private:
+    const BitTorrent::PeerInfo *peerAt(int index) const;
+
+    QList<BitTorrent::PeerInfo> m_peers;
+};
+
+class PieceAvailabilityView
+{
+public:
+    PieceAvailabilityView() = default;
+    explicit PieceAvailabilityView(QList<int> availability);
+
+    int count() const;
+    int availability(int index) const;
+    int minimum() const;
+
+private:
+    QList<int> m_availability;
+};
@@ -28,23 +28,34 @@
 
 #include "plugin.h"
 
+#include <algorithm>
 #include <chrono>
+#include <utility>
 
+#include <QByteArray>
 #include <QDeadlineTimer>
+#include <QFuture>
 #include <QHash>
 #include <QScopeGuard>
 #include <QString>
 
+#include "base/bittorrent/peerinfo.h"
+#include "base/bittorrent/torrent.h"
+#include "base/logger.h"
 #include "base/path.h"
 #include "base/utils/io.h"
 #include "luaclasses.h"
 #include "luafunctions.h"
 #include "luanamespace.h"
 #include "luastack.h"
+#include "luaviews.h"
+#include "torrentsbatch.h"
 
 using namespace std::chrono_literals;
 using namespace Qt::Literals::StringLiterals;
 
+const QString PRECOMPILED_PLUGIN_EXTENSION = u".luac"_s;
+
 // This timeout is used to interrupt the execution
 // of the faulty script (e.g., if it enters an endless loop, etc.)
 const std::chrono::milliseconds LUA_TIMEOUT = 1s;
@@ -65,6 +76,12 @@ namespace
         QDeadlineTimer &deadlineTimer = LUA_DEADLINES_REGISTRY[luaState];
         deadlineTimer.setRemainingTime(LUA_TIMEOUT);
     }
+
+    qint64 heapSize(lua_State *luaState)
+    {
+        // LUA_GCCOUNT returns the size in KiB, LUA_GCCOUNTB returns the remainder in bytes
+        return (static_cast<qint64>(lua_gc(luaState, LUA_GCCOUNT, 0)) * 1024) + lua_gc(luaState, LUA_GCCOUNTB, 0);
+    }
 }
 
 nonstd::expected<std::shared_ptr<Plugin>, QString> Plugin::load(const Path &pluginPath)
@@ -91,14 +108,43 @@ nonstd::expected<std::shared_ptr<Plugin>, QString> Plugin::load(const Path &plug
 
     enableExceptions(luaState);
 
-    if (luaL_loadstring(luaState, result.value().constData()) != LUA_OK)
+    // Precompiled plugins (produced by `luac` or `luajit -b` depending on the Lua backend
+    // qBittorrent is built with) are accepted only from files with dedicated extension.
+    // NOTE: Lua doesn't verify bytecode, so malformed bytecode can crash the process or escape
+    // the restrictions of the plugin environment. Precompiled plugins must be trusted as much as
+    // native code, so the user is asked to confirm installing them (see PluginsDialog).
+    const QByteArray &pluginData = result.value();
+    const QByteArray chunkName = u"=%1"_s.arg(pluginPath.filename()).toUtf8();
+    const char *chunkMode = pluginPath.hasExtension(PRECOMPILED_PLUGIN_EXTENSION) ? "b" : "t";
+    if (luaL_loadbufferx(luaState, pluginData.constData(), static_cast<size_t>(pluginData.size())
+            , chunkName.constData(), chunkMode) != LUA_OK)
     {
         const auto message = LuaRef::fromStack(luaState, -1).cast<QString>().valueOr(u""_s);
         return nonstd::make_unexpected(message);
     }
 
+#ifdef QBT_USES_LUAJIT
+    // LuaJIT implements Lua 5.1 API so the libraries should be opened one by one.
+    // NOTE: `ffi` library must never be opened since it gives unrestricted access to the process memory.
+    const std::pair<const char *, lua_CFunction> libs[] =
+    {
+        {"", luaopen_base},
+        {LUA_STRLIBNAME, luaopen_string},
+        {LUA_TABLIBNAME, luaopen_table},
+        {LUA_MATHLIBNAME, luaopen_math},
+        {LUA_BITLIBNAME, luaopen_bit},
+        {LUA_JITLIBNAME, luaopen_jit}
+    };
+    for (const auto &[libName, openLib] : libs)
+    {
+        lua_pushcfunction(luaState, openLib);
+        lua_pushstring(luaState, libName);
+        lua_call(luaState, 1, 0);
+    }
+#else
     const int libLoadMask = LUA_GLIBK | LUA_STRLIBK | LUA_TABLIBK | LUA_MATHLIBK | LUA_UTF8LIBK | LUA_COLIBK;
     luaL_openselectedlibs(luaState, libLoadMask, 0);
+#endif
 
     {
         LuaRef baseLib = getGlobal(luaState, LUA_GNAME);
@@ -113,6 +159,12 @@ nonstd::expected<std::shared_ptr<Plugin>, QString> Plugin::load(const Path &plug
         baseLib["rawget"] = nullptr;
         baseLib["rawset"] = nullptr;
         baseLib["warn"] = nullptr;
+#ifdef QBT_USES_LUAJIT
+        baseLib["loadstring"] = nullptr;
+        baseLib["getfenv"] = nullptr;
+        baseLib["setfenv"] = nullptr;
+        baseLib["newproxy"] = nullptr;
+#endif
     }
 
     {
@@ -149,12 +201,22 @@ Plugin::Plugin(lua_State *luaState, const QString &name, const PluginVersion &ve
     , m_version {version}
 {
     m_isInvocable = luabridge::getGlobal(luaState, "invoke").isFunction();
+    m_statistics.heapSize = m_statistics.peakHeapSize = heapSize(luaState);
 
     luabridge::getGlobalNamespace(luaState).beginNamespace(QBT_NAMESPACE)
         .addFunction("debug", LuaFunctions::debug)
         .addFunction("log", LuaFunctions::log)
         .addFunction("exec", LuaFunctions::exec)
         .addFunction("sendMail", luabridge::bind_back(LuaFunctions::sendMail, this))
+        .addFunction("applyBatch", [this](const TorrentsBatch &batch) { submitTorrentsBatch(batch); })
+        .addFunction("fetchPeers", [this](const BitTorrent::Torrent *torrent, const luabridge::LuaRef &callback)
+        {
+            fetchPeers(torrent, callback);
+        })
+        .addFunction("fetchPieceAvailability", [this](const BitTorrent::Torrent *torrent, const luabridge::LuaRef &callback)
+        {
+            fetchPieceAvailability(torrent, callback);
+        })
         .addFunction("friendlySizeUnit", LuaFunctions::friendlySizeUnit1, LuaFunctions::friendlySizeUnit2)
         .addFunction("friendlySpeedUnit", LuaFunctions::friendlySpeedUnit1, LuaFunctions::friendlySpeedUnit2)
         .addFunction("friendlyDuration", LuaFunctions::friendlyDuration)
@@ -165,6 +227,9 @@ Plugin::Plugin(lua_State *luaState, const QString &name, const PluginVersion &ve
 
 Plugin::~Plugin()
 {
+    // Lua references should be released before the Lua state is closed
+    m_pendingCallbacks.clear();
+
     LUA_DEADLINES_REGISTRY.remove(m_luaState);
     lua_close(m_luaState);
 }
@@ -184,13 +249,90 @@ bool Plugin::isInvocable() const
     return m_isInvocable;
 }
 
+PluginStatistics Plugin::statistics() const
+{
+    return m_statistics;
+}
+
 void Plugin::invoke() const
 {
-    resetLuaDeadline();
-    luabridge::getGlobal(m_luaState, "invoke").call();
+    callFunction(u"invoke"_s, luabridge::getGlobal(m_luaState, "invoke"));
 }
 
 void Plugin::resetLuaDeadline() const
 {
     ::resetLuaDeadline(m_luaState);
 }
+
+void Plugin::submitTorrentsBatch(const TorrentsBatch &batch)
+{
+    if (!batch.isEmpty())
+        emit torrentsBatchSubmitted(batch);
+}
+
+void Plugin::fetchPeers(const BitTorrent::Torrent *torrent, const luabridge::LuaRef &callback)
+{
+    if (!torrent || !callback.isFunction())
+        return;
+
+    const int callbackID = registerCallback(callback);
+    torrent->fetchPeerInfo().then(this, [this, callbackID](const QList<BitTorrent::PeerInfo> &peers)
+    {
+        invokeCallback(callbackID, u"fetchPeers"_s, PeersView(peers));
+    });
+}
+
+void Plugin::fetchPieceAvailability(const BitTorrent::Torrent *torrent, const luabridge::LuaRef &callback)
+{
+    if (!torrent || !callback.isFunction())
+        return;
+
+    const int callbackID = registerCallback(callback);
+    torrent->fetchPieceAvailability().then(this, [this, callbackID](const QList<int> &availability)
+    {
+        invokeCallback(callbackID, u"fetchPieceAvailability"_s, PieceAvailabilityView(availability));
+    });
+}
+
+int Plugin::registerCallback(const luabridge::LuaRef &callback)
+{
+    const int callbackID = ++m_lastCallbackID;
+    m_pendingCallbacks.emplace(callbackID, callback);
+    return callbackID;
+}
+
+template <typename Data>
+void Plugin::invokeCallback(const int callbackID, const QString &handlerName, const Data &data)
+{
+    const auto callbackIter = m_pendingCallbacks.find(callbackID);
+    if (callbackIter == m_pendingCallbacks.end()) [[unlikely]]
+        return;
+
+    const luabridge::LuaRef callback = callbackIter->second;
+    m_pendingCallbacks.erase(callbackIter);
+
+    try
+    {
+        callFunction(handlerName, callback, data);
+    }
+    catch (const std::exception &ex)
+    {
+        LogMsg(tr("Failed to call the plugin callback. Plugin: %1. Reason: %2")
+                .arg(m_name, QString::fromStdString(ex.what())), Log::WARNING);
+    }
+}
+
+void Plugin::updateStatistics(const QString &handlerName, const std::chrono::nanoseconds elapsedTime) const
+{
+    PluginHandlerStatistics &handlerStatistics = m_statistics.handlers[handlerName];
+    ++handlerStatistics.callCount;
+    handlerStatistics.totalTime += elapsedTime;
+    handlerStatistics.peakTime = std::max(handlerStatistics.peakTime, elapsedTime);
+
+    ++m_statistics.callCount;
+    m_statistics.totalTime += elapsedTime;
+    m_statistics.peakTime = std::max(m_statistics.peakTime, elapsedTime);
+
+    m_statistics.heapSize = heapSize(m_luaState);
+    m_statistics.peakHeapSize = std::max(m_statistics.peakHeapSize, m_statistics.heapSize);
+}
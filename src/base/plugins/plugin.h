@@ -29,19 +29,29 @@
 #pragma once
 
 #include <memory>
+#include <unordered_map>
 
 #include <lua/lua.hpp>
 #include <LuaBridge/LuaBridge.h>
 
+#include <QElapsedTimer>
 #include <QObject>
+#include <QScopeGuard>
 
 #include "base/3rdparty/expected.hpp"
 #include "base/pathfwd.h"
+#include "pluginstatistics.h"
 #include "pluginversion.h"
 
 class QString;
+class TorrentsBatch;
 struct lua_State;
 
+namespace BitTorrent
+{
+    class Torrent;
+}
+
 class Plugin final : public QObject
 {
     Q_OBJECT
@@ -55,6 +65,7 @@ public:
     QString name() const;
     PluginVersion version() const;
     bool isInvocable() const;
+    PluginStatistics statistics() const;
 
     void invoke() const;
 
@@ -63,19 +74,47 @@ public:
     {
         const luabridge::LuaRef func = luabridge::getGlobal(m_luaState, funcName);
         if (func.isFunction())
-        {
-            resetLuaDeadline();
-            func.call(std::forward<Args>(args)...);
-        }
+            callFunction(QString::fromLatin1(funcName), func, std::forward<Args>(args)...);
     }
 
+signals:
+    void torrentsBatchSubmitted(const TorrentsBatch &batch);
+
 private:
     Plugin(lua_State *luaState, const QString &name, const PluginVersion &version);
 
+    template <typename... Args>
+    void callFunction(const QString &handlerName, const luabridge::LuaRef &func, Args&&... args) const
+    {
+        QElapsedTimer elapsedTimer;
+        elapsedTimer.start();
+        [[maybe_unused]] const auto scopeGuard = qScopeGuard([this, &handlerName, &elapsedTimer]
+        {
+            updateStatistics(handlerName, elapsedTimer.durationElapsed());
+        });
+
+        resetLuaDeadline();
+        func.call(std::forward<Args>(args)...);
+    }
+
+    void submitTorrentsBatch(const TorrentsBatch &batch);
+    void fetchPeers(const BitTorrent::Torrent *torrent, const luabridge::LuaRef &callback);
+    void fetchPieceAvailability(const BitTorrent::Torrent *torrent, const luabridge::LuaRef &callback);
+
+    int registerCallback(const luabridge::LuaRef &callback);
+    template <typename Data>
+    void invokeCallback(int callbackID, const QString &handlerName, const Data &data);
+
     void resetLuaDeadline() const;
+    void updateStatistics(const QString &handlerName, std::chrono::nanoseconds elapsedTime) const;
 
     lua_State *m_luaState = nullptr;
     QString m_name;
     PluginVersion m_version;
     bool m_isInvocable = false;
+    mutable PluginStatistics m_statistics;
+
+    // Lua callbacks waiting for the asynchronously fetched data
+    std::unordered_map<int, luabridge::LuaRef> m_pendingCallbacks;
+    int m_lastCallbackID = 0;
 };
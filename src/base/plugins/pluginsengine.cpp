@@ -28,11 +28,16 @@
 
 #include "pluginsengine.h"
 
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
 #include <QDir>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QMetaEnum>
 #include <QScopeGuard>
+#include <QSet>
 
 #include "base/bittorrent/session.h"
 #include "base/bittorrent/torrent.h"
@@ -47,7 +52,11 @@
 using namespace Qt::Literals::StringLiterals;
 
 const QString CONF_FILE_NAME = u"plugins.json"_s;
+// Plugin can be provided either as Lua source or as precompiled Lua bytecode, in order of priority
+const QStringList PLUGIN_FILE_EXTENSIONS {u".lua"_s, u".luac"_s};
 const QString OPTION_ENABLED = u"enabled"_s;
+// Large batches are applied in portions, so the event loop isn't blocked by them
+const qsizetype MAX_BATCH_MUTATIONS_PER_PASS = 500;
 
 namespace
 {
@@ -86,7 +95,12 @@ PluginsEngine *PluginsEngine::instance()
 
 LuaVersion PluginsEngine::luaVersion()
 {
+#ifdef QBT_USES_LUAJIT
+    // LuaJIT implements Lua 5.1 API
+    return LuaVersion((LUA_VERSION_NUM / 100), (LUA_VERSION_NUM % 100), 0);
+#else
     return LuaVersion(LUA_VERSION_MAJOR_N, LUA_VERSION_MINOR_N, LUA_VERSION_RELEASE_N);
+#endif
 }
 
 LuaBridgeVersion PluginsEngine::luaBridgeVersion()
@@ -201,6 +215,15 @@ std::optional<PluginInfo> PluginsEngine::pluginInfo(const QString &pluginID) con
     return getPluginInfo(*pluginIter);
 }
 
+std::optional<PluginStatistics> PluginsEngine::pluginStatistics(const QString &pluginID) const
+{
+    const auto pluginIter = m_plugins.constFind(pluginID);
+    if (pluginIter == m_plugins.constEnd())
+        return std::nullopt;
+
+    return pluginIter->plugin->statistics();
+}
+
 bool PluginsEngine::installPlugin(const Path &pluginPath)
 {
     if (!pluginPath.isAbsolute())
@@ -282,9 +305,20 @@ void PluginsEngine::installPluginImpl()
         }
     }
 
-    if (!Utils::Fs::removeFile(targetPluginPath))
+    // Plugin can be updated using a file of another type (e.g. source file replaced with precompiled one)
+    const Path existingPluginPath = std::invoke([pluginID]() -> Path
     {
-        const QString message = tr("Couldn't remove file '%1'.").arg(targetPluginPath.toString());
+        for (const QString &extension : PLUGIN_FILE_EXTENSIONS)
+        {
+            if (!Utils::Fs::removeFile(pluginsPath() / Path(pluginID + extension)))
+                return pluginsPath() / Path(pluginID + extension);
+        }
+
+        return {};
+    });
+    if (!existingPluginPath.isEmpty())
+    {
+        const QString message = tr("Couldn't remove file '%1'.").arg(existingPluginPath.toString());
 
         if (isExistingPlugin)
         {
@@ -376,7 +410,17 @@ void PluginsEngine::uninstallPluginImpl()
         return;
 
     const QString pluginID = m_pluginsToUninstall.dequeue();
-    if (auto result = Utils::Fs::removeFile(pluginsPath() / Path(pluginID + u".lua")))
+    const auto result = std::invoke([pluginID]() -> nonstd::expected<void, QString>
+    {
+        for (const QString &extension : PLUGIN_FILE_EXTENSIONS)
+        {
+            if (auto removeResult = Utils::Fs::removeFile(pluginsPath() / Path(pluginID + extension)); !removeResult)
+                return removeResult;
+        }
+
+        return {};
+    });
+    if (result)
     {
         const PluginEntry pluginEntry = m_plugins.take(pluginID);
         LogMsg(tr("Uninstalled plugin. ID: %1.").arg(pluginID));
@@ -396,18 +440,31 @@ void PluginsEngine::uninstallPluginImpl()
 void PluginsEngine::loadPlugins()
 {
     const QDir pluginsDir {pluginsPath().data()};
-    for (const QString &file : pluginsDir.entryList({u"*.lua"_s}))
+    // The files are loaded in order of extension priority so that the plugin source
+    // is preferred over precompiled plugin having the same ID (e.g. if both are put manually)
+    for (const QString &extension : PLUGIN_FILE_EXTENSIONS)
     {
-        if (auto result = loadPlugin(Path(pluginsDir.absoluteFilePath(file))))
-        {
-            PluginEntry &pluginEntry = result.value();
-            const QString pluginID = pluginEntry.id;
-            m_plugins.insert(pluginID, std::move(pluginEntry));
-            LogMsg(tr("Loaded plugin. ID: %1.").arg(pluginID));
-        }
-        else
+        for (const QString &file : pluginsDir.entryList({u'*' + extension}, QDir::Files, QDir::Name))
         {
-            LogMsg(tr("Couldn't load plugin. File: %1. Reason: %2").arg(file, result.error()), Log::WARNING);
+            const Path pluginPath {pluginsDir.absoluteFilePath(file)};
+            if (const QString pluginID = pluginPath.removedExtension().filename(); m_plugins.contains(pluginID))
+            {
+                LogMsg(tr("Skipped plugin file since plugin with the same ID is already loaded. File: %1. ID: %2.")
+                        .arg(file, pluginID), Log::WARNING);
+                continue;
+            }
+
+            if (auto result = loadPlugin(pluginPath))
+            {
+                PluginEntry &pluginEntry = result.value();
+                const QString pluginID = pluginEntry.id;
+                m_plugins.insert(pluginID, std::move(pluginEntry));
+                LogMsg(tr("Loaded plugin. ID: %1.").arg(pluginID));
+            }
+            else
+            {
+                LogMsg(tr("Couldn't load plugin. File: %1. Reason: %2").arg(file, result.error()), Log::WARNING);
+            }
         }
     }
 
@@ -465,6 +522,18 @@ void PluginsEngine::connectEventHandler(Signal &&signal, const char *eventHandle
 template <typename... Args>
 void PluginsEngine::callEventHandlers(const char *eventHandlerName, Args&&... args)
 {
+    // Events of the torrents mutated by the batch are delivered to plugins
+    // as single "onTorrentsBatchApplied" call once the batch is applied
+    if constexpr (sizeof...(Args) > 0)
+    {
+        using FirstArg = std::remove_cvref_t<std::tuple_element_t<0, std::tuple<Args...>>>;
+        if constexpr (std::is_convertible_v<FirstArg, const BitTorrent::Torrent *>)
+        {
+            if (!m_batchTorrents.isEmpty() && m_batchTorrents.contains(std::get<0>(std::forward_as_tuple(args...))))
+                return;
+        }
+    }
+
     for (const PluginEntry &pluginEntry : asConst(m_plugins))
     {
         if (!pluginEntry.enabled)
@@ -482,6 +551,61 @@ void PluginsEngine::callEventHandlers(const char *eventHandlerName, Args&&... ar
     }
 }
 
+void PluginsEngine::enqueueTorrentsBatch(const TorrentsBatch &batch)
+{
+    m_torrentsBatches.enqueue(batch);
+    if (m_torrentsBatches.size() == 1)
+        QMetaObject::invokeMethod(this, &PluginsEngine::applyTorrentsBatches, Qt::QueuedConnection);
+}
+
+void PluginsEngine::applyTorrentsBatches()
+{
+    const BitTorrent::Session *session = BitTorrent::Session::instance();
+
+    {
+        [[maybe_unused]] const auto scopeGuard = qScopeGuard([this] { m_batchTorrents.clear(); });
+
+        qsizetype mutationsCount = 0;
+        while (!m_torrentsBatches.isEmpty() && (mutationsCount < MAX_BATCH_MUTATIONS_PER_PASS))
+        {
+            TorrentsBatch &batch = m_torrentsBatches.head();
+            m_batchTorrents.clear();
+            for (const BitTorrent::TorrentID &torrentID : asConst(batch.torrentIDs()))
+            {
+                if (const BitTorrent::Torrent *torrent = session->getTorrent(torrentID))
+                    m_batchTorrents.insert(torrent);
+            }
+
+            const qsizetype pendingCount = batch.pendingCount();
+            const QList<BitTorrent::Torrent *> torrents = batch.apply(session, (MAX_BATCH_MUTATIONS_PER_PASS - mutationsCount));
+            for (const BitTorrent::Torrent *torrent : torrents)
+                m_batchUpdatedTorrentIDs.insert(torrent->id());
+
+            mutationsCount += (pendingCount - batch.pendingCount());
+            if (batch.pendingCount() == 0)
+                m_torrentsBatches.dequeue();
+        }
+    }
+
+    if (!m_torrentsBatches.isEmpty())
+    {
+        QMetaObject::invokeMethod(this, &PluginsEngine::applyTorrentsBatches, Qt::QueuedConnection);
+        return;
+    }
+
+    // torrents removed while the batches were applied aren't reported
+    QList<BitTorrent::Torrent *> updatedTorrents;
+    updatedTorrents.reserve(m_batchUpdatedTorrentIDs.size());
+    for (const BitTorrent::TorrentID &torrentID : asConst(std::exchange(m_batchUpdatedTorrentIDs, {})))
+    {
+        if (BitTorrent::Torrent *torrent = session->getTorrent(torrentID))
+            updatedTorrents.append(torrent);
+    }
+
+    if (!updatedTorrents.isEmpty())
+        callEventHandlers("onTorrentsBatchApplied", updatedTorrents);
+}
+
 void PluginsEngine::setPluginEnabled(const QString &pluginID, const bool enabled)
 {
     Q_ASSERT(m_plugins.contains(pluginID));
@@ -519,6 +643,16 @@ void PluginsEngine::invokePlugin(const QString &pluginID)
     }
 }
 
+void PluginsEngine::deliverEvent(const char *eventHandlerName, BitTorrent::Torrent *torrent)
+{
+    callEventHandlers(eventHandlerName, torrent);
+}
+
+void PluginsEngine::deliverEvent(const char *eventHandlerName, const QList<BitTorrent::Torrent *> &torrents)
+{
+    callEventHandlers(eventHandlerName, torrents);
+}
+
 nonstd::expected<PluginsEngine::PluginEntry, QString> PluginsEngine::loadPlugin(const Path &path)
 {
     auto loadResult = Plugin::load(path);
@@ -530,5 +664,7 @@ nonstd::expected<PluginsEngine::PluginEntry, QString> PluginsEngine::loadPlugin(
         .id = path.removedExtension().filename(),
     };
 
+    connect(pluginEntry.plugin.get(), &Plugin::torrentsBatchSubmitted, this, &PluginsEngine::enqueueTorrentsBatch);
+
     return pluginEntry;
 }
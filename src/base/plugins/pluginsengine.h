@@ -34,11 +34,14 @@
 #include <QHash>
 #include <QObject>
 #include <QQueue>
+#include <QSet>
 
 #include "base/3rdparty/expected.hpp"
 #include "base/pathfwd.h"
 #include "base/utils/version.h"
+#include "pluginstatistics.h"
 #include "pluginversion.h"
+#include "torrentsbatch.h"
 
 using LuaVersion = Utils::Version<3>;
 using LuaBridgeVersion = Utils::Version<2>;
@@ -64,6 +67,9 @@ class PluginsEngine final : public QObject
     Q_OBJECT
     Q_DISABLE_COPY_MOVE(PluginsEngine)
 
+    // it delivers events to plugins directly
+    friend class BenchPlugins;
+
 public:
     static void initInstance();
     static void freeInstance();
@@ -74,6 +80,7 @@ public:
 
     QHash<QString, PluginInfo> allPlugins() const;
     std::optional<PluginInfo> pluginInfo(const QString &pluginID) const;
+    std::optional<PluginStatistics> pluginStatistics(const QString &pluginID) const;
 
     bool installPlugin(const Path &pluginPath);
     bool uninstallPlugin(const QString &pluginID);
@@ -123,9 +130,22 @@ private:
     template <typename... Args>
     void callEventHandlers(const char *eventHandlerName, Args&&... args);
 
+    // Delivers the event to the enabled plugins in the same way as the events emitted by session,
+    // so the events that don't come from session can be delivered as well (e.g. to benchmark plugins)
+    void deliverEvent(const char *eventHandlerName, BitTorrent::Torrent *torrent);
+    void deliverEvent(const char *eventHandlerName, const QList<BitTorrent::Torrent *> &torrents);
+
+    void enqueueTorrentsBatch(const TorrentsBatch &batch);
+    void applyTorrentsBatches();
+
     QHash<QString, PluginEntry> m_plugins;
     QQueue<Path> m_pluginsToInstall;
     QQueue<QString> m_pluginsToUninstall;
+    QQueue<TorrentsBatch> m_torrentsBatches;
+    // torrents mutated by the batch that is being applied
+    QSet<const BitTorrent::Torrent *> m_batchTorrents;
+    // torrents affected by the batches applied so far, they are reported once the queue is empty
+    QSet<BitTorrent::TorrentID> m_batchUpdatedTorrentIDs;
     mutable bool m_configIsDirty = false;
 
     inline static PluginsEngine *m_instance = nullptr;
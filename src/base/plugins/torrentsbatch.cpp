@@ -0,0 +1,151 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "torrentsbatch.h"
+
+#include <algorithm>
+
+#include <QSet>
+#include <QString>
+
+#include "base/bittorrent/session.h"
+#include "base/bittorrent/torrent.h"
+#include "base/path.h"
+#include "base/tag.h"
+
+void TorrentsBatch::setCategory(const BitTorrent::Torrent *torrent, const QString &category)
+{
+    addMutation(torrent, [category](BitTorrent::Torrent *torrent)
+    {
+        torrent->setCategory(category);
+    });
+}
+
+void TorrentsBatch::addTag(const BitTorrent::Torrent *torrent, const QString &tag)
+{
+    addMutation(torrent, [tag = Tag(tag)](BitTorrent::Torrent *torrent)
+    {
+        torrent->addTag(tag);
+    });
+}
+
+void TorrentsBatch::removeTag(const BitTorrent::Torrent *torrent, const QString &tag)
+{
+    addMutation(torrent, [tag = Tag(tag)](BitTorrent::Torrent *torrent)
+    {
+        torrent->removeTag(tag);
+    });
+}
+
+void TorrentsBatch::setSavePath(const BitTorrent::Torrent *torrent, const Path &savePath)
+{
+    addMutation(torrent, [savePath](BitTorrent::Torrent *torrent)
+    {
+        torrent->setSavePath(savePath);
+    });
+}
+
+void TorrentsBatch::start(const BitTorrent::Torrent *torrent)
+{
+    addMutation(torrent, [](BitTorrent::Torrent *torrent)
+    {
+        torrent->start();
+    });
+}
+
+void TorrentsBatch::stop(const BitTorrent::Torrent *torrent)
+{
+    addMutation(torrent, [](BitTorrent::Torrent *torrent)
+    {
+        torrent->stop();
+    });
+}
+
+qsizetype TorrentsBatch::size() const
+{
+    return m_mutations.size();
+}
+
+bool TorrentsBatch::isEmpty() const
+{
+    return m_mutations.isEmpty();
+}
+
+QList<BitTorrent::TorrentID> TorrentsBatch::torrentIDs() const
+{
+    QList<BitTorrent::TorrentID> torrentIDs;
+    QSet<BitTorrent::TorrentID> processedTorrentIDs;
+    for (const auto &[torrentID, mutation] : m_mutations)
+    {
+        if (!processedTorrentIDs.contains(torrentID))
+        {
+            processedTorrentIDs.insert(torrentID);
+            torrentIDs.append(torrentID);
+        }
+    }
+
+    return torrentIDs;
+}
+
+qsizetype TorrentsBatch::pendingCount() const
+{
+    return (m_mutations.size() - m_appliedCount);
+}
+
+QList<BitTorrent::Torrent *> TorrentsBatch::apply(const BitTorrent::Session *session, const qsizetype maxCount)
+{
+    QList<BitTorrent::Torrent *> torrents;
+    QSet<BitTorrent::Torrent *> processedTorrents;
+
+    const qsizetype endIndex = m_appliedCount + std::min(maxCount, pendingCount());
+    for (; m_appliedCount < endIndex; ++m_appliedCount)
+    {
+        const auto &[torrentID, mutation] = m_mutations.at(m_appliedCount);
+        BitTorrent::Torrent *torrent = session->getTorrent(torrentID);
+        if (!torrent)
+            continue;
+
+        mutation(torrent);
+
+        if (!processedTorrents.contains(torrent))
+        {
+            processedTorrents.insert(torrent);
+            torrents.append(torrent);
+        }
+    }
+
+    return torrents;
+}
+
+void TorrentsBatch::addMutation(const BitTorrent::Torrent *torrent, Mutation mutation)
+{
+    if (!torrent) [[unlikely]]
+        return;
+
+    m_mutations.emplaceBack(torrent->id(), std::move(mutation));
+}
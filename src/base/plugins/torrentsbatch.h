@@ -0,0 +1,77 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <functional>
+#include <utility>
+
+#include <QList>
+
+#include "base/bittorrent/infohash.h"
+#include "base/pathfwd.h"
+
+class QString;
+
+namespace BitTorrent
+{
+    class Session;
+    class Torrent;
+}
+
+// Collects torrent mutations requested by plugin so that they
+// can be applied all at once instead of one by one.
+class TorrentsBatch
+{
+public:
+    void setCategory(const BitTorrent::Torrent *torrent, const QString &category);
+    void addTag(const BitTorrent::Torrent *torrent, const QString &tag);
+    void removeTag(const BitTorrent::Torrent *torrent, const QString &tag);
+    void setSavePath(const BitTorrent::Torrent *torrent, const Path &savePath);
+    void start(const BitTorrent::Torrent *torrent);
+    void stop(const BitTorrent::Torrent *torrent);
+
+    qsizetype size() const;
+    bool isEmpty() const;
+    QList<BitTorrent::TorrentID> torrentIDs() const;
+
+    // Number of mutations that aren't applied yet
+    qsizetype pendingCount() const;
+
+    // Applies up to maxCount of the pending mutations and returns the torrents affected by them
+    // (torrents removed from the session since the mutation was queued are skipped)
+    QList<BitTorrent::Torrent *> apply(const BitTorrent::Session *session, qsizetype maxCount);
+
+private:
+    using Mutation = std::function<void (BitTorrent::Torrent *torrent)>;
+
+    void addMutation(const BitTorrent::Torrent *torrent, Mutation mutation);
+
+    QList<std::pair<BitTorrent::TorrentID, Mutation>> m_mutations;
+    qsizetype m_appliedCount = 0;
+};
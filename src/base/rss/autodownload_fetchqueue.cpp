@@ -0,0 +1,180 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "autodownload_fetchqueue.h"
+
+#include <algorithm>
+
+#include <QUrl>
+
+#include "base/algorithm.h"
+
+RSS::Private::FetchQueue::FetchQueue(const int maxAttempts, const std::chrono::seconds retryDelay, const int maxFetchesPerHost)
+    : m_maxAttempts {maxAttempts}
+    , m_retryDelay {retryDelay}
+    , m_maxFetchesPerHost {maxFetchesPerHost}
+{
+}
+
+std::chrono::seconds RSS::Private::FetchQueue::fetchDelay() const
+{
+    return m_fetchDelay;
+}
+
+void RSS::Private::FetchQueue::setFetchDelay(const std::chrono::seconds delay)
+{
+    m_fetchDelay = delay;
+}
+
+bool RSS::Private::FetchQueue::contains(const QString &torrentURL) const
+{
+    return m_jobs.contains(torrentURL);
+}
+
+const RSS::Private::WaitingJob *RSS::Private::FetchQueue::job(const QString &torrentURL) const
+{
+    const auto it = m_jobs.constFind(torrentURL);
+    return (it != m_jobs.cend()) ? &it.value() : nullptr;
+}
+
+bool RSS::Private::FetchQueue::add(const QString &torrentURL, const ProcessingJob &job, const BitTorrent::AddTorrentParams &addTorrentParams)
+{
+    if (m_jobs.contains(torrentURL))
+        return false;
+
+    m_jobs.insert(torrentURL, {.job = job, .addTorrentParams = addTorrentParams
+            , .serviceID = Net::ServiceID::fromURL(QUrl(torrentURL))});
+    m_queue.append(torrentURL);
+    return true;
+}
+
+std::optional<RSS::Private::WaitingJob> RSS::Private::FetchQueue::take(const QString &torrentURL)
+{
+    const auto it = m_jobs.find(torrentURL);
+    if (it == m_jobs.end())
+        return std::nullopt;
+
+    // the same torrent can be added from elsewhere while it is queued
+    if (it->status == WaitingJob::Status::Queued)
+        m_queue.removeOne(torrentURL);
+    else
+        releaseFetchSlot(it->serviceID);
+
+    const WaitingJob waitingJob = it.value();
+    m_jobs.erase(it);
+    return waitingJob;
+}
+
+bool RSS::Private::FetchQueue::retry(const QString &torrentURL, const TimePoint currentTime)
+{
+    const auto it = m_jobs.find(torrentURL);
+    if ((it == m_jobs.end()) || (it->status != WaitingJob::Status::Fetching))
+        return false;
+
+    releaseFetchSlot(it->serviceID);
+    if (it->attempts >= m_maxAttempts)
+    {
+        m_jobs.erase(it);
+        return false;
+    }
+
+    it->status = WaitingJob::Status::Queued;
+    it->nextAttemptTime = currentTime + (m_retryDelay * (1 << (it->attempts - 1)));
+    m_queue.append(torrentURL);
+    return true;
+}
+
+QList<QString> RSS::Private::FetchQueue::takeReady(const TimePoint currentTime)
+{
+    QList<QString> torrentURLs;
+    for (auto it = m_queue.begin(); it != m_queue.end();)
+    {
+        WaitingJob &waitingJob = m_jobs[*it];
+        if (const std::optional<TimePoint> time = fetchTime(waitingJob); !time || (*time > currentTime))
+        {
+            ++it;
+            continue;
+        }
+
+        waitingJob.status = WaitingJob::Status::Fetching;
+        ++waitingJob.attempts;
+        ++m_activeFetchesCounts[waitingJob.serviceID];
+        m_lastFetchTimes[waitingJob.serviceID] = currentTime;
+        torrentURLs.append(*it);
+        it = m_queue.erase(it);
+    }
+
+    // hosts that were requested long enough ago don't delay the next requests anymore
+    Algorithm::removeIf(m_lastFetchTimes, [expirationTime = (currentTime - m_fetchDelay)](const Net::ServiceID &, const TimePoint &lastFetchTime)
+    {
+        return (lastFetchTime < expirationTime);
+    });
+
+    return torrentURLs;
+}
+
+std::optional<RSS::Private::FetchQueue::TimePoint> RSS::Private::FetchQueue::nextAttemptTime() const
+{
+    std::optional<TimePoint> nextTime;
+    for (const QString &torrentURL : m_queue)
+    {
+        if (const std::optional<TimePoint> time = fetchTime(*m_jobs.constFind(torrentURL)))
+            nextTime = nextTime ? std::min(*nextTime, *time) : *time;
+    }
+    return nextTime;
+}
+
+void RSS::Private::FetchQueue::replaceFeedURL(const QString &oldURL, const QString &newURL)
+{
+    for (WaitingJob &waitingJob : m_jobs)
+    {
+        if (waitingJob.job.feedURL == oldURL)
+            waitingJob.job.feedURL = newURL;
+    }
+}
+
+void RSS::Private::FetchQueue::releaseFetchSlot(const Net::ServiceID &serviceID)
+{
+    const auto it = m_activeFetchesCounts.find(serviceID);
+    if (it == m_activeFetchesCounts.end())
+        return;
+
+    if (--it.value() <= 0)
+        m_activeFetchesCounts.erase(it);
+}
+
+std::optional<RSS::Private::FetchQueue::TimePoint> RSS::Private::FetchQueue::fetchTime(const WaitingJob &waitingJob) const
+{
+    if (m_activeFetchesCounts.value(waitingJob.serviceID) >= m_maxFetchesPerHost)
+        return std::nullopt;
+
+    TimePoint time = waitingJob.nextAttemptTime;
+    if (const auto lastFetchTimeIt = m_lastFetchTimes.constFind(waitingJob.serviceID); lastFetchTimeIt != m_lastFetchTimes.cend())
+        time = std::max(time, (lastFetchTimeIt.value() + m_fetchDelay));
+    return time;
+}
@@ -0,0 +1,108 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <optional>
+
+#include <QHash>
+#include <QList>
+#include <QString>
+
+#include "base/bittorrent/addtorrentparams.h"
+#include "base/net/downloadmanager.h"
+#include "autodownload_matcher.h"
+
+namespace RSS::Private
+{
+    // Accepted article whose torrent is being fetched
+    struct WaitingJob
+    {
+        enum class Status
+        {
+            Queued,
+            Fetching
+        };
+
+        ProcessingJob job;
+        BitTorrent::AddTorrentParams addTorrentParams;
+        Net::ServiceID serviceID;
+        Status status = Status::Queued;
+        int attempts = 0;
+        std::chrono::steady_clock::time_point nextAttemptTime;
+    };
+
+    // Torrents of the accepted articles, keyed by torrent URL.
+    // Torrents are often hosted by trackers rather than by the feed hosts, so requests
+    // to the same host are limited in number and spaced by the fetch delay here.
+    class FetchQueue
+    {
+    public:
+        using TimePoint = std::chrono::steady_clock::time_point;
+
+        // retry delay is doubled on each subsequent attempt
+        FetchQueue(int maxAttempts, std::chrono::seconds retryDelay, int maxFetchesPerHost);
+
+        std::chrono::seconds fetchDelay() const;
+        void setFetchDelay(std::chrono::seconds delay);
+
+        bool contains(const QString &torrentURL) const;
+        // Returned pointer is valid until the queue is modified
+        const WaitingJob *job(const QString &torrentURL) const;
+
+        // Returns false if the torrent is already waiting
+        bool add(const QString &torrentURL, const ProcessingJob &job, const BitTorrent::AddTorrentParams &addTorrentParams);
+        // Removes the job once its torrent is added, no matter whether it was fetched by this queue
+        std::optional<WaitingJob> take(const QString &torrentURL);
+        // Queues the failed job for the next attempt, returns false (and removes the job) if all attempts are used
+        bool retry(const QString &torrentURL, TimePoint currentTime);
+
+        // Marks the jobs that are due as being fetched and returns their torrent URLs
+        QList<QString> takeReady(TimePoint currentTime);
+        // Jobs blocked by the number of active fetches from their host aren't taken into account,
+        // they are ready once any of these fetches is finished (see take() and retry())
+        std::optional<TimePoint> nextAttemptTime() const;
+
+        void replaceFeedURL(const QString &oldURL, const QString &newURL);
+
+    private:
+        void releaseFetchSlot(const Net::ServiceID &serviceID);
+        std::optional<TimePoint> fetchTime(const WaitingJob &waitingJob) const;
+
+        int m_maxAttempts = 0;
+        std::chrono::seconds m_retryDelay;
+        int m_maxFetchesPerHost = 0;
+        std::chrono::seconds m_fetchDelay {0};
+        QHash<QString, WaitingJob> m_jobs;
+        // torrent URLs of the queued jobs in order of addition
+        QList<QString> m_queue;
+        QHash<Net::ServiceID, int> m_activeFetchesCounts;
+        QHash<Net::ServiceID, TimePoint> m_lastFetchTimes;
+    };
+}
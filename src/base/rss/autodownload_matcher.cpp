@@ -0,0 +1,109 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "autodownload_matcher.h"
+
+#include <QElapsedTimer>
+
+#include "base/global.h"
+#include "rss_article.h"
+
+const int MATCHINGRESULTLIST_TYPEID = qRegisterMetaType<QList<RSS::Private::MatchingResult>>();
+
+void RSS::Private::AutoDownloadMatcher::setRules(const QList<AutoDownloadRule> &rules, const qint64 rulesRevision)
+{
+    m_rules.clear();
+    m_rules.reserve(rules.size());
+    for (const AutoDownloadRule &rule : rules)
+        m_rules.append(rule.detached());
+
+    m_rulesIndex = AutoDownloadRuleIndex(m_rules);
+    m_rulesRevision = rulesRevision;
+}
+
+void RSS::Private::AutoDownloadMatcher::process(const QList<ProcessingJob> &jobs, const SmartFilterSettings &smartFilterSettings
+        , const int maxPreviouslyMatchedEpisodes)
+{
+    QList<MatchingResult> results;
+    for (const ProcessingJob &job : jobs)
+    {
+        const QString articleTitle = job.articleData.value(Article::KeyTitle).toString();
+        for (const qsizetype ruleIndex : asConst(m_rulesIndex.candidates(job.feedURL, articleTitle)))
+        {
+            // Accepting the article updates the state of the rule snapshot so that
+            // the subsequent jobs are matched against it (e.g. to not download the same episode twice)
+            AutoDownloadRule &rule = m_rules[ruleIndex];
+            if (!rule.accepts(job.articleData, smartFilterSettings))
+                continue;
+
+            // the snapshot is pruned the same way as the rule owned by AutoDownloader, so it doesn't grow unbounded
+            rule.limitPreviouslyMatchedEpisodes(maxPreviouslyMatchedEpisodes);
+
+            results.append({.job = job, .ruleName = rule.name()
+                    , .lastMatch = rule.lastMatch(), .previouslyMatchedEpisodes = rule.previouslyMatchedEpisodes()});
+            break;
+        }
+    }
+
+    emit finished(results, m_rulesRevision);
+}
+
+QList<RSS::RuleDryRunResult> RSS::Private::AutoDownloadMatcher::dryRun(const QList<AutoDownloadRule> &rules
+        , const SmartFilterSettings &smartFilterSettings, const QHash<QString, QList<QVariantHash>> &articlesByFeed)
+{
+    QList<RuleDryRunResult> results;
+    results.reserve(rules.size());
+    QElapsedTimer timer;
+    for (const AutoDownloadRule &rule : rules)
+    {
+        RuleDryRunResult &result = results.emplaceBack();
+        result.ruleName = rule.name();
+
+        qint64 evaluationTime = 0;
+        for (const QString &feedURL : asConst(rule.feedURLs()))
+        {
+            const QList<QVariantHash> articles = articlesByFeed.value(feedURL);
+            QStringList matchedArticles;
+            timer.start();
+            for (const QVariantHash &articleData : articles)
+            {
+                if (rule.matches(articleData, smartFilterSettings))
+                    matchedArticles.append(articleData.value(Article::KeyTitle).toString());
+            }
+            evaluationTime += timer.nsecsElapsed();
+
+            result.evaluatedArticlesCount += articles.size();
+            if (!matchedArticles.isEmpty())
+                result.matchedArticles.insert(feedURL, matchedArticles);
+        }
+
+        result.evaluationTime = evaluationTime / 1000;
+    }
+
+    return results;
+}
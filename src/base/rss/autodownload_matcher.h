@@ -0,0 +1,87 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <QDateTime>
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QVariantHash>
+
+#include "rss_autodownloader.h"
+#include "rss_autodownloadrule.h"
+#include "rss_autodownloadruleindex.h"
+
+namespace RSS::Private
+{
+    struct ProcessingJob
+    {
+        QString feedURL;
+        QVariantHash articleData;
+    };
+
+    struct MatchingResult
+    {
+        ProcessingJob job;
+        QString ruleName;
+        // updated state of the rule that accepted the article
+        QDateTime lastMatch;
+        QStringList previouslyMatchedEpisodes;
+    };
+
+    // Evaluates auto downloading rules in the RSS working thread.
+    // It operates on its own snapshot of the rules so it never touches the rules owned by AutoDownloader.
+    class AutoDownloadMatcher final : public QObject
+    {
+        Q_OBJECT
+        Q_DISABLE_COPY_MOVE(AutoDownloadMatcher)
+
+    public:
+        using QObject::QObject;
+
+        void setRules(const QList<AutoDownloadRule> &rules, qint64 rulesRevision);
+        void process(const QList<ProcessingJob> &jobs, const SmartFilterSettings &smartFilterSettings, int maxPreviouslyMatchedEpisodes);
+        // It doesn't depend on the state of the matcher so it can be called from any thread
+        static QList<RuleDryRunResult> dryRun(const QList<AutoDownloadRule> &rules, const SmartFilterSettings &smartFilterSettings
+                , const QHash<QString, QList<QVariantHash>> &articlesByFeed);
+
+    signals:
+        // It is emitted once per processed list of jobs, even if no article is accepted
+        void finished(const QList<RSS::Private::MatchingResult> &results, qint64 rulesRevision);
+
+    private:
+        QList<AutoDownloadRule> m_rules;
+        AutoDownloadRuleIndex m_rulesIndex;
+        qint64 m_rulesRevision = 0;
+    };
+}
+
+Q_DECLARE_METATYPE(RSS::Private::MatchingResult)
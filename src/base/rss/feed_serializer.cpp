@@ -31,20 +31,221 @@
 
 #include "feed_serializer.h"
 
+#include <algorithm>
+#include <chrono>
+
+#include <QDataStream>
+#include <QFile>
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QList>
+#include <QMutexLocker>
+#include <QScopeGuard>
+#include <QStringList>
+#include <QTimer>
 
+#include "base/global.h"
 #include "base/logger.h"
-#include "base/path.h"
+#include "base/utils/fs.h"
 #include "base/utils/io.h"
 #include "rss_article.h"
 
 const int ARTICLEDATALIST_TYPEID = qRegisterMetaType<QList<QVariantHash>>();
 
-void RSS::Private::FeedSerializer::load(const Path &dataFileName, const QString &url)
+using namespace std::chrono_literals;
+
+namespace
+{
+    const quint32 DATA_FILE_MAGIC = 0x51425241; // "QBRA"
+    const quint32 DATA_FILE_VERSION = 1;
+    const QDataStream::Version DATA_STREAM_VERSION = QDataStream::Qt_6_0;
+    // Compaction is performed when the log contains more outdated records than
+    // both this value and the number of actual articles
+    const qsizetype MIN_OUTDATED_RECORDS_TO_COMPACT = 100;
+    // Records that failed to be written are retried after this delay unless other records are stored earlier
+    const std::chrono::seconds STORE_RETRY_DELAY = 30s;
+
+    struct ParsedLog
+    {
+        QList<QVariantHash> articles;
+        QHash<QString, qint64> articleOffsets;
+        qsizetype recordsCount = 0;
+        bool isValid = false;
+        bool isComplete = false;
+    };
+
+    QByteArray serializeHeader()
+    {
+        QByteArray data;
+        QDataStream out {&data, QIODevice::WriteOnly};
+        out.setVersion(DATA_STREAM_VERSION);
+        out << DATA_FILE_MAGIC << DATA_FILE_VERSION;
+        return data;
+    }
+
+    QByteArray serializeRecord(const RSS::Private::ArticleRecord &record)
+    {
+        QByteArray payload;
+        QDataStream payloadOut {&payload, QIODevice::WriteOnly};
+        payloadOut.setVersion(DATA_STREAM_VERSION);
+        payloadOut << static_cast<quint8>(record.type);
+        if (record.type == RSS::Private::ArticleRecord::Type::Add)
+            payloadOut << record.articleData;
+        else
+            payloadOut << record.articleID;
+
+        // Each record is prefixed with its size so incomplete records can be detected
+        QByteArray data;
+        QDataStream out {&data, QIODevice::WriteOnly};
+        out.setVersion(DATA_STREAM_VERSION);
+        out << static_cast<quint32>(payload.size());
+        out.writeRawData(payload.constData(), payload.size());
+        return data;
+    }
+
+    // Reads the record located at the current position of the stream.
+    // Returns false if there is no complete record.
+    bool readRecord(QDataStream &in, RSS::Private::ArticleRecord &record, bool *isValid)
+    {
+        quint32 recordSize = 0;
+        in >> recordSize;
+        if ((in.status() != QDataStream::Ok) || ((in.device()->size() - in.device()->pos()) < recordSize))
+            return false;
+
+        QByteArray payload(static_cast<qsizetype>(recordSize), Qt::Uninitialized);
+        in.readRawData(payload.data(), payload.size());
+
+        QDataStream payloadIn {payload};
+        payloadIn.setVersion(DATA_STREAM_VERSION);
+        quint8 recordType = 0;
+        payloadIn >> recordType;
+        record.type = static_cast<RSS::Private::ArticleRecord::Type>(recordType);
+        switch (record.type)
+        {
+        case RSS::Private::ArticleRecord::Type::Add:
+            payloadIn >> record.articleData;
+            record.articleID = record.articleData.value(RSS::Article::KeyId).toString();
+            break;
+        case RSS::Private::ArticleRecord::Type::MarkAsRead:
+        case RSS::Private::ArticleRecord::Type::Remove:
+            payloadIn >> record.articleID;
+            break;
+        default:
+            *isValid = false;
+            return true;
+        }
+
+        *isValid = ((payloadIn.status() == QDataStream::Ok) && !record.articleID.isEmpty());
+        return true;
+    }
+
+    ParsedLog parseLog(const QByteArray &data, const QString &url)
+    {
+        ParsedLog result;
+
+        QDataStream in {data};
+        in.setVersion(DATA_STREAM_VERSION);
+
+        quint32 magic = 0;
+        quint32 version = 0;
+        in >> magic >> version;
+        if ((in.status() != QDataStream::Ok) || (magic != DATA_FILE_MAGIC) || (version != DATA_FILE_VERSION))
+            return result;
+
+        result.isValid = true;
+
+        // Removed articles leave empty items which are dropped at the end
+        QHash<QString, qsizetype> articleIndexes;
+        while (!in.atEnd())
+        {
+            const qint64 offset = in.device()->pos();
+            RSS::Private::ArticleRecord record;
+            bool isValidRecord = false;
+            if (!readRecord(in, record, &isValidRecord))
+                break;
+
+            ++result.recordsCount;
+            if (!isValidRecord)
+            {
+                LogMsg(RSS::Private::FeedSerializer::tr("Couldn't load RSS article '%1#%2'. Invalid data format.")
+                       .arg(url, QString::number(result.recordsCount)), Log::WARNING);
+                continue;
+            }
+
+            switch (record.type)
+            {
+            case RSS::Private::ArticleRecord::Type::Add:
+                if (!articleIndexes.contains(record.articleID))
+                {
+                    articleIndexes.insert(record.articleID, result.articles.size());
+                    result.articles.append(record.articleData);
+                    result.articleOffsets.insert(record.articleID, offset);
+                }
+                break;
+            case RSS::Private::ArticleRecord::Type::MarkAsRead:
+                if (const auto it = articleIndexes.constFind(record.articleID); it != articleIndexes.cend())
+                    result.articles[it.value()][RSS::Article::KeyIsRead] = true;
+                break;
+            case RSS::Private::ArticleRecord::Type::Remove:
+                if (const auto it = articleIndexes.constFind(record.articleID); it != articleIndexes.cend())
+                {
+                    result.articles[it.value()].clear();
+                    result.articleOffsets.remove(record.articleID);
+                    articleIndexes.erase(it);
+                }
+                break;
+            }
+        }
+
+        result.articles.removeIf([](const QVariantHash &article) { return article.isEmpty(); });
+        result.isComplete = in.atEnd();
+        return result;
+    }
+
+    void sortArticles(QList<QVariantHash> &articles)
+    {
+        std::ranges::sort(articles, [](const QVariantHash &left, const QVariantHash &right)
+        {
+            return (left.value(RSS::Article::KeyDate).toDateTime() > right.value(RSS::Article::KeyDate).toDateTime());
+        });
+    }
+
+    // Descriptions are loaded on demand so they aren't passed to the feed
+    QList<QVariantHash> withoutDescriptions(QList<QVariantHash> articles)
+    {
+        for (QVariantHash &articleData : articles)
+            articleData.remove(RSS::Article::KeyDescription);
+        return articles;
+    }
+}
+
+void RSS::Private::FeedSerializer::load(const Path &dataFileName, const Path &legacyDataFileName, const QString &url)
 {
+    const QMutexLocker locker {&m_mutex};
+
+    m_url = url;
+    m_dataFileName = dataFileName;
+
+    if (!dataFileName.exists() && legacyDataFileName.exists())
+    {
+        // Convert articles stored in legacy JSON format
+        const auto readResult = Utils::IO::readFile(legacyDataFileName, -1);
+        if (!readResult)
+        {
+            LogMsg(tr("Failed to read RSS session data. %1").arg(readResult.error().message), Log::WARNING);
+            return;
+        }
+
+        QList<QVariantHash> articles = loadArticles(readResult.value(), url);
+        if (writeArticles(dataFileName, articles))
+            std::ignore = Utils::Fs::removeFile(legacyDataFileName);
+
+        sortArticles(articles);
+        emit loadingFinished(withoutDescriptions(std::move(articles)));
+        return;
+    }
+
     const auto readResult = Utils::IO::readFile(dataFileName, -1);
     if (!readResult)
     {
@@ -58,27 +259,178 @@ void RSS::Private::FeedSerializer::load(const Path &dataFileName, const QString
         return;
     }
 
-    emit loadingFinished(loadArticles(readResult.value(), url));
+    // Legacy file can remain if it wasn't removed after the articles were converted
+    if (legacyDataFileName.exists() && readResult.value().startsWith(serializeHeader()))
+        std::ignore = Utils::Fs::removeFile(legacyDataFileName);
+
+    bool isComplete = false;
+    QList<QVariantHash> articles = readArticles(readResult.value(), &isComplete);
+    // Get rid of incomplete records that can remain after crash
+    if (!isComplete || needsCompaction())
+        writeArticles(dataFileName, articles);
+
+    sortArticles(articles);
+    emit loadingFinished(withoutDescriptions(std::move(articles)));
 }
 
-void RSS::Private::FeedSerializer::store(const Path &dataFileName, const QList<QVariantHash> &articlesData)
+void RSS::Private::FeedSerializer::store(const Path &dataFileName, const QList<ArticleRecord> &newRecords)
 {
-    QJsonArray arr;
-    for (const QVariantHash &data : articlesData)
+    if (newRecords.isEmpty() && m_failedRecords.isEmpty())
+        return;
+
+    const QMutexLocker locker {&m_mutex};
+
+    m_dataFileName = dataFileName;
+    // The log must contain all the changes in order, otherwise it doesn't match the articles anymore
+    const QList<ArticleRecord> records = std::exchange(m_failedRecords, {}) + newRecords;
+    bool isStored = false;
+    const auto finalize = qScopeGuard([this, &records, &isStored, &dataFileName]
     {
-        auto jsonObj = QJsonObject::fromVariantHash(data);
-        // JSON object doesn't support DateTime so we need to convert it
-        jsonObj[Article::KeyDate] = data[Article::KeyDate].toDateTime().toString(Qt::RFC2822Date);
+        if (!isStored)
+        {
+            // Descriptions of the failed records remain pending until they are written
+            m_failedRecords = records;
+            if (!m_isRetryScheduled)
+            {
+                m_isRetryScheduled = true;
+                QTimer::singleShot(STORE_RETRY_DELAY, Qt::CoarseTimer, this, [this, dataFileName]
+                {
+                    m_isRetryScheduled = false;
+                    store(dataFileName, {});
+                });
+            }
+            return;
+        }
 
-        arr << jsonObj;
+        for (const ArticleRecord &record : records)
+            m_pendingDescriptions.remove(record.articleID);
+    });
+
+    QFile file {dataFileName.data()};
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append))
+    {
+        LogMsg(tr("Failed to save RSS feed in '%1', Reason: %2").arg(dataFileName.toString(), file.errorString())
+               , Log::WARNING);
+        return;
     }
 
-    const nonstd::expected<void, QString> result = Utils::IO::saveToFile(dataFileName, QJsonDocument(arr).toJson(QJsonDocument::Compact));
-    if (!result)
+    QByteArray data;
+    if (file.size() == 0)
+        data = serializeHeader();
+
+    const qint64 fileSize = file.size();
+    QHash<QString, qint64> articleOffsets;
+    QStringList removedArticleIDs;
+    qsizetype articlesCountDelta = 0;
+    for (const ArticleRecord &record : records)
+    {
+        switch (record.type)
+        {
+        case ArticleRecord::Type::Add:
+            articleOffsets.insert(record.articleID, (fileSize + data.size()));
+            ++articlesCountDelta;
+            break;
+        case ArticleRecord::Type::Remove:
+            articleOffsets.remove(record.articleID);
+            removedArticleIDs.append(record.articleID);
+            --articlesCountDelta;
+            break;
+        default:
+            break;
+        }
+
+        data.append(serializeRecord(record));
+    }
+
+    if (file.write(data) != data.size())
+    {
+        LogMsg(tr("Failed to save RSS feed in '%1', Reason: %2").arg(dataFileName.toString(), file.errorString())
+               , Log::WARNING);
+
+        // The records following the partially written one couldn't be read, so it is truncated.
+        // If it fails the log is rewritten, dropping the incomplete record.
+        const bool isTruncated = file.resize(fileSize);
+        file.close();
+        if (!isTruncated)
+            compact(dataFileName);
+        return;
+    }
+
+    file.close();
+    isStored = true;
+    for (const QString &articleID : asConst(removedArticleIDs))
+        m_articleOffsets.remove(articleID);
+    m_articleOffsets.insert(articleOffsets);
+    m_articlesCount += articlesCountDelta;
+    m_recordsCount += records.size();
+
+    if (needsCompaction())
+        compact(dataFileName);
+}
+
+void RSS::Private::FeedSerializer::addPendingRecords(const QList<ArticleRecord> &records)
+{
+    const QMutexLocker locker {&m_mutex};
+
+    for (const ArticleRecord &record : records)
+    {
+        if (record.type == ArticleRecord::Type::Add)
+            m_pendingDescriptions.insert(record.articleID, record.articleData.value(Article::KeyDescription).toString());
+    }
+}
+
+QString RSS::Private::FeedSerializer::articleDescription(const QString &articleID) const
+{
+    const QMutexLocker locker {&m_mutex};
+
+    if (const auto it = m_pendingDescriptions.constFind(articleID); it != m_pendingDescriptions.cend())
+        return it.value();
+
+    const qint64 offset = m_articleOffsets.value(articleID, -1);
+    if (offset < 0)
+        return {};
+
+    QFile file {m_dataFileName.data()};
+    if (!file.open(QIODevice::ReadOnly) || !file.seek(offset))
+        return {};
+
+    QDataStream in {&file};
+    in.setVersion(DATA_STREAM_VERSION);
+    ArticleRecord record;
+    bool isValid = false;
+    if (!readRecord(in, record, &isValid) || !isValid || (record.articleID != articleID))
+        return {};
+
+    return record.articleData.value(Article::KeyDescription).toString();
+}
+
+QHash<QString, QString> RSS::Private::FeedSerializer::articleDescriptions() const
+{
+    const QMutexLocker locker {&m_mutex};
+
+    // The descriptions are read for the caller only so they don't stay in memory.
+    // Only the records of the actual articles are read, the outdated ones are skipped.
+    QHash<QString, QString> descriptions;
+    descriptions.reserve(m_articleOffsets.size() + m_pendingDescriptions.size());
+
+    QFile file {m_dataFileName.data()};
+    if (file.open(QIODevice::ReadOnly))
     {
-       LogMsg(tr("Failed to save RSS feed in '%1', Reason: %2").arg(dataFileName.toString(), result.error())
-              , Log::WARNING);
+        QDataStream in {&file};
+        in.setVersion(DATA_STREAM_VERSION);
+        for (auto it = m_articleOffsets.cbegin(); it != m_articleOffsets.cend(); ++it)
+        {
+            ArticleRecord record;
+            bool isValid = false;
+            if (!file.seek(it.value()) || !readRecord(in, record, &isValid) || !isValid || (record.articleID != it.key()))
+                continue;
+
+            descriptions.insert(it.key(), record.articleData.value(Article::KeyDescription).toString());
+        }
     }
+
+    descriptions.insert(m_pendingDescriptions);
+    return descriptions;
 }
 
 QList<QVariantHash> RSS::Private::FeedSerializer::loadArticles(const QByteArray &data, const QString &url)
@@ -120,10 +472,64 @@ QList<QVariantHash> RSS::Private::FeedSerializer::loadArticles(const QByteArray
         result.push_back(varHash);
     }
 
-    std::ranges::sort(result, [](const QVariantHash &left, const QVariantHash &right)
+    return result;
+}
+
+QList<QVariantHash> RSS::Private::FeedSerializer::readArticles(const QByteArray &data, bool *isComplete)
+{
+    ParsedLog parsedLog = parseLog(data, m_url);
+    if (!parsedLog.isValid)
+        LogMsg(tr("Couldn't load RSS Session data. Invalid data format."), Log::WARNING);
+
+    *isComplete = parsedLog.isComplete;
+    m_recordsCount = parsedLog.recordsCount;
+    m_articlesCount = parsedLog.articles.size();
+    m_articleOffsets = std::move(parsedLog.articleOffsets);
+    return parsedLog.articles;
+}
+
+bool RSS::Private::FeedSerializer::writeArticles(const Path &dataFileName, const QList<QVariantHash> &articles)
+{
+    QByteArray data = serializeHeader();
+    QHash<QString, qint64> articleOffsets;
+    articleOffsets.reserve(articles.size());
+    for (const QVariantHash &articleData : articles)
     {
-        return (left.value(Article::KeyDate).toDateTime() > right.value(Article::KeyDate).toDateTime());
-    });
+        const QString articleID = articleData.value(Article::KeyId).toString();
+        articleOffsets.insert(articleID, data.size());
+        data.append(serializeRecord({.type = ArticleRecord::Type::Add, .articleID = articleID, .articleData = articleData}));
+    }
 
-    return result;
+    const nonstd::expected<void, QString> result = Utils::IO::saveToFile(dataFileName, data);
+    if (!result)
+    {
+        LogMsg(tr("Failed to save RSS feed in '%1', Reason: %2").arg(dataFileName.toString(), result.error())
+               , Log::WARNING);
+        return false;
+    }
+
+    m_recordsCount = articles.size();
+    m_articlesCount = articles.size();
+    m_articleOffsets = std::move(articleOffsets);
+    return true;
+}
+
+bool RSS::Private::FeedSerializer::needsCompaction() const
+{
+    const qsizetype outdatedRecordsCount = m_recordsCount - m_articlesCount;
+    return (outdatedRecordsCount > std::max(MIN_OUTDATED_RECORDS_TO_COMPACT, m_articlesCount));
+}
+
+void RSS::Private::FeedSerializer::compact(const Path &dataFileName)
+{
+    const auto readResult = Utils::IO::readFile(dataFileName, -1);
+    if (!readResult)
+    {
+        LogMsg(tr("Failed to read RSS session data. %1").arg(readResult.error().message), Log::WARNING);
+        return;
+    }
+
+    bool isComplete = false;
+    const QList<QVariantHash> articles = readArticles(readResult.value(), &isComplete);
+    writeArticles(dataFileName, articles);
 }
@@ -32,14 +32,36 @@
 #pragma once
 
 #include <QtContainerFwd>
+#include <QHash>
+#include <QMutex>
 #include <QObject>
 #include <QString>
 #include <QVariantHash>
 
-#include "base/pathfwd.h"
+#include "base/path.h"
 
 namespace RSS::Private
 {
+    struct ArticleRecord
+    {
+        enum class Type : quint8
+        {
+            Add = 1,
+            MarkAsRead = 2,
+            Remove = 3
+        };
+
+        Type type = Type::Add;
+        QString articleID;
+        // Add records only
+        QVariantHash articleData;
+    };
+
+    // Articles of each feed are stored in append-only binary log of article records,
+    // so storing the changes doesn't require rewriting all the articles.
+    // The log is compacted once it contains too many outdated records.
+    // Records that failed to be written are kept and written again along with the next ones.
+    // Article descriptions aren't kept in memory, they are read from the log on demand.
     class FeedSerializer final : public QObject
     {
         Q_OBJECT
@@ -48,13 +70,35 @@ namespace RSS::Private
     public:
         using QObject::QObject;
 
-        void load(const Path &dataFileName, const QString &url);
-        void store(const Path &dataFileName, const QList<QVariantHash> &articlesData);
+        void load(const Path &dataFileName, const Path &legacyDataFileName, const QString &url);
+        void store(const Path &dataFileName, const QList<ArticleRecord> &records);
+
+        // The following functions are thread-safe
+        void addPendingRecords(const QList<ArticleRecord> &records);
+        QString articleDescription(const QString &articleID) const;
+        QHash<QString, QString> articleDescriptions() const;
 
     signals:
         void loadingFinished(const QList<QVariantHash> &articles);
 
     private:
         QList<QVariantHash> loadArticles(const QByteArray &data, const QString &url);
+        QList<QVariantHash> readArticles(const QByteArray &data, bool *isComplete);
+        bool writeArticles(const Path &dataFileName, const QList<QVariantHash> &articles);
+        bool needsCompaction() const;
+        void compact(const Path &dataFileName);
+
+        QString m_url;
+        QList<ArticleRecord> m_failedRecords;
+        bool m_isRetryScheduled = false;
+        qsizetype m_recordsCount = 0;
+        qsizetype m_articlesCount = 0;
+
+        // guards the data file and the following members
+        mutable QMutex m_mutex;
+        Path m_dataFileName;
+        QHash<QString, qint64> m_articleOffsets;
+        // descriptions of the articles which records aren't written yet
+        QHash<QString, QString> m_pendingDescriptions;
     };
 }
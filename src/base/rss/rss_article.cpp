@@ -53,12 +53,12 @@ Article::Article(Feed *feed, const QVariantHash &varHash)
     , m_date {varHash.value(KeyDate).toDateTime()}
     , m_title {varHash.value(KeyTitle).toString()}
     , m_author {varHash.value(KeyAuthor).toString()}
-    , m_description {varHash.value(KeyDescription).toString()}
     , m_torrentURL {varHash.value(KeyTorrentURL).toString()}
     , m_link {varHash.value(KeyLink).toString()}
     , m_isRead {varHash.value(KeyIsRead, false).toBool()}
     , m_data {varHash}
 {
+    m_data.remove(KeyDescription);
 }
 
 QString Article::guid() const
@@ -83,7 +83,7 @@ QString Article::author() const
 
 QString Article::description() const
 {
-    return m_description;
+    return m_feed->articleDescription(m_guid);
 }
 
 QString Article::torrentUrl() const
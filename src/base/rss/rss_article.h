@@ -63,10 +63,12 @@ namespace RSS
         QDateTime date() const;
         QString title() const;
         QString author() const;
+        // Description isn't kept in memory, it is loaded on demand
         QString description() const;
         QString torrentUrl() const;
         QString link() const;
         bool isRead() const;
+        // Returns article data except description
         QVariantHash data() const;
 
         void markAsRead();
@@ -82,7 +84,6 @@ namespace RSS
         QDateTime m_date;
         QString m_title;
         QString m_author;
-        QString m_description;
         QString m_torrentURL;
         QString m_link;
         bool m_isRead = false;
@@ -28,21 +28,31 @@
 
 #include "rss_autodownloader.h"
 
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <optional>
 #include <queue>
+#include <utility>
 
 #include <QDataStream>
 #include <QDebug>
+#include <QFuture>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonValue>
 #include <QList>
+#include <QPromise>
+#include <QSet>
 #include <QThread>
+#include <QThreadPool>
 #include <QTimer>
 #include <QUrl>
 #include <QVariant>
 
 #include "base/addtorrentmanager.h"
 #include "base/asyncfilestorage.h"
+#include "base/bittorrent/addtorrentparams.h"
 #include "base/bittorrent/session.h"
 #include "base/bittorrent/torrentdescriptor.h"
 #include "base/global.h"
@@ -51,21 +61,22 @@
 #include "base/profile.h"
 #include "base/utils/fs.h"
 #include "base/utils/io.h"
+#include "autodownload_fetchqueue.h"
+#include "autodownload_matcher.h"
 #include "rss_article.h"
 #include "rss_autodownloadrule.h"
 #include "rss_feed.h"
 #include "rss_folder.h"
 #include "rss_session.h"
 
-struct ProcessingJob
-{
-    QString feedURL;
-    QVariantHash articleData;
-};
-
 const QString CONF_FOLDER_NAME = u"rss"_s;
 const QString RULES_FILE_NAME = u"download_rules.json"_s;
 
+const int MAX_CONCURRENT_FETCHES_PER_HOST = 2;
+const int MAX_FETCH_ATTEMPTS = 3;
+// it is doubled on each subsequent attempt
+const std::chrono::seconds FETCH_RETRY_DELAY {60};
+
 namespace
 {
     QList<RSS::AutoDownloadRule> rulesFromJSON(const QByteArray &jsonData)
@@ -107,8 +118,12 @@ AutoDownloader::AutoDownloader(IApplication *app)
     , m_storeProcessingEnabled {u"RSS/AutoDownloader/EnableProcessing"_s, false}
     , m_storeSmartEpisodeFilter {u"RSS/AutoDownloader/SmartEpisodeFilter"_s}
     , m_storeDownloadRepacks {u"RSS/AutoDownloader/DownloadRepacks"_s}
+    , m_storeMaxPreviouslyMatchedEpisodes {u"RSS/AutoDownloader/MaxPreviouslyMatchedEpisodes"_s}
     , m_processingTimer {new QTimer(this)}
+    , m_fetchQueue {std::make_unique<Private::FetchQueue>(MAX_FETCH_ATTEMPTS, FETCH_RETRY_DELAY, MAX_CONCURRENT_FETCHES_PER_HOST)}
+    , m_fetchTimer {new QTimer(this)}
     , m_ioThread {new QThread}
+    , m_dryRunWorker {new QThreadPool(this)}
 {
     Q_ASSERT(!m_instance); // only one instance is allowed
     m_instance = this;
@@ -126,6 +141,9 @@ AutoDownloader::AutoDownloader(IApplication *app)
     m_ioThread->setObjectName("RSS::AutoDownloader m_ioThread");
     m_ioThread->start();
 
+    m_dryRunWorker->setMaxThreadCount(1);
+    m_dryRunWorker->setObjectName("RSS::AutoDownloader m_dryRunWorker");
+
     connect(app->addTorrentManager(), &AddTorrentManager::torrentAdded
             , this, &AutoDownloader::handleTorrentAdded);
     connect(app->addTorrentManager(), &AddTorrentManager::duplicateTorrentDetected
@@ -140,13 +158,22 @@ AutoDownloader::AutoDownloader(IApplication *app)
                     | QRegularExpression::ExtendedPatternSyntaxOption
                     | QRegularExpression::UseUnicodePropertiesOption);
 
+    m_matcher = new Private::AutoDownloadMatcher;
+    m_matcher->moveToThread(Session::instance()->workingThread());
+    connect(this, &AutoDownloader::destroyed, m_matcher, &Private::AutoDownloadMatcher::deleteLater);
+    connect(m_matcher, &Private::AutoDownloadMatcher::finished, this, &AutoDownloader::handleMatchingFinished);
+
     load();
+    updateMatcherRules();
 
     connect(Session::instance(), &Session::feedURLChanged, this, &AutoDownloader::handleFeedURLChanged);
 
     m_processingTimer->setSingleShot(true);
     connect(m_processingTimer, &QTimer::timeout, this, &AutoDownloader::process);
 
+    m_fetchTimer->setSingleShot(true);
+    connect(m_fetchTimer, &QTimer::timeout, this, &AutoDownloader::fetchTorrents);
+
     const auto *btSession = BitTorrent::Session::instance();
     if (btSession->isRestored())
     {
@@ -199,7 +226,9 @@ void AutoDownloader::setRule(const AutoDownloadRule &rule)
         m_dirty = true;
         store();
         emit ruleAdded(rule.name());
-        resetProcessingQueue();
+        updateMatcherRules();
+        if (rule.isEnabled())
+            queueFeedArticles(rule.feedURLs());
     }
     else if (ruleByName(rule.name()) != rule)
     {
@@ -209,7 +238,9 @@ void AutoDownloader::setRule(const AutoDownloadRule &rule)
         m_dirty = true;
         storeDeferred();
         emit ruleChanged(rule.name());
-        resetProcessingQueue();
+        updateMatcherRules();
+        if (rule.isEnabled())
+            queueFeedArticles(rule.feedURLs());
     }
 }
 
@@ -242,6 +273,7 @@ bool AutoDownloader::renameRule(const QString &ruleName, const QString &newRuleN
     m_dirty = true;
     store();
     emit ruleRenamed(newRuleName, ruleName);
+    updateMatcherRules();
     return true;
 }
 
@@ -262,6 +294,45 @@ void AutoDownloader::removeRule(const QString &ruleName)
 
     m_dirty = true;
     store();
+    // Removed rule can't make other rules accept the articles, so they aren't queued again
+    updateMatcherRules();
+}
+
+QFuture<QList<RuleDryRunResult>> AutoDownloader::dryRunRules() const
+{
+    QList<AutoDownloadRule> rules;
+    rules.reserve(m_rules.size());
+    QHash<QString, QList<QVariantHash>> articlesByFeed;
+    for (const AutoDownloadRule &rule : asConst(m_rules))
+    {
+        rules.append(rule.detached());
+        for (const QString &feedURL : asConst(rule.feedURLs()))
+        {
+            if (articlesByFeed.contains(feedURL))
+                continue;
+
+            const Feed *feed = Session::instance()->feedByURL(feedURL);
+            if (!feed)
+                continue;
+
+            QList<QVariantHash> &articles = articlesByFeed[feedURL];
+            articles.reserve(feed->articles().size());
+            for (const Article *article : asConst(feed->articles()))
+                articles.append(article->data());
+        }
+    }
+
+    // Dry run is performed by separate worker so it isn't queued behind the regular processing
+    auto promise = std::make_shared<QPromise<QList<RuleDryRunResult>>>();
+    QFuture<QList<RuleDryRunResult>> future = promise->future();
+    promise->start();
+    m_dryRunWorker->start([promise, rules, smartFilterSettings = smartFilterSettings(), articlesByFeed]
+    {
+        promise->addResult(Private::AutoDownloadMatcher::dryRun(rules, smartFilterSettings, articlesByFeed));
+        promise->finish();
+    });
+
+    return future;
 }
 
 QByteArray AutoDownloader::exportRules(AutoDownloader::RulesFileFormat format) const
@@ -346,11 +417,6 @@ QStringList AutoDownloader::smartEpisodeFilters() const
     return filter.toStringList();
 }
 
-QRegularExpression AutoDownloader::smartEpisodeRegex() const
-{
-    return m_smartEpisodeRegex;
-}
-
 void AutoDownloader::setSmartEpisodeFilters(const QStringList &filters)
 {
     m_storeSmartEpisodeFilter = filters;
@@ -369,39 +435,95 @@ void AutoDownloader::setDownloadRepacks(const bool enabled)
     m_storeDownloadRepacks = enabled;
 }
 
+int AutoDownloader::maxPreviouslyMatchedEpisodes() const
+{
+    return m_storeMaxPreviouslyMatchedEpisodes.get(0);
+}
+
+void AutoDownloader::setMaxPreviouslyMatchedEpisodes(const int count)
+{
+    if (count == maxPreviouslyMatchedEpisodes())
+        return;
+
+    m_storeMaxPreviouslyMatchedEpisodes = count;
+
+    bool rulesChanged = false;
+    for (AutoDownloadRule &rule : m_rules)
+    {
+        if (rule.limitPreviouslyMatchedEpisodes(count))
+            rulesChanged = true;
+    }
+
+    // The articles aren't queued again, otherwise the unread articles
+    // of dropped episodes would be matched and downloaded once more
+    if (rulesChanged)
+    {
+        m_dirty = true;
+        storeDeferred();
+        updateMatcherRules();
+    }
+}
+
+SmartFilterSettings AutoDownloader::smartFilterSettings() const
+{
+    return {.episodeRegex = m_smartEpisodeRegex, .downloadRepacks = downloadRepacks()};
+}
+
 void AutoDownloader::process()
 {
     if (m_processingQueue.isEmpty()) // processing was disabled
         return;
 
-    processJob(m_processingQueue.takeFirst());
-    if (!m_processingQueue.isEmpty())
+    // Rules are evaluated in RSS working thread, only accepted articles are reported back.
+    // The settings are passed along with the jobs, so the matcher never accesses AutoDownloader.
+    const QList<Private::ProcessingJob> jobs = std::exchange(m_processingQueue, {});
+    m_processingBatches.append(jobs);
+    QMetaObject::invokeMethod(m_matcher, [matcher = m_matcher, jobs, smartFilterSettings = smartFilterSettings()
+            , maxPreviouslyMatchedEpisodes = maxPreviouslyMatchedEpisodes()]
     {
-        // Schedule to process the next torrent (if any)
-        m_processingTimer->start();
-    }
+        matcher->process(jobs, smartFilterSettings, maxPreviouslyMatchedEpisodes);
+    });
 }
 
 void AutoDownloader::handleTorrentAdded(const QString &source)
 {
-    const auto job = m_waitingJobs.take(source);
-    if (!job)
+    const std::optional<Private::WaitingJob> waitingJob = m_fetchQueue->take(source);
+    if (!waitingJob)
         return;
 
-    if (Feed *feed = Session::instance()->feedByURL(job->feedURL))
+    // jobs waiting for the released fetch slot can proceed
+    if (waitingJob->status == Private::WaitingJob::Status::Fetching)
+        m_fetchTimer->start(0);
+
+    const Private::ProcessingJob &job = waitingJob->job;
+    if (Feed *feed = Session::instance()->feedByURL(job.feedURL))
     {
-        if (Article *article = feed->articleByGUID(job->articleData.value(Article::KeyId).toString()))
+        if (Article *article = feed->articleByGUID(job.articleData.value(Article::KeyId).toString()))
             article->markAsRead();
     }
 }
 
-void AutoDownloader::handleAddTorrentFailed(const QString &source, [[maybe_unused]] const QString &error)
+void AutoDownloader::handleAddTorrentFailed(const QString &source, const QString &error)
 {
-    const auto job = m_waitingJobs.take(source);
-    if (!job)
+    const Private::WaitingJob *waitingJob = m_fetchQueue->job(source);
+    if (!waitingJob || (waitingJob->status != Private::WaitingJob::Status::Fetching))
         return;
 
-    // TODO: Re-schedule job here.
+    const QString articleTitle = waitingJob->job.articleData.value(Article::KeyTitle).toString();
+    const int attempts = waitingJob->attempts;
+    const auto currentTime = std::chrono::steady_clock::now();
+    const bool willRetry = m_fetchQueue->retry(source, currentTime);
+    m_fetchTimer->start(0);
+    if (!willRetry)
+    {
+        LogMsg(tr("Failed to add torrent of RSS article '%1'. Reason: %2. Giving up after %3 attempts.")
+                .arg(articleTitle, error, QString::number(attempts)), Log::WARNING);
+        return;
+    }
+
+    const auto retryDelay = std::chrono::ceil<std::chrono::seconds>(m_fetchQueue->job(source)->nextAttemptTime - currentTime);
+    LogMsg(tr("Failed to add torrent of RSS article '%1'. Reason: %2. Retrying in %3 seconds.")
+            .arg(articleTitle, error, QString::number(retryDelay.count())), Log::WARNING);
 }
 
 void AutoDownloader::handleNewArticle(const Article *article)
@@ -412,6 +534,7 @@ void AutoDownloader::handleNewArticle(const Article *article)
 
 void AutoDownloader::handleFeedURLChanged(Feed *feed, const QString &oldURL)
 {
+    bool rulesChanged = false;
     for (AutoDownloadRule &rule : m_rules)
     {
         if (const qsizetype i = rule.feedURLs().indexOf(oldURL); i >= 0)
@@ -419,25 +542,68 @@ void AutoDownloader::handleFeedURLChanged(Feed *feed, const QString &oldURL)
             auto feedURLs = rule.feedURLs();
             feedURLs.replace(i, feed->url());
             rule.setFeedURLs(feedURLs);
-            m_dirty = true;
+            rulesChanged = true;
         }
     }
 
-    for (const QSharedPointer<ProcessingJob> &job : asConst(m_processingQueue))
+    for (Private::ProcessingJob &job : m_processingQueue)
     {
-        if (job->feedURL == oldURL)
-            job->feedURL = feed->url();
+        if (job.feedURL == oldURL)
+            job.feedURL = feed->url();
     }
 
-    for (const QSharedPointer<ProcessingJob> &job : asConst(m_waitingJobs))
+    for (QList<Private::ProcessingJob> &jobs : m_processingBatches)
     {
-        if (job->feedURL == oldURL)
-            job->feedURL = feed->url();
+        for (Private::ProcessingJob &job : jobs)
+        {
+            if (job.feedURL == oldURL)
+                job.feedURL = feed->url();
+        }
+    }
+
+    m_fetchQueue->replaceFeedURL(oldURL, feed->url());
+
+    if (rulesChanged)
+    {
+        m_dirty = true;
+        // The articles are already processed by the same rules, so they aren't queued again
+        updateMatcherRules();
     }
 
     store();
 }
 
+void AutoDownloader::handleMatchingFinished(const QList<Private::MatchingResult> &results, const qint64 rulesRevision)
+{
+    if (m_processingBatches.isEmpty()) [[unlikely]]
+        return;
+
+    const QList<Private::ProcessingJob> jobs = m_processingBatches.takeFirst();
+    if (!isProcessingEnabled())
+        return;
+
+    if (rulesRevision != m_rulesRevision)
+    {
+        // Results for outdated rules are discarded and the jobs are processed again
+        QSet<std::pair<QString, QString>> queuedArticles;
+        for (const Private::ProcessingJob &job : asConst(m_processingQueue))
+            queuedArticles.insert({job.feedURL, job.articleData.value(Article::KeyId).toString()});
+
+        for (const Private::ProcessingJob &job : jobs)
+        {
+            if (!queuedArticles.contains({job.feedURL, job.articleData.value(Article::KeyId).toString()}))
+                m_processingQueue.append(job);
+        }
+
+        if (!m_processingQueue.isEmpty() && !m_processingTimer->isActive())
+            m_processingTimer->start();
+        return;
+    }
+
+    for (const Private::MatchingResult &result : results)
+        processResult(result);
+}
+
 void AutoDownloader::setRule_impl(const AutoDownloadRule &rule)
 {
     const QString ruleName = rule.name();
@@ -470,55 +636,80 @@ void AutoDownloader::sortRules()
 void AutoDownloader::addJobForArticle(const Article *article)
 {
     const QString torrentURL = article->torrentUrl();
-    if (m_waitingJobs.contains(torrentURL))
+    if (m_fetchQueue->contains(torrentURL))
         return;
 
-    auto job = QSharedPointer<ProcessingJob>::create();
-    job->feedURL = article->feed()->url();
-    job->articleData = article->data();
-    m_processingQueue.append(job);
+    m_processingQueue.append({.feedURL = article->feed()->url(), .articleData = article->data()});
     if (!m_processingTimer->isActive())
         m_processingTimer->start();
 }
 
-void AutoDownloader::processJob(const QSharedPointer<ProcessingJob> &job)
+void AutoDownloader::processResult(const Private::MatchingResult &result)
 {
-    for (AutoDownloadRule &rule : m_rules)
-    {
-        if (!rule.isEnabled())
-            continue;
-        if (!rule.feedURLs().contains(job->feedURL))
-            continue;
-        if (!rule.accepts(job->articleData))
-            continue;
+    const auto index = m_rulesByName.value(result.ruleName, -1);
+    if (index < 0)
+        return;
 
-        m_dirty = true;
-        storeDeferred();
+    AutoDownloadRule &rule = m_rules[index];
+    rule.setLastMatch(result.lastMatch);
+    // The episodes are already limited by the matcher, unless the limit was changed in the meantime
+    rule.setPreviouslyMatchedEpisodes(result.previouslyMatchedEpisodes);
+    rule.limitPreviouslyMatchedEpisodes(maxPreviouslyMatchedEpisodes());
 
-        LogMsg(tr("RSS article '%1' is accepted by rule '%2'. Trying to add torrent...")
-                .arg(job->articleData.value(Article::KeyTitle).toString(), rule.name()));
+    m_dirty = true;
+    storeDeferred();
 
-        const auto torrentURL = job->articleData.value(Article::KeyTorrentURL).toString();
+    LogMsg(tr("RSS article '%1' is accepted by rule '%2'. Trying to add torrent...")
+            .arg(result.job.articleData.value(Article::KeyTitle).toString(), rule.name()));
+
+    const auto torrentURL = result.job.articleData.value(Article::KeyTorrentURL).toString();
+    if (BitTorrent::TorrentDescriptor::parse(torrentURL))
+    {
         app()->addTorrentManager()->addTorrent(torrentURL, rule.addTorrentParams());
 
-        if (BitTorrent::TorrentDescriptor::parse(torrentURL))
+        if (Feed *feed = Session::instance()->feedByURL(result.job.feedURL))
         {
-            if (Feed *feed = Session::instance()->feedByURL(job->feedURL))
-            {
-                if (Article *article = feed->articleByGUID(job->articleData.value(Article::KeyId).toString()))
-                    article->markAsRead();
-            }
-        }
-        else
-        {
-            // waiting for torrent file downloading
-            m_waitingJobs.insert(torrentURL, job);
+            if (Article *article = feed->articleByGUID(result.job.articleData.value(Article::KeyId).toString()))
+                article->markAsRead();
         }
+    }
+    else if (m_fetchQueue->add(torrentURL, result.job, rule.addTorrentParams())) // the same torrent can be accepted from several feeds
+    {
+        m_fetchTimer->start(0);
+    }
+}
 
-        return;
+void AutoDownloader::fetchTorrents()
+{
+    const auto currentTime = std::chrono::steady_clock::now();
+    m_fetchQueue->setFetchDelay(Session::instance()->fetchDelay());
+    const QList<QString> torrentURLs = m_fetchQueue->takeReady(currentTime);
+    if (const std::optional<std::chrono::steady_clock::time_point> nextAttemptTime = m_fetchQueue->nextAttemptTime())
+        m_fetchTimer->start(std::chrono::ceil<std::chrono::milliseconds>(*nextAttemptTime - currentTime));
+
+    // Adding of torrent can fail immediately so it is done after the queue is updated
+    for (const QString &torrentURL : torrentURLs)
+    {
+        if (const Private::WaitingJob *waitingJob = m_fetchQueue->job(torrentURL))
+            app()->addTorrentManager()->addTorrent(torrentURL, waitingJob->addTorrentParams);
     }
 }
 
+void AutoDownloader::updateMatcherRules()
+{
+    // Matcher gets its own copy of the rules so they can be safely used in another thread
+    QList<AutoDownloadRule> rules;
+    rules.reserve(m_rules.size());
+    for (const AutoDownloadRule &rule : asConst(m_rules))
+        rules.append(rule.detached());
+
+    ++m_rulesRevision;
+    QMetaObject::invokeMethod(m_matcher, [matcher = m_matcher, rules, rulesRevision = m_rulesRevision]
+    {
+        matcher->setRules(rules, rulesRevision);
+    });
+}
+
 void AutoDownloader::load()
 {
     const qint64 maxFileSize = 10 * 1024 * 1024;
@@ -605,6 +796,27 @@ void AutoDownloader::resetProcessingQueue()
     }
 }
 
+void AutoDownloader::queueFeedArticles(const QStringList &feedURLs)
+{
+    if (!isProcessingEnabled())
+        return;
+
+    for (const QString &feedURL : feedURLs)
+    {
+        const Feed *feed = Session::instance()->feedByURL(feedURL);
+        if (!feed)
+            continue;
+
+        // Drop the queued jobs of the feed so that its articles aren't queued twice
+        m_processingQueue.removeIf([&feedURL](const Private::ProcessingJob &job) { return (job.feedURL == feedURL); });
+        for (const Article *article : asConst(feed->articles()))
+        {
+            if (!article->isRead() && !article->torrentUrl().isEmpty())
+                addJobForArticle(article);
+        }
+    }
+}
+
 void AutoDownloader::startProcessing()
 {
     resetProcessingQueue();
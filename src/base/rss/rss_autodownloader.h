@@ -28,32 +28,55 @@
 
 #pragma once
 
+#include <memory>
+
 #include <QBasicTimer>
 #include <QHash>
 #include <QList>
 #include <QObject>
 #include <QPointer>
 #include <QRegularExpression>
-#include <QSharedPointer>
+#include <QStringList>
 
 #include "base/applicationcomponent.h"
 #include "base/exceptions.h"
 #include "base/settingvalue.h"
 #include "base/utils/thread.h"
 
+class QThreadPool;
 class QTimer;
 
+template <typename T> class QFuture;
+
 class Application;
 class AsyncFileStorage;
-struct ProcessingJob;
 
 namespace RSS
 {
+    namespace Private
+    {
+        class AutoDownloadMatcher;
+        class FetchQueue;
+        struct MatchingResult;
+        struct ProcessingJob;
+    }
+
     class Article;
     class Feed;
     class Item;
 
     class AutoDownloadRule;
+    struct SmartFilterSettings;
+
+    struct RuleDryRunResult
+    {
+        QString ruleName;
+        qint64 evaluatedArticlesCount = 0;
+        // total time of the rule evaluation, in microseconds
+        qint64 evaluationTime = 0;
+        // titles of matched articles by feed URL
+        QHash<QString, QStringList> matchedArticles;
+    };
 
     class ParsingError : public RuntimeError
     {
@@ -85,11 +108,16 @@ namespace RSS
 
         QStringList smartEpisodeFilters() const;
         void setSmartEpisodeFilters(const QStringList &filters);
-        QRegularExpression smartEpisodeRegex() const;
 
         bool downloadRepacks() const;
         void setDownloadRepacks(bool enabled);
 
+        // 0 means no limit
+        int maxPreviouslyMatchedEpisodes() const;
+        void setMaxPreviouslyMatchedEpisodes(int count);
+
+        SmartFilterSettings smartFilterSettings() const;
+
         bool hasRule(const QString &ruleName) const;
         AutoDownloadRule ruleByName(const QString &ruleName) const;
         QList<AutoDownloadRule> rules() const;
@@ -99,6 +127,10 @@ namespace RSS
         bool renameRule(const QString &ruleName, const QString &newRuleName);
         void removeRule(const QString &ruleName);
 
+        // Evaluates all the rules against all the stored articles of their feeds
+        // without affecting the rules or the articles
+        QFuture<QList<RuleDryRunResult>> dryRunRules() const;
+
         QByteArray exportRules(RulesFileFormat format = RulesFileFormat::JSON) const;
         void importRules(const QByteArray &data, RulesFileFormat format = RulesFileFormat::JSON);
 
@@ -115,15 +147,19 @@ namespace RSS
         void handleAddTorrentFailed(const QString &url, const QString &error);
         void handleNewArticle(const Article *article);
         void handleFeedURLChanged(Feed *feed, const QString &oldURL);
+        void handleMatchingFinished(const QList<RSS::Private::MatchingResult> &results, qint64 rulesRevision);
 
     private:
         void timerEvent(QTimerEvent *event) override;
         void setRule_impl(const AutoDownloadRule &rule);
         void sortRules();
         void resetProcessingQueue();
+        void queueFeedArticles(const QStringList &feedURLs);
         void startProcessing();
         void addJobForArticle(const Article *article);
-        void processJob(const QSharedPointer<ProcessingJob> &job);
+        void processResult(const Private::MatchingResult &result);
+        void fetchTorrents();
+        void updateMatcherRules();
         void load();
         void loadRules(const QByteArray &data);
         void loadRulesLegacy();
@@ -139,14 +175,21 @@ namespace RSS
         CachedSettingValue<bool> m_storeProcessingEnabled;
         SettingValue<QVariant> m_storeSmartEpisodeFilter;
         SettingValue<bool> m_storeDownloadRepacks;
+        SettingValue<int> m_storeMaxPreviouslyMatchedEpisodes;
 
         QTimer *m_processingTimer = nullptr;
         Utils::Thread::UniquePtr m_ioThread;
+        QThreadPool *m_dryRunWorker = nullptr;
         AsyncFileStorage *m_fileStorage = nullptr;
         QList<AutoDownloadRule> m_rules;
         QHash<QString, qsizetype> m_rulesByName;
-        QList<QSharedPointer<ProcessingJob>> m_processingQueue;
-        QHash<QString, QSharedPointer<ProcessingJob>> m_waitingJobs;
+        Private::AutoDownloadMatcher *m_matcher = nullptr;
+        qint64 m_rulesRevision = 0;
+        QList<Private::ProcessingJob> m_processingQueue;
+        // jobs passed to the matcher, in order of submission
+        QList<QList<Private::ProcessingJob>> m_processingBatches;
+        std::unique_ptr<Private::FetchQueue> m_fetchQueue;
+        QTimer *m_fetchTimer = nullptr;
         bool m_dirty = false;
         QBasicTimer m_savingTimer;
         QRegularExpression m_smartEpisodeRegex;
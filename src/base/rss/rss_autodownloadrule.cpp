@@ -36,6 +36,7 @@
 #include <QJsonArray>
 #include <QJsonObject>
 #include <QRegularExpression>
+#include <QSet>
 #include <QSharedData>
 #include <QString>
 #include <QStringList>
@@ -59,6 +60,12 @@ namespace
         return std::nullopt;
     }
 
+    // Episode strings are compared regardless of letter case (e.g. "-REPACK" suffix)
+    QString normalizedEpisodeKey(const QString &episode)
+    {
+        return episode.trimmed().toCaseFolded();
+    }
+
     QJsonValue toJsonValue(const std::optional<bool> boolValue)
     {
         return boolValue.has_value() ? *boolValue : QJsonValue {};
@@ -99,6 +106,52 @@ namespace
             return {};
         return Utils::String::fromEnum(*contentLayout);
     }
+
+    const QRegularExpression &whitespaceRegex()
+    {
+        static const QRegularExpression regex {u"\\s+"_s};
+        return regex;
+    }
+
+    // Returns the longest part of the wildcard that should be matched literally
+    QString longestWildcardLiteral(const QString &wildcard)
+    {
+        const auto isSpecialChar = [](const QChar ch)
+        {
+            return (ch == u'*') || (ch == u'?') || (ch == u'[') || (ch == u']') || (ch == u'\\');
+        };
+
+        QStringView longest;
+        qsizetype start = 0;
+        bool inBrackets = false;
+        for (qsizetype i = 0; i <= wildcard.size(); ++i)
+        {
+            const bool isEnd = (i == wildcard.size());
+            if (!isEnd && !isSpecialChar(wildcard[i]))
+                continue;
+
+            if (!inBrackets && ((i - start) > longest.size()))
+                longest = QStringView(wildcard).sliced(start, (i - start));
+
+            if (!isEnd)
+            {
+                if (wildcard[i] == u'[')
+                    inBrackets = true;
+                else if (wildcard[i] == u']')
+                    inBrackets = false;
+            }
+
+            start = i + 1;
+        }
+
+        return longest.toString();
+    }
+
+    bool isLiteralRegex(const QString &expression)
+    {
+        const QString specialChars = u"\\^$.|?*+()[]{}"_s;
+        return std::ranges::none_of(expression, [&specialChars](const QChar ch) { return specialChars.contains(ch); });
+    }
 }
 
 const QString S_NAME = u"name"_s;
@@ -141,6 +194,8 @@ namespace RSS
 
         bool smartFilter = false;
         QStringList previouslyMatchedEpisodes;
+        // hashed index of normalized previously matched episodes
+        QSet<QString> previouslyMatchedEpisodesIndex;
 
         mutable QStringList lastComputedEpisodes;
         mutable QHash<QString, QRegularExpression> cachedRegexes;
@@ -171,9 +226,8 @@ namespace RSS
 
 using namespace RSS;
 
-QString computeEpisodeName(const QString &article)
+QString computeEpisodeName(const QString &article, const QRegularExpression &episodeRegex)
 {
-    const QRegularExpression episodeRegex = AutoDownloader::instance()->smartEpisodeRegex();
     const QRegularExpressionMatch match = episodeRegex.match(article);
 
     // See if we can extract an season/episode number or date from the title
@@ -225,8 +279,6 @@ QRegularExpression AutoDownloadRule::cachedRegex(const QString &expression, cons
 
 bool AutoDownloadRule::matchesExpression(const QString &articleTitle, const QString &expression) const
 {
-    const QRegularExpression whitespace {u"\\s+"_s};
-
     if (expression.isEmpty())
     {
         // A regex of the form "expr|" will always match, so do the same for wildcards
@@ -241,7 +293,7 @@ bool AutoDownloadRule::matchesExpression(const QString &articleTitle, const QStr
 
     // Only match if every wildcard token (separated by spaces) is present in the article name.
     // Order of wildcard tokens is unimportant (if order is important, they should have used *).
-    const QStringList wildcards {expression.split(whitespace, Qt::SkipEmptyParts)};
+    const QStringList wildcards {expression.split(whitespaceRegex(), Qt::SkipEmptyParts)};
     for (const QString &wildcard : wildcards)
     {
         const QRegularExpression reg {cachedRegex(wildcard, false)};
@@ -364,20 +416,20 @@ bool AutoDownloadRule::matchesEpisodeFilterExpression(const QString &articleTitl
     return false;
 }
 
-bool AutoDownloadRule::matchesSmartEpisodeFilter(const QString &articleTitle) const
+bool AutoDownloadRule::matchesSmartEpisodeFilter(const QString &articleTitle, const SmartFilterSettings &smartFilterSettings) const
 {
     if (!useSmartFilter())
         return true;
 
-    const QString episodeStr = computeEpisodeName(articleTitle);
+    const QString episodeStr = computeEpisodeName(articleTitle, smartFilterSettings.episodeRegex);
     if (episodeStr.isEmpty())
         return false; // Don't accept articles with unrecognized episode number
 
     // See if this episode has been downloaded before
-    const bool previouslyMatched = m_dataPtr->previouslyMatchedEpisodes.contains(episodeStr);
+    const bool previouslyMatched = m_dataPtr->previouslyMatchedEpisodesIndex.contains(normalizedEpisodeKey(episodeStr));
     if (previouslyMatched)
     {
-        if (!AutoDownloader::instance()->downloadRepacks())
+        if (!smartFilterSettings.downloadRepacks)
             return false;
 
         // Now see if we've downloaded this particular repack/proper combination
@@ -390,7 +442,7 @@ bool AutoDownloadRule::matchesSmartEpisodeFilter(const QString &articleTitle) co
         const QString fullEpisodeStr = u"%1%2%3"_s.arg(episodeStr,
                                                         isRepack ? u"-REPACK" : u"",
                                                         isProper ? u"-PROPER" : u"");
-        const bool previouslyMatchedFull = m_dataPtr->previouslyMatchedEpisodes.contains(fullEpisodeStr);
+        const bool previouslyMatchedFull = m_dataPtr->previouslyMatchedEpisodesIndex.contains(normalizedEpisodeKey(fullEpisodeStr));
         if (previouslyMatchedFull)
             return false;
 
@@ -411,7 +463,53 @@ bool AutoDownloadRule::matchesSmartEpisodeFilter(const QString &articleTitle) co
     return true;
 }
 
+QStringList AutoDownloadRule::mustContainKeywords() const
+{
+    if (m_dataPtr->mustContain.isEmpty())
+        return {};
+
+    QStringList keywords;
+    if (m_dataPtr->useRegex)
+    {
+        // Only plain alternation of literals is supported, e.g. "foo|bar"
+        const QStringList alternatives = m_dataPtr->mustContain.first().split(u'|');
+        for (const QString &alternative : alternatives)
+        {
+            if (alternative.isEmpty() || !isLiteralRegex(alternative))
+                return {};
+
+            keywords.append(alternative);
+        }
+
+        return keywords;
+    }
+
+    for (const QString &expression : asConst(m_dataPtr->mustContain))
+    {
+        // Every wildcard of expression should match so any of them can provide a keyword
+        QString expressionKeyword;
+        for (const QString &wildcard : asConst(expression.split(whitespaceRegex(), Qt::SkipEmptyParts)))
+        {
+            const QString literal = longestWildcardLiteral(wildcard);
+            if (literal.size() > expressionKeyword.size())
+                expressionKeyword = literal;
+        }
+
+        if (expressionKeyword.isEmpty())
+            return {};
+
+        keywords.append(expressionKeyword);
+    }
+
+    return keywords;
+}
+
 bool AutoDownloadRule::matches(const QVariantHash &articleData) const
+{
+    return matches(articleData, AutoDownloader::instance()->smartFilterSettings());
+}
+
+bool AutoDownloadRule::matches(const QVariantHash &articleData, const SmartFilterSettings &smartFilterSettings) const
 {
     const QDateTime articleDate {articleData[Article::KeyDate].toDateTime()};
     if (ignoreDays() > 0)
@@ -427,15 +525,15 @@ bool AutoDownloadRule::matches(const QVariantHash &articleData) const
         return false;
     if (!matchesEpisodeFilterExpression(articleTitle))
         return false;
-    if (!matchesSmartEpisodeFilter(articleTitle))
+    if (!matchesSmartEpisodeFilter(articleTitle, smartFilterSettings))
         return false;
 
     return true;
 }
 
-bool AutoDownloadRule::accepts(const QVariantHash &articleData)
+bool AutoDownloadRule::accepts(const QVariantHash &articleData, const SmartFilterSettings &smartFilterSettings)
 {
-    if (!matches(articleData))
+    if (!matches(articleData, smartFilterSettings))
         return false;
 
     setLastMatch(articleData[Article::KeyDate].toDateTime());
@@ -444,6 +542,8 @@ bool AutoDownloadRule::accepts(const QVariantHash &articleData)
     if (!m_dataPtr->lastComputedEpisodes.isEmpty())
     {
         m_dataPtr->previouslyMatchedEpisodes.append(m_dataPtr->lastComputedEpisodes);
+        for (const QString &episode : asConst(m_dataPtr->lastComputedEpisodes))
+            m_dataPtr->previouslyMatchedEpisodesIndex.insert(normalizedEpisodeKey(episode));
         m_dataPtr->lastComputedEpisodes.clear();
     }
 
@@ -459,6 +559,13 @@ AutoDownloadRule &AutoDownloadRule::operator=(const AutoDownloadRule &other)
     return *this;
 }
 
+AutoDownloadRule AutoDownloadRule::detached() const
+{
+    AutoDownloadRule rule = *this;
+    rule.m_dataPtr.detach();
+    return rule;
+}
+
 QJsonObject AutoDownloadRule::toJsonObject() const
 {
     const BitTorrent::AddTorrentParams &addTorrentParams = m_dataPtr->addTorrentParams;
@@ -744,6 +851,22 @@ QStringList AutoDownloadRule::previouslyMatchedEpisodes() const
 void AutoDownloadRule::setPreviouslyMatchedEpisodes(const QStringList &previouslyMatchedEpisodes)
 {
     m_dataPtr->previouslyMatchedEpisodes = previouslyMatchedEpisodes;
+
+    m_dataPtr->previouslyMatchedEpisodesIndex.clear();
+    m_dataPtr->previouslyMatchedEpisodesIndex.reserve(previouslyMatchedEpisodes.size());
+    for (const QString &episode : previouslyMatchedEpisodes)
+        m_dataPtr->previouslyMatchedEpisodesIndex.insert(normalizedEpisodeKey(episode));
+}
+
+bool AutoDownloadRule::limitPreviouslyMatchedEpisodes(const int maxCount)
+{
+    // Episodes are appended as they are matched so the oldest ones come first
+    const QStringList episodes = previouslyMatchedEpisodes();
+    if ((maxCount <= 0) || (episodes.size() <= maxCount))
+        return false;
+
+    setPreviouslyMatchedEpisodes(episodes.sliced(episodes.size() - maxCount));
+    return true;
 }
 
 QString AutoDownloadRule::episodeFilter() const
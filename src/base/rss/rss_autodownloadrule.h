@@ -31,6 +31,7 @@
 
 #include <optional>
 
+#include <QRegularExpression>
 #include <QSharedDataPointer>
 #include <QVariant>
 
@@ -40,12 +41,17 @@
 
 class QDateTime;
 class QJsonObject;
-class QRegularExpression;
-
 namespace RSS
 {
     struct AutoDownloadRuleData;
 
+    // Application-wide settings of smart episode filter
+    struct SmartFilterSettings
+    {
+        QRegularExpression episodeRegex;
+        bool downloadRepacks = true;
+    };
+
     class AutoDownloadRule
     {
     public:
@@ -55,6 +61,9 @@ namespace RSS
 
         AutoDownloadRule &operator=(const AutoDownloadRule &other);
 
+        // Returns a copy that doesn't share data with this rule so it can be used in another thread
+        AutoDownloadRule detached() const;
+
         QString name() const;
         void setName(const QString &name);
 
@@ -83,12 +92,21 @@ namespace RSS
 
         QStringList previouslyMatchedEpisodes() const;
         void setPreviouslyMatchedEpisodes(const QStringList &previouslyMatchedEpisodes);
+        // Drops the oldest episodes so that at most maxCount of them remain (0 means no limit)
+        // Returns true if any episode was dropped
+        bool limitPreviouslyMatchedEpisodes(int maxCount);
 
         BitTorrent::AddTorrentParams addTorrentParams() const;
         void setAddTorrentParams(BitTorrent::AddTorrentParams addTorrentParams);
 
+        // Returns literal substrings at least one of which occurs in the title of any article
+        // the rule matches, or an empty list if they can't be determined (the rule can match anything)
+        QStringList mustContainKeywords() const;
+
+        // Uses the current settings of AutoDownloader so it can be called from main thread only
         bool matches(const QVariantHash &articleData) const;
-        bool accepts(const QVariantHash &articleData);
+        bool matches(const QVariantHash &articleData, const SmartFilterSettings &smartFilterSettings) const;
+        bool accepts(const QVariantHash &articleData, const SmartFilterSettings &smartFilterSettings);
 
         friend bool operator==(const AutoDownloadRule &left, const AutoDownloadRule &right);
 
@@ -102,7 +120,7 @@ namespace RSS
         bool matchesMustContainExpression(const QString &articleTitle) const;
         bool matchesMustNotContainExpression(const QString &articleTitle) const;
         bool matchesEpisodeFilterExpression(const QString &articleTitle) const;
-        bool matchesSmartEpisodeFilter(const QString &articleTitle) const;
+        bool matchesSmartEpisodeFilter(const QString &articleTitle, const SmartFilterSettings &smartFilterSettings) const;
         bool matchesExpression(const QString &articleTitle, const QString &expression) const;
         QRegularExpression cachedRegex(const QString &expression, bool isRegex = true) const;
 
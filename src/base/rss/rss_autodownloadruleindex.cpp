@@ -0,0 +1,86 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "rss_autodownloadruleindex.h"
+
+#include <QStringList>
+
+#include "base/global.h"
+#include "rss_autodownloadrule.h"
+
+using namespace RSS;
+
+AutoDownloadRuleIndex::AutoDownloadRuleIndex(const QList<AutoDownloadRule> &rules)
+    : m_unconditionalRules(rules.size(), false)
+{
+    QStringList keywords;
+    for (qsizetype i = 0; i < rules.size(); ++i)
+    {
+        const AutoDownloadRule &rule = rules[i];
+        if (!rule.isEnabled())
+            continue;
+
+        for (const QString &feedURL : asConst(rule.feedURLs()))
+            m_rulesByFeedURL[feedURL].append(i);
+
+        const QStringList ruleKeywords = rule.mustContainKeywords();
+        if (ruleKeywords.isEmpty())
+        {
+            m_unconditionalRules[i] = true;
+            continue;
+        }
+
+        for (const QString &keyword : ruleKeywords)
+        {
+            keywords.append(keyword);
+            m_keywordRules.append(i);
+        }
+    }
+
+    m_keywordsMatcher = Utils::AhoCorasick(keywords, Qt::CaseInsensitive);
+}
+
+QList<qsizetype> AutoDownloadRuleIndex::candidates(const QString &feedURL, const QString &articleTitle) const
+{
+    const QList<qsizetype> feedRules = m_rulesByFeedURL.value(feedURL);
+    if (feedRules.isEmpty())
+        return {};
+
+    std::vector<bool> matchedRules(m_unconditionalRules.size(), false);
+    for (const qsizetype keywordID : asConst(m_keywordsMatcher.findAll(articleTitle)))
+        matchedRules[m_keywordRules[keywordID]] = true;
+
+    QList<qsizetype> result;
+    for (const qsizetype ruleIndex : feedRules)
+    {
+        if (m_unconditionalRules[ruleIndex] || matchedRules[ruleIndex])
+            result.append(ruleIndex);
+    }
+
+    return result;
+}
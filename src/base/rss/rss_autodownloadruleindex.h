@@ -0,0 +1,64 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include <QHash>
+#include <QList>
+#include <QString>
+
+#include "base/utils/ahocorasick.h"
+
+namespace RSS
+{
+    class AutoDownloadRule;
+
+    // Precompiled lookup structure for a list of auto downloading rules.
+    // It allows to quickly narrow down the rules that may accept an article
+    // so that only those have to run their full (and expensive) matching logic.
+    class AutoDownloadRuleIndex
+    {
+    public:
+        AutoDownloadRuleIndex() = default;
+        explicit AutoDownloadRuleIndex(const QList<AutoDownloadRule> &rules);
+
+        // Returns indexes (in the list the index was built from) of enabled rules
+        // that are assigned to the given feed and may match the given article title.
+        // The indexes are in the original order of the rules.
+        QList<qsizetype> candidates(const QString &feedURL, const QString &articleTitle) const;
+
+    private:
+        QHash<QString, QList<qsizetype>> m_rulesByFeedURL;
+        // rules that don't have any keywords should be checked for any article
+        std::vector<bool> m_unconditionalRules;
+        Utils::AhoCorasick m_keywordsMatcher;
+        QList<qsizetype> m_keywordRules;
+    };
+}
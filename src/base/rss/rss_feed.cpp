@@ -41,6 +41,7 @@
 #include <QJsonObject>
 #include <QJsonValue>
 #include <QList>
+#include <QSet>
 #include <QUrl>
 
 #include "base/asyncfilestorage.h"
@@ -75,14 +76,16 @@ Feed::Feed(Session *session, const QUuid &uid, const QString &url, const QString
     , m_refreshInterval {refreshInterval}
 {
     const auto uidHex = QString::fromLatin1(m_uid.toRfc4122().toHex());
-    m_dataFileName = Path(uidHex + u".json");
+    m_dataFileName = Path(uidHex + u".dat");
+    // Articles stored in JSON format will be converted during loading
+    m_legacyDataFileName = Path(uidHex + u".json");
 
     // Move to new file naming scheme (since v4.1.2)
     const QString legacyFilename = Utils::Fs::toValidFileName(m_url, u"_"_s) + u".json";
     const Path storageDir = m_session->dataFileStorage()->storageDir();
-    const Path dataFilePath = storageDir / m_dataFileName;
-    if (!dataFilePath.exists())
-        Utils::Fs::renameFile((storageDir / Path(legacyFilename)), dataFilePath);
+    const Path legacyDataFilePath = storageDir / m_legacyDataFileName;
+    if (!(storageDir / m_dataFileName).exists() && !legacyDataFilePath.exists())
+        Utils::Fs::renameFile((storageDir / Path(legacyFilename)), legacyDataFilePath);
 
     m_iconPath = storageDir / Path(uidHex + u".ico");
 
@@ -128,6 +131,7 @@ void Feed::markAsRead()
         {
             article->disconnect(this);
             article->markAsRead();
+            m_pendingRecords.append({.type = Private::ArticleRecord::Type::MarkAsRead, .articleID = article->guid()});
             --m_unreadCount;
             emit articleRead(article);
         }
@@ -154,7 +158,9 @@ void Feed::refresh()
 
     // NOTE: Should we allow manually refreshing for disabled session?
 
-    m_downloadHandler = Net::DownloadManager::instance()->download(m_url, Preferences::instance()->useProxyForRSS());
+    // Feed document is downloaded only if it was modified since last update
+    const auto downloadRequest = Net::DownloadRequest(m_url).ifNoneMatch(m_eTag).ifModifiedSince(m_lastModified);
+    m_downloadHandler = Net::DownloadManager::instance()->download(downloadRequest, Preferences::instance()->useProxyForRSS());
     connect(m_downloadHandler, &Net::DownloadHandler::finished, this, &Feed::handleDownloadFinished);
 
     if (!m_iconPath.exists())
@@ -209,7 +215,9 @@ void Feed::handleMaxArticlesPerFeedChanged(const int n)
 {
     while (m_articlesByDate.size() > n)
         removeOldestArticle();
-    // We don't need store articles here
+
+    m_dirty = true;
+    storeDeferred();
 }
 
 void Feed::handleIconDownloadFinished(const Net::DownloadResult &result)
@@ -229,14 +237,30 @@ void Feed::handleDownloadFinished(const Net::DownloadResult &result)
 {
     m_downloadHandler = nullptr; // will be deleted by DownloadManager later
 
+    if (result.status == Net::DownloadStatus::NotModified)
+    {
+        m_isLoading = false;
+        m_hasError = false;
+
+        LogMsg(tr("RSS feed at '%1' is not modified since last update.").arg(result.url));
+
+        emit stateChanged(this);
+        emit refreshFinished(this, 0);
+        return;
+    }
+
     if (result.status == Net::DownloadStatus::Success)
     {
         LogMsg(tr("RSS feed at '%1' is successfully downloaded. Starting to parse it.")
                 .arg(result.url));
+        m_eTag = result.eTag;
+        m_lastModified = result.lastModified;
         // Parse the download RSS
-        QMetaObject::invokeMethod(m_parser, [this, data = result.data]()
+        const QList<QString> articleIDs = m_articles.keys();
+        QMetaObject::invokeMethod(m_parser, [this, data = result.data
+                , knownArticleIDs = QSet<QString>(articleIDs.cbegin(), articleIDs.cend())]()
         {
-            m_parser->parse(data);
+            m_parser->parse(data, knownArticleIDs);
         });
     }
     else
@@ -272,11 +296,15 @@ void Feed::handleParsingFinished(const RSS::Private::ParsingResult &result)
     // successfully parsed by the XML parser. We are still trying to load as many articles
     // as possible until we encounter corrupted data. So we can have some articles here
     // even in case of parsing error.
-    const int newArticlesCount = updateArticles(result.articles);
+    const int newArticlesCount = updateArticles(result.articles, result.knownArticleIDs);
     store();
 
     if (m_hasError)
     {
+        // Make sure the feed is downloaded and parsed again next time
+        m_eTag.clear();
+        m_lastModified.clear();
+
         LogMsg(tr("Failed to parse RSS feed at '%1'. Reason: %2").arg(m_url, result.error)
                , Log::WARNING);
     }
@@ -285,15 +313,18 @@ void Feed::handleParsingFinished(const RSS::Private::ParsingResult &result)
 
     m_isLoading = false;
     emit stateChanged(this);
+    if (!m_hasError)
+        emit refreshFinished(this, newArticlesCount);
 }
 
 void Feed::load()
 {
+    const Path storageDir = m_session->dataFileStorage()->storageDir();
     QMetaObject::invokeMethod(m_serializer
             , [serializer = m_serializer, url = m_url
-                , path = (m_session->dataFileStorage()->storageDir() / m_dataFileName)]
+                , path = (storageDir / m_dataFileName), legacyPath = (storageDir / m_legacyDataFileName)]
     {
-        serializer->load(path, url);
+        serializer->load(path, legacyPath, url);
     });
 }
 
@@ -305,17 +336,18 @@ void Feed::store()
     m_dirty = false;
     m_savingTimer.stop();
 
-    QList<QVariantHash> articlesData;
-    articlesData.reserve(m_articles.size());
+    if (m_pendingRecords.isEmpty())
+        return;
 
-    for (Article *article :asConst(m_articles))
-        articlesData.push_back(article->data());
+    // Keep the descriptions of added articles available until they are written
+    m_serializer->addPendingRecords(m_pendingRecords);
 
+    // Only the changes are stored, they are appended to the articles data file
     QMetaObject::invokeMethod(m_serializer
-            , [articlesData, serializer = m_serializer
+            , [records = std::exchange(m_pendingRecords, {}), serializer = m_serializer
                 , path = (m_session->dataFileStorage()->storageDir() / m_dataFileName)]
     {
-        serializer->store(path, articlesData);
+        serializer->store(path, records);
     });
 }
 
@@ -339,6 +371,7 @@ bool Feed::addArticle(const QVariantHash &articleData)
     auto *article = new Article(this, articleData);
     m_articles[article->guid()] = article;
     m_articlesByDate.insert(lowerBound, article);
+    m_pendingRecords.append({.type = Private::ArticleRecord::Type::Add, .articleID = article->guid(), .articleData = articleData});
     if (!article->isRead())
     {
         increaseUnreadCount();
@@ -361,6 +394,7 @@ void Feed::removeOldestArticle()
 
     m_articles.remove(oldestArticle->guid());
     m_articlesByDate.removeLast();
+    m_pendingRecords.append({.type = Private::ArticleRecord::Type::Remove, .articleID = oldestArticle->guid()});
     const bool isRead = oldestArticle->isRead();
     delete oldestArticle;
 
@@ -393,7 +427,7 @@ void Feed::downloadIcon()
             , Preferences::instance()->useProxyForRSS(), this, &Feed::handleIconDownloadFinished);
 }
 
-int Feed::updateArticles(const QList<QVariantHash> &loadedArticles)
+int Feed::updateArticles(const QList<QVariantHash> &loadedArticles, const QSet<QString> &knownArticleIDs)
 {
     if (loadedArticles.empty())
         return 0;
@@ -406,13 +440,19 @@ int Feed::updateArticles(const QList<QVariantHash> &loadedArticles)
         // If article has no publication date we use feed update time as a fallback.
         // To prevent processing of "out-of-limit" articles we must not assign dates
         // that are earlier than the dates of existing articles.
-        const Article *existingArticle = articleByGUID(article[Article::KeyId].toString());
+        const QString articleID = article[Article::KeyId].toString();
+        const Article *existingArticle = articleByGUID(articleID);
         if (existingArticle)
         {
             dummyPubDate = existingArticle->date().addMSecs(-1);
             continue;
         }
 
+        // The article reported with ID only was removed from the feed after the parsing was started,
+        // its data isn't available anymore
+        if (knownArticleIDs.contains(articleID))
+            continue;
+
         QVariant &articleDate = article[Article::KeyDate];
         if (!articleDate.toDateTime().isValid())
             articleDate = dummyPubDate;
@@ -454,6 +494,29 @@ int Feed::updateArticles(const QList<QVariantHash> &loadedArticles)
     return newArticlesCount;
 }
 
+QString Feed::articleDescription(const QString &guid) const
+{
+    for (const Private::ArticleRecord &record : m_pendingRecords)
+    {
+        if ((record.type == Private::ArticleRecord::Type::Add) && (record.articleID == guid))
+            return record.articleData.value(Article::KeyDescription).toString();
+    }
+
+    return m_serializer->articleDescription(guid);
+}
+
+QHash<QString, QString> Feed::articleDescriptions() const
+{
+    QHash<QString, QString> descriptions = m_serializer->articleDescriptions();
+    for (const Private::ArticleRecord &record : m_pendingRecords)
+    {
+        if (record.type == Private::ArticleRecord::Type::Add)
+            descriptions.insert(record.articleID, record.articleData.value(Article::KeyDescription).toString());
+    }
+
+    return descriptions;
+}
+
 Path Feed::iconPath() const
 {
     return m_iconPath;
@@ -477,6 +540,8 @@ void Feed::setURL(const QString &url)
 {
     const QString oldURL = m_url;
     m_url = url;
+    m_eTag.clear();
+    m_lastModified.clear();
     emit urlChanged(oldURL);
 }
 
@@ -495,10 +560,13 @@ QJsonValue Feed::toJsonValue(const bool withData) const
         jsonObj.insert(KEY_ISLOADING, isLoading());
         jsonObj.insert(KEY_HASERROR, hasError());
 
+        const QHash<QString, QString> descriptions = articleDescriptions();
         QJsonArray jsonArr;
         for (Article *article : asConst(m_articles))
         {
             auto articleObj = QJsonObject::fromVariantHash(article->data());
+            if (const QString description = descriptions.value(article->guid()); !description.isEmpty())
+                articleObj[Article::KeyDescription] = description;
             // JSON object doesn't support DateTime so we need to convert it
             articleObj[Article::KeyDate] = article->date().toString(Qt::RFC2822Date);
             jsonArr.append(articleObj);
@@ -522,6 +590,7 @@ void Feed::handleSessionProcessingEnabledChanged(const bool enabled)
 void Feed::handleArticleRead(Article *article)
 {
     article->disconnect(this);
+    m_pendingRecords.append({.type = Private::ArticleRecord::Type::MarkAsRead, .articleID = article->guid()});
     decreaseUnreadCount();
     emit articleRead(article);
     // will be stored deferred
@@ -536,7 +605,13 @@ void Feed::handleArticleLoadFinished(QList<QVariantHash> articles)
 
     const int maxArticles = m_session->maxArticlesPerFeed();
     if (articles.size() > maxArticles)
+    {
+        for (const QVariantHash &articleData : asConst(articles).sliced(maxArticles))
+            m_pendingRecords.append({.type = Private::ArticleRecord::Type::Remove, .articleID = articleData.value(Article::KeyId).toString()});
         articles.resize(maxArticles);
+        m_dirty = true;
+        storeDeferred();
+    }
 
     m_articles.reserve(articles.size());
     m_articlesByDate.reserve(articles.size());
@@ -576,7 +651,9 @@ void Feed::cleanup()
 {
     m_dirty = false;
     m_savingTimer.stop();
+    m_pendingRecords.clear();
     std::ignore = Utils::Fs::removeFile(m_session->dataFileStorage()->storageDir() / m_dataFileName);
+    std::ignore = Utils::Fs::removeFile(m_session->dataFileStorage()->storageDir() / m_legacyDataFileName);
     std::ignore = Utils::Fs::removeFile(m_iconPath);
 }
 
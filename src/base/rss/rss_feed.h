@@ -41,6 +41,7 @@
 #include <QVariantHash>
 
 #include "base/path.h"
+#include "feed_serializer.h"
 #include "rss_item.h"
 
 class AsyncFileStorage;
@@ -58,7 +59,6 @@ namespace RSS
 
     namespace Private
     {
-        class FeedSerializer;
         class Parser;
         struct ParsingResult;
     }
@@ -68,6 +68,7 @@ namespace RSS
         Q_OBJECT
         Q_DISABLE_COPY_MOVE(Feed)
 
+        friend class Article;
         friend class Session;
 
         Feed(Session *session, const QUuid &uid, const QString &url, const QString &path, std::chrono::seconds refreshInterval);
@@ -100,6 +101,7 @@ namespace RSS
         void stateChanged(Feed *feed = nullptr);
         void urlChanged(const QString &oldURL);
         void refreshIntervalChanged(std::chrono::seconds oldRefreshInterval);
+        void refreshFinished(Feed *feed, int newArticlesCount);
 
     private slots:
         void handleSessionProcessingEnabledChanged(bool enabled);
@@ -121,7 +123,9 @@ namespace RSS
         void increaseUnreadCount();
         void decreaseUnreadCount();
         void downloadIcon();
-        int updateArticles(const QList<QVariantHash> &loadedArticles);
+        QString articleDescription(const QString &guid) const;
+        QHash<QString, QString> articleDescriptions() const;
+        int updateArticles(const QList<QVariantHash> &loadedArticles, const QSet<QString> &knownArticleIDs);
         void setURL(const QString &url);
 
         Session *m_session = nullptr;
@@ -132,6 +136,9 @@ namespace RSS
         std::chrono::seconds m_refreshInterval;
         QString m_title;
         QString m_lastBuildDate;
+        // HTTP validators of the last successfully parsed feed document
+        QString m_eTag;
+        QString m_lastModified;
         bool m_hasError = false;
         bool m_isLoading = false;
         bool m_isInitialized = false;
@@ -141,6 +148,9 @@ namespace RSS
         int m_unreadCount = 0;
         Path m_iconPath;
         Path m_dataFileName;
+        Path m_legacyDataFileName;
+        // article changes that aren't stored yet
+        QList<Private::ArticleRecord> m_pendingRecords;
         QBasicTimer m_savingTimer;
         bool m_dirty = false;
         Net::DownloadHandler *m_downloadHandler = nullptr;
@@ -539,14 +539,20 @@ namespace
 
 const int PARSINGRESULT_TYPEID = qRegisterMetaType<RSS::Private::ParsingResult>();
 
+// Number of consecutive known articles after which the rest of articles are considered known as well
+const int MAX_KNOWN_ARTICLES_IN_ROW = 10;
+
 RSS::Private::Parser::Parser(const QString &lastBuildDate)
 {
     m_result.lastBuildDate = lastBuildDate;
 }
 
 // read and create items from a rss document
-void RSS::Private::Parser::parse(const QByteArray &feedData)
+void RSS::Private::Parser::parse(const QByteArray &feedData, const QSet<QString> &knownArticleIDs)
 {
+    m_knownArticleIDs = knownArticleIDs;
+    m_knownArticlesInRow = 0;
+
     QXmlStreamReader xml {feedData};
     m_fallbackDate = QDateTime::currentDateTime();
     XmlStreamEntityResolver resolver;
@@ -596,8 +602,10 @@ void RSS::Private::Parser::parse(const QByteArray &feedData)
 
     emit finished(m_result);
     m_result.articles.clear();
+    m_result.knownArticleIDs.clear();
     m_result.error.clear();
     m_articleIDs.clear();
+    m_knownArticleIDs.clear();
 }
 
 void RSS::Private::Parser::parseRssArticle(QXmlStreamReader &xml)
@@ -648,7 +656,15 @@ void RSS::Private::Parser::parseRssArticle(QXmlStreamReader &xml)
             }
             else if (name == u"guid")
             {
-                article[Article::KeyId] = xml.readElementText().trimmed();
+                const QString articleID = xml.readElementText().trimmed();
+                if (m_knownArticleIDs.contains(articleID))
+                {
+                    skipRestOfElement(xml);
+                    addKnownArticle(articleID);
+                    return;
+                }
+
+                article[Article::KeyId] = articleID;
             }
             else
             {
@@ -690,7 +706,10 @@ void RSS::Private::Parser::parseRSSChannel(QXmlStreamReader &xml)
             }
             else if (xml.name() == u"item")
             {
-                parseRssArticle(xml);
+                if (isParsingArticlesFinished())
+                    xml.skipCurrentElement();
+                else
+                    parseRssArticle(xml);
             }
         }
     }
@@ -768,7 +787,15 @@ void RSS::Private::Parser::parseAtomArticle(QXmlStreamReader &xml)
             }
             else if (name == u"id")
             {
-                article[Article::KeyId] = xml.readElementText().trimmed();
+                const QString articleID = xml.readElementText().trimmed();
+                if (m_knownArticleIDs.contains(articleID))
+                {
+                    skipRestOfElement(xml);
+                    addKnownArticle(articleID);
+                    return;
+                }
+
+                article[Article::KeyId] = articleID;
             }
             else
             {
@@ -809,7 +836,10 @@ void RSS::Private::Parser::parseAtomChannel(QXmlStreamReader &xml)
             }
             else if (xml.name() == u"entry")
             {
-                parseAtomArticle(xml);
+                if (isParsingArticlesFinished())
+                    xml.skipCurrentElement();
+                else
+                    parseAtomArticle(xml);
             }
         }
     }
@@ -839,6 +869,12 @@ void RSS::Private::Parser::addArticle(QVariantHash article)
         }
     }
 
+    if (m_knownArticleIDs.contains(localId.toString()))
+    {
+        addKnownArticle(localId.toString());
+        return;
+    }
+
     if (m_articleIDs.contains(localId.toString()))
     {
         // The article could not be uniquely identified
@@ -847,6 +883,32 @@ void RSS::Private::Parser::addArticle(QVariantHash article)
         return;
     }
 
+    m_knownArticlesInRow = 0;
     m_articleIDs.insert(localId.toString());
     m_result.articles.prepend(article);
 }
+
+void RSS::Private::Parser::addKnownArticle(const QString &articleID)
+{
+    ++m_knownArticlesInRow;
+
+    if (m_articleIDs.contains(articleID))
+        return;
+
+    // Known article is reported with ID only, the rest of its data is already stored
+    m_articleIDs.insert(articleID);
+    m_result.articles.prepend({{Article::KeyId, articleID}});
+    m_result.knownArticleIDs.insert(articleID);
+}
+
+bool RSS::Private::Parser::isParsingArticlesFinished() const
+{
+    return (m_knownArticlesInRow >= MAX_KNOWN_ARTICLES_IN_ROW);
+}
+
+// Skips the remaining children of the current element
+void RSS::Private::Parser::skipRestOfElement(QXmlStreamReader &xml) const
+{
+    while (xml.readNextStartElement())
+        xml.skipCurrentElement();
+}
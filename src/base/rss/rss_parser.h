@@ -46,6 +46,8 @@ namespace RSS::Private
         QString lastBuildDate;
         QString title;
         QList<QVariantHash> articles;
+        // IDs of the articles that are reported with ID only
+        QSet<QString> knownArticleIDs;
     };
 
     class Parser final : public QObject
@@ -55,7 +57,9 @@ namespace RSS::Private
 
     public:
         explicit Parser(const QString &lastBuildDate);
-        void parse(const QByteArray &feedData);
+        // Since feeds list the articles newest first, the parsing of articles is stopped
+        // once a run of known articles is encountered. Known articles are reported with ID only.
+        void parse(const QByteArray &feedData, const QSet<QString> &knownArticleIDs = {});
 
     signals:
         void finished(const RSS::Private::ParsingResult &result);
@@ -66,11 +70,16 @@ namespace RSS::Private
         void parseAtomArticle(QXmlStreamReader &xml);
         void parseAtomChannel(QXmlStreamReader &xml);
         void addArticle(QVariantHash article);
+        void addKnownArticle(const QString &articleID);
+        bool isParsingArticlesFinished() const;
+        void skipRestOfElement(QXmlStreamReader &xml) const;
 
         QDateTime m_fallbackDate;
         QString m_baseUrl;
         ParsingResult m_result;
         QSet<QString> m_articleIDs;
+        QSet<QString> m_knownArticleIDs;
+        int m_knownArticlesInRow = 0;
     };
 }
 
@@ -31,7 +31,9 @@
 
 #include "rss_session.h"
 
+#include <algorithm>
 #include <chrono>
+#include <vector>
 
 #include <QDebug>
 #include <QJsonDocument>
@@ -65,6 +67,9 @@ Session::Session()
     : m_storeProcessingEnabled(u"RSS/Session/EnableProcessing"_s)
     , m_storeRefreshInterval(u"RSS/Session/RefreshInterval"_s, 30)
     , m_storeFetchDelay(u"RSS/Session/FetchDelay"_s, 2)
+    , m_storeAdaptiveRefreshEnabled(u"RSS/Session/AdaptiveRefresh"_s, false)
+    , m_storeMinRefreshInterval(u"RSS/Session/MinRefreshInterval"_s, 5)
+    , m_storeMaxRefreshInterval(u"RSS/Session/MaxRefreshInterval"_s, 240)
     , m_storeMaxArticlesPerFeed(u"RSS/Session/MaxArticlesPerFeed"_s, 50)
     , m_workingThread(new QThread)
 {
@@ -462,6 +467,7 @@ void Session::addItem(Item *item, Folder *destFolder)
         connect(feed, &Feed::titleChanged, this, &Session::handleFeedTitleChanged);
         connect(feed, &Feed::iconLoaded, this, &Session::feedIconLoaded);
         connect(feed, &Feed::stateChanged, this, &Session::feedStateChanged);
+        connect(feed, &Feed::refreshFinished, this, &Session::handleFeedRefreshFinished);
         connect(feed, &Feed::urlChanged, this, [this, feed](const QString &oldURL)
         {
             if (feed->name() == oldURL)
@@ -554,10 +560,55 @@ void Session::setRefreshInterval(const int refreshInterval)
     if (m_storeRefreshInterval != refreshInterval)
     {
         m_storeRefreshInterval = refreshInterval;
+        m_adaptiveRefreshIntervals.clear();
         m_refreshTimer.start(std::chrono::minutes(m_storeRefreshInterval));
     }
 }
 
+bool Session::isAdaptiveRefreshEnabled() const
+{
+    return m_storeAdaptiveRefreshEnabled;
+}
+
+void Session::setAdaptiveRefreshEnabled(const bool enabled)
+{
+    if (m_storeAdaptiveRefreshEnabled == enabled)
+        return;
+
+    m_storeAdaptiveRefreshEnabled = enabled;
+    m_adaptiveRefreshIntervals.clear();
+}
+
+int Session::minRefreshInterval() const
+{
+    return m_storeMinRefreshInterval;
+}
+
+void Session::setMinRefreshInterval(const int refreshInterval)
+{
+    if (m_storeMinRefreshInterval == refreshInterval)
+        return;
+
+    m_storeMinRefreshInterval = refreshInterval;
+    for (std::chrono::seconds &interval : m_adaptiveRefreshIntervals)
+        interval = boundRefreshInterval(interval);
+}
+
+int Session::maxRefreshInterval() const
+{
+    return m_storeMaxRefreshInterval;
+}
+
+void Session::setMaxRefreshInterval(const int refreshInterval)
+{
+    if (m_storeMaxRefreshInterval == refreshInterval)
+        return;
+
+    m_storeMaxRefreshInterval = refreshInterval;
+    for (std::chrono::seconds &interval : m_adaptiveRefreshIntervals)
+        interval = boundRefreshInterval(interval);
+}
+
 std::chrono::seconds Session::fetchDelay() const
 {
     return std::chrono::seconds(m_storeFetchDelay);
@@ -585,6 +636,7 @@ void Session::handleItemAboutToBeDestroyed(Item *item)
         m_feedsByUID.remove(feed->uid());
         m_feedsByURL.remove(feed->url());
         m_refreshTimepoints.remove(feed);
+        m_adaptiveRefreshIntervals.remove(feed);
     }
 }
 
@@ -649,7 +701,76 @@ void Session::refresh()
 std::chrono::system_clock::time_point Session::refreshFeed(Feed *feed, const std::chrono::system_clock::time_point &currentTimepoint)
 {
     feed->refresh();
+    return currentTimepoint + effectiveRefreshInterval(feed);
+}
+
+std::chrono::seconds Session::effectiveRefreshInterval(Feed *feed) const
+{
     const std::chrono::seconds feedRefreshInterval = feed->refreshInterval();
-    const std::chrono::seconds effectiveRefreshInterval = (feedRefreshInterval > 0s) ? feedRefreshInterval : std::chrono::minutes(refreshInterval());
-    return currentTimepoint + effectiveRefreshInterval;
+    if (feedRefreshInterval > 0s)
+        return feedRefreshInterval;
+
+    const std::chrono::seconds globalRefreshInterval = std::chrono::minutes(refreshInterval());
+    if (!isAdaptiveRefreshEnabled())
+        return globalRefreshInterval;
+
+    return m_adaptiveRefreshIntervals.value(feed, boundRefreshInterval(globalRefreshInterval));
+}
+
+std::chrono::seconds Session::boundRefreshInterval(const std::chrono::seconds refreshInterval) const
+{
+    const std::chrono::seconds minInterval = std::chrono::minutes(std::max(1, minRefreshInterval()));
+    const std::chrono::seconds maxInterval = std::max<std::chrono::seconds>(minInterval, std::chrono::minutes(maxRefreshInterval()));
+    return std::clamp(refreshInterval, minInterval, maxInterval);
+}
+
+void Session::handleFeedRefreshFinished(Feed *feed, const int newArticlesCount)
+{
+    // Feeds with explicitly set refresh interval aren't subject to adaptive scheduling
+    if (!isAdaptiveRefreshEnabled() || (feed->refreshInterval() > 0s))
+        return;
+
+    const std::chrono::seconds currentInterval = effectiveRefreshInterval(feed);
+    std::chrono::seconds newInterval = currentInterval;
+    if (newArticlesCount > 0)
+    {
+        // Estimate publishing cadence as median interval between the recent articles
+        // and poll the feed twice as often as it publishes new articles
+        const QList<Article *> articles = feed->articles();
+        const qsizetype sampleSize = std::min<qsizetype>(articles.size(), 11);
+        std::vector<std::chrono::seconds> gaps;
+        gaps.reserve(sampleSize);
+        for (qsizetype i = 1; i < sampleSize; ++i)
+        {
+            const qint64 gap = articles[i]->date().secsTo(articles[i - 1]->date());
+            if (gap > 0)
+                gaps.emplace_back(gap);
+        }
+
+        if (!gaps.empty())
+        {
+            const auto median = gaps.begin() + (gaps.size() / 2);
+            std::nth_element(gaps.begin(), median, gaps.end());
+            newInterval = *median / 2;
+        }
+        else
+        {
+            newInterval = currentInterval / 2;
+        }
+    }
+    else
+    {
+        // Back off idle feed
+        newInterval = currentInterval * 3 / 2;
+    }
+
+    newInterval = boundRefreshInterval(newInterval);
+    m_adaptiveRefreshIntervals[feed] = newInterval;
+    if (newInterval == currentInterval)
+        return;
+
+    const auto currentTimepoint = std::chrono::system_clock::now();
+    m_refreshTimepoints[feed] = currentTimepoint + newInterval;
+    if (isProcessingEnabled() && (newInterval < currentInterval))
+        refresh();
 }
@@ -114,6 +114,13 @@ namespace RSS
         std::chrono::seconds fetchDelay() const;
         void setFetchDelay(std::chrono::seconds delay);
 
+        bool isAdaptiveRefreshEnabled() const;
+        void setAdaptiveRefreshEnabled(bool enabled);
+        int minRefreshInterval() const;
+        void setMinRefreshInterval(int refreshInterval);
+        int maxRefreshInterval() const;
+        void setMaxRefreshInterval(int refreshInterval);
+
         nonstd::expected<Folder *, QString> addFolder(const QString &path);
         nonstd::expected<Feed *, QString> addFeed(const QString &url, const QString &path, std::chrono::seconds refreshInterval = {});
         nonstd::expected<void, QString> setFeedURL(const QString &path, const QString &url);
@@ -142,6 +149,7 @@ namespace RSS
     private slots:
         void handleItemAboutToBeDestroyed(Item *item);
         void handleFeedTitleChanged(Feed *feed);
+        void handleFeedRefreshFinished(Feed *feed, int newArticlesCount);
 
     private:
         QUuid generateUID() const;
@@ -155,12 +163,17 @@ namespace RSS
         void addItem(Item *item, Folder *destFolder);
         void refresh();
         std::chrono::system_clock::time_point refreshFeed(Feed *feed, const std::chrono::system_clock::time_point &currentTimepoint);
+        std::chrono::seconds effectiveRefreshInterval(Feed *feed) const;
+        std::chrono::seconds boundRefreshInterval(std::chrono::seconds refreshInterval) const;
 
         static QPointer<Session> m_instance;
 
         CachedSettingValue<bool> m_storeProcessingEnabled;
         CachedSettingValue<int> m_storeRefreshInterval;
         CachedSettingValue<qint64> m_storeFetchDelay;
+        CachedSettingValue<bool> m_storeAdaptiveRefreshEnabled;
+        CachedSettingValue<int> m_storeMinRefreshInterval;
+        CachedSettingValue<int> m_storeMaxRefreshInterval;
         CachedSettingValue<int> m_storeMaxArticlesPerFeed;
         Utils::Thread::UniquePtr m_workingThread;
         AsyncFileStorage *m_confFileStorage = nullptr;
@@ -170,5 +183,7 @@ namespace RSS
         QHash<QUuid, Feed *> m_feedsByUID;
         QHash<QString, Feed *> m_feedsByURL;
         QHash<Feed *, std::chrono::system_clock::time_point> m_refreshTimepoints;
+        // refresh intervals learned from feed publishing cadence
+        QHash<Feed *, std::chrono::seconds> m_adaptiveRefreshIntervals;
     };
 }
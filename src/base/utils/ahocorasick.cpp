@@ -0,0 +1,162 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "ahocorasick.h"
+
+#include <queue>
+
+#include <QChar>
+#include <QString>
+#include <QStringView>
+
+Utils::AhoCorasick::AhoCorasick(const QStringList &keywords, const Qt::CaseSensitivity caseSensitivity)
+    : m_nodes(1)
+    , m_keywordsCount {keywords.size()}
+    , m_caseSensitivity {caseSensitivity}
+{
+    // Build the trie
+    for (qsizetype id = 0; id < keywords.size(); ++id)
+    {
+        const QString &keyword = keywords[id];
+        if (keyword.isEmpty())
+            continue;
+
+        int state = 0;
+        for (const QChar ch : keyword)
+        {
+            const char16_t key = normalized(ch.unicode());
+            const auto nextIter = m_nodes[state].next.constFind(key);
+            if (nextIter != m_nodes[state].next.cend())
+            {
+                state = nextIter.value();
+            }
+            else
+            {
+                const int newState = static_cast<int>(m_nodes.size());
+                m_nodes.emplace_back();
+                m_nodes[state].next.insert(key, newState);
+                state = newState;
+            }
+        }
+
+        m_nodes[state].keywordIDs.append(id);
+    }
+
+    // Compute failure links in breadth-first order so that the links of shorter prefixes are ready
+    std::queue<int> queue;
+    for (const int child : m_nodes[0].next)
+        queue.push(child);
+
+    while (!queue.empty())
+    {
+        const int state = queue.front();
+        queue.pop();
+
+        for (auto it = m_nodes[state].next.cbegin(); it != m_nodes[state].next.cend(); ++it)
+        {
+            const int child = it.value();
+            int fail = m_nodes[state].fail;
+            while ((fail != 0) && !m_nodes[fail].next.contains(it.key()))
+                fail = m_nodes[fail].fail;
+            fail = m_nodes[fail].next.value(it.key(), 0);
+
+            m_nodes[child].fail = fail;
+            m_nodes[child].outputLink = m_nodes[fail].keywordIDs.isEmpty() ? m_nodes[fail].outputLink : fail;
+            queue.push(child);
+        }
+    }
+}
+
+qsizetype Utils::AhoCorasick::keywordsCount() const
+{
+    return m_keywordsCount;
+}
+
+QList<qsizetype> Utils::AhoCorasick::findAll(const QStringView text) const
+{
+    QList<qsizetype> result;
+    if (m_nodes.size() == 1)
+        return result;
+
+    std::vector<bool> found(m_keywordsCount, false);
+    int state = 0;
+    for (const QChar ch : text)
+    {
+        state = step(state, ch.unicode());
+        for (int output = (m_nodes[state].keywordIDs.isEmpty() ? m_nodes[state].outputLink : state)
+                ; output >= 0; output = m_nodes[output].outputLink)
+        {
+            for (const qsizetype id : m_nodes[output].keywordIDs)
+            {
+                if (found[id])
+                    continue;
+
+                found[id] = true;
+                result.append(id);
+            }
+        }
+    }
+
+    return result;
+}
+
+bool Utils::AhoCorasick::containsAny(const QStringView text) const
+{
+    if (m_nodes.size() == 1)
+        return false;
+
+    int state = 0;
+    for (const QChar ch : text)
+    {
+        state = step(state, ch.unicode());
+        if (!m_nodes[state].keywordIDs.isEmpty() || (m_nodes[state].outputLink >= 0))
+            return true;
+    }
+
+    return false;
+}
+
+char16_t Utils::AhoCorasick::normalized(const char16_t ch) const
+{
+    return (m_caseSensitivity == Qt::CaseSensitive) ? ch : static_cast<char16_t>(QChar::toCaseFolded(ch));
+}
+
+int Utils::AhoCorasick::step(int state, const char16_t ch) const
+{
+    const char16_t key = normalized(ch);
+    while (true)
+    {
+        const auto nextIter = m_nodes[state].next.constFind(key);
+        if (nextIter != m_nodes[state].next.cend())
+            return nextIter.value();
+        if (state == 0)
+            return 0;
+
+        state = m_nodes[state].fail;
+    }
+}
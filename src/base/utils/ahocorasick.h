@@ -0,0 +1,74 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include <Qt>
+#include <QHash>
+#include <QList>
+#include <QStringList>
+
+class QStringView;
+
+namespace Utils
+{
+    // Aho-Corasick automaton. Finds all the occurrences of a set of keywords in a text
+    // in a single pass, regardless of the number of keywords.
+    // The automaton is immutable once constructed so it can be safely shared between threads.
+    class AhoCorasick
+    {
+    public:
+        // Keyword IDs are the indexes in the given list. Empty keywords are never found.
+        explicit AhoCorasick(const QStringList &keywords = {}, Qt::CaseSensitivity caseSensitivity = Qt::CaseSensitive);
+
+        qsizetype keywordsCount() const;
+
+        // Returns unique IDs of the keywords that occur in the text in order of their first occurrence
+        QList<qsizetype> findAll(QStringView text) const;
+        bool containsAny(QStringView text) const;
+
+    private:
+        struct Node
+        {
+            QHash<char16_t, int> next;
+            int fail = 0;
+            // nearest node reachable by fail links that ends some keyword
+            int outputLink = -1;
+            QList<qsizetype> keywordIDs;
+        };
+
+        char16_t normalized(char16_t ch) const;
+        int step(int state, char16_t ch) const;
+
+        std::vector<Node> m_nodes;
+        qsizetype m_keywordsCount = 0;
+        Qt::CaseSensitivity m_caseSensitivity;
+    };
+}
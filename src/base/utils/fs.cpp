@@ -51,6 +51,22 @@
 #include <unistd.h>
 #endif
 
+#if defined(Q_OS_LINUX)
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <linux/fiemap.h>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#elif defined(Q_OS_MACOS)
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 #include <QCoreApplication>
 #include <QDateTime>
 #include <QDebug>
@@ -65,6 +81,9 @@
 
 namespace
 {
+    // Listing of directory pays off only if a lot of its files are queried
+    const int MIN_LISTED_FILES_COUNT = 32;
+
 #ifdef Q_OS_WIN
     bool isReservedDeviceName(const QStringView name)
     {
@@ -502,3 +521,112 @@ bool Utils::Fs::rmdir(const Path &dirPath)
 {
     return QDir().rmdir(dirPath.data());
 }
+
+nonstd::expected<void, QString> Utils::Fs::preallocateFile(const Path &path, const qint64 size)
+{
+#if defined(Q_OS_LINUX) || defined(Q_OS_MACOS)
+    const int fd = ::open(path.toString().toLocal8Bit().constData(), (O_WRONLY | O_CREAT | O_CLOEXEC), 0666);
+    if (fd < 0)
+        return nonstd::make_unexpected(QString::fromLocal8Bit(::strerror(errno)));
+
+#if defined(Q_OS_LINUX)
+    const bool isAllocated = (::fallocate(fd, FALLOC_FL_KEEP_SIZE, 0, size) == 0);
+#else
+    // space is allocated starting from the physical end of file, so the size is adjusted accordingly
+    struct stat fileStat {};
+    ::fstat(fd, &fileStat);
+    const qint64 allocatedSize = static_cast<qint64>(fileStat.st_blocks) * 512;
+    fstore_t store {F_ALLOCATECONTIG, F_PEOFPOSMODE, 0, std::max<qint64>((size - allocatedSize), 0), 0};
+    bool isAllocated = (store.fst_length == 0) || (::fcntl(fd, F_PREALLOCATE, &store) != -1);
+    if (!isAllocated)
+    {
+        // contiguous space isn't available so try to allocate fragmented one
+        store.fst_flags = F_ALLOCATEALL;
+        isAllocated = (::fcntl(fd, F_PREALLOCATE, &store) != -1);
+    }
+#endif
+    const int errorCode = isAllocated ? 0 : errno;
+    ::close(fd);
+
+    if (!isAllocated)
+        return nonstd::make_unexpected(QString::fromLocal8Bit(::strerror(errorCode)));
+    return {};
+#else
+    Q_UNUSED(path);
+    Q_UNUSED(size);
+    return nonstd::make_unexpected(QCoreApplication::translate("fs", "Preallocation isn't supported"));
+#endif
+}
+
+qint64 Utils::Fs::fileExtentsCount(const Path &path)
+{
+#if defined(Q_OS_LINUX)
+    const int fd = ::open(path.toString().toLocal8Bit().constData(), (O_RDONLY | O_CLOEXEC));
+    if (fd < 0)
+        return -1;
+
+    // no extents are requested so only their number is returned
+    struct fiemap fileMap {};
+    fileMap.fm_start = 0;
+    fileMap.fm_length = FIEMAP_MAX_OFFSET;
+    fileMap.fm_extent_count = 0;
+    const bool isMapped = (::ioctl(fd, FS_IOC_FIEMAP, &fileMap) == 0);
+    ::close(fd);
+
+    return isMapped ? static_cast<qint64>(fileMap.fm_mapped_extents) : -1;
+#else
+    Q_UNUSED(path);
+    return -1;
+#endif
+}
+
+Utils::Fs::FileExistenceChecker::FileExistenceChecker(const PathList &filePaths)
+{
+    QHash<QString, int> filesCounts;
+    for (const Path &filePath : filePaths)
+    {
+        const QString dirPath = filePath.parentPath().data();
+        if (++filesCounts[dirPath] == MIN_LISTED_FILES_COUNT)
+            m_dirListings.insert(dirPath, {});
+    }
+}
+
+bool Utils::Fs::FileExistenceChecker::exists(const Path &filePath)
+{
+    const auto dirIter = m_dirListings.find(filePath.parentPath().data());
+    if (dirIter == m_dirListings.end())
+        return filePath.exists();
+
+    DirListing &dirListing = *dirIter;
+    if (!dirListing.isListed)
+    {
+        dirListing.isListed = true;
+        dirListing.isReadable = QDir(dirIter.key()).isReadable();
+        if (dirListing.isReadable)
+        {
+            QDirIterator iter {dirIter.key(), (QDir::AllEntries | QDir::Hidden | QDir::System | QDir::NoDotAndDotDot)};
+            while (iter.hasNext())
+            {
+                iter.next();
+                const QString fileName = iter.fileName();
+                dirListing.fileNames.insert(fileName);
+                dirListing.foldedFileNames.insert(fileName.normalized(QString::NormalizationForm_C).toCaseFolded());
+            }
+        }
+    }
+
+    // Files of the directory that can't be listed may still be accessible
+    if (!dirListing.isReadable)
+        return filePath.exists();
+
+    const QString fileName = filePath.filename();
+    if (dirListing.fileNames.contains(fileName))
+        return true;
+
+    // The name may differ in letter case or Unicode normalization form from the existing one
+    // which is still the same file on case insensitive (or normalization insensitive) file systems
+    if (dirListing.foldedFileNames.contains(fileName.normalized(QString::NormalizationForm_C).toCaseFolded()))
+        return filePath.exists();
+
+    return false;
+}
@@ -33,6 +33,8 @@
  * Utility functions related to file system.
  */
 
+#include <QHash>
+#include <QSet>
 #include <QString>
 
 #include "base/3rdparty/expected.hpp"
@@ -70,6 +72,33 @@ namespace Utils::Fs
     void removeDirRecursively(const Path &path);
     bool smartRemoveEmptyFolderTree(const Path &path);
 
+    // Allocates disk space for the file without changing its size, the file is created if it doesn't exist.
+    // It isn't supported on every platform and file system.
+    nonstd::expected<void, QString> preallocateFile(const Path &path, qint64 size);
+    // Returns the number of extents the file data is stored in or -1 if it is unknown
+    qint64 fileExtentsCount(const Path &path);
+
     Path homePath();
     Path tempPath();
+
+    // Checks if the files exist. The directories that contain a lot of the files to be queried
+    // are listed once instead of querying each of their files separately.
+    class FileExistenceChecker
+    {
+    public:
+        explicit FileExistenceChecker(const PathList &filePaths);
+
+        bool exists(const Path &filePath);
+
+    private:
+        struct DirListing
+        {
+            bool isListed = false;
+            bool isReadable = false;
+            QSet<QString> fileNames;
+            QSet<QString> foldedFileNames;
+        };
+
+        QHash<QString, DirListing> m_dirListings;
+    };
 }
@@ -131,6 +131,17 @@ namespace
 #endif
         DISK_QUEUE_SIZE,
 #ifdef QBT_USES_LIBTORRENT2
+        READ_CACHE_SIZE,
+        DISK_IO_JOBS_LIMIT,
+        DISK_IO_READING_JOBS_LIMIT,
+        DISK_IO_WRITING_JOBS_LIMIT,
+        DISK_IO_HASHING_JOBS_LIMIT,
+        DISK_IO_MOVING_JOBS_LIMIT,
+#if defined(Q_OS_LINUX) || defined(Q_OS_MACOS)
+        PREALLOCATION_MIN_FILE_SIZE,
+        PREALLOCATION_PATHS,
+#endif
+        FILE_EXTENTS_STATS,
         DISK_IO_TYPE,
 #endif
         DISK_IO_READ_MODE,
@@ -245,6 +256,24 @@ void AdvancedSettings::saveAdvancedSettings() const
     // Disk queue size
     session->setDiskQueueSize(m_spinBoxDiskQueueSize.value() * 1024);
 #ifdef QBT_USES_LIBTORRENT2
+    // Read cache size
+    session->setReadCacheSize(m_spinBoxReadCacheSize.value());
+    // Disk IO jobs limits
+    session->setDiskIOJobsLimit(m_spinBoxDiskIOJobsLimit.value());
+    session->setDiskIOReadingJobsLimit(m_spinBoxDiskIOReadingJobsLimit.value());
+    session->setDiskIOWritingJobsLimit(m_spinBoxDiskIOWritingJobsLimit.value());
+    session->setDiskIOHashingJobsLimit(m_spinBoxDiskIOHashingJobsLimit.value());
+    session->setDiskIOMovingJobsLimit(m_spinBoxDiskIOMovingJobsLimit.value());
+#if defined(Q_OS_LINUX) || defined(Q_OS_MACOS)
+    // Selective preallocation
+    session->setPreallocationMinFileSize(m_spinBoxPreallocationMinFileSize.value());
+    PathList preallocationPaths;
+    for (const QString &path : asConst(m_lineEditPreallocationPaths.text().split(u';', Qt::SkipEmptyParts)))
+        preallocationPaths.append(Path(path.trimmed()));
+    session->setPreallocationPaths(preallocationPaths);
+#endif
+    // File extents statistics
+    session->setFileExtentsStatsEnabled(m_checkBoxFileExtentsStats.isChecked());
     session->setDiskIOType(m_comboBoxDiskIOType.currentData().value<BitTorrent::DiskIOType>());
 #endif
     // Disk IO read mode
@@ -609,6 +638,64 @@ void AdvancedSettings::loadAdvancedSettings()
     addRow(DISK_QUEUE_SIZE, (tr("Disk queue size") + u' ' + makeLink(u"https://www.libtorrent.org/reference-Settings.html#max_queued_disk_bytes", u"(?)"))
             , &m_spinBoxDiskQueueSize);
 #ifdef QBT_USES_LIBTORRENT2
+    // Read cache size
+    m_spinBoxReadCacheSize.setMinimum(0);
+#ifdef QBT_APP_64BIT
+    m_spinBoxReadCacheSize.setMaximum(33554431);  // 32768GiB
+#else
+    m_spinBoxReadCacheSize.setMaximum(1536);
+#endif
+    m_spinBoxReadCacheSize.setValue(session->readCacheSize());
+    m_spinBoxReadCacheSize.setSpecialValueText(tr("Disabled"));
+    m_spinBoxReadCacheSize.setSuffix(tr(" MiB"));
+    addRow(READ_CACHE_SIZE, tr("Piece read cache size"), &m_spinBoxReadCacheSize);
+    // Disk IO jobs limits
+    m_spinBoxDiskIOJobsLimit.setMinimum(0);
+    m_spinBoxDiskIOJobsLimit.setMaximum(std::numeric_limits<int>::max());
+    m_spinBoxDiskIOJobsLimit.setValue(session->diskIOJobsLimit());
+    m_spinBoxDiskIOJobsLimit.setSpecialValueText(tr("Unlimited"));
+    addRow(DISK_IO_JOBS_LIMIT, tr("Outstanding disk IO jobs limit"), &m_spinBoxDiskIOJobsLimit);
+    m_spinBoxDiskIOReadingJobsLimit.setMinimum(0);
+    m_spinBoxDiskIOReadingJobsLimit.setMaximum(std::numeric_limits<int>::max());
+    m_spinBoxDiskIOReadingJobsLimit.setValue(session->diskIOReadingJobsLimit());
+    m_spinBoxDiskIOReadingJobsLimit.setSpecialValueText(tr("Unlimited"));
+    addRow(DISK_IO_READING_JOBS_LIMIT, tr("Outstanding disk IO reading jobs limit"), &m_spinBoxDiskIOReadingJobsLimit);
+    m_spinBoxDiskIOWritingJobsLimit.setMinimum(0);
+    m_spinBoxDiskIOWritingJobsLimit.setMaximum(std::numeric_limits<int>::max());
+    m_spinBoxDiskIOWritingJobsLimit.setValue(session->diskIOWritingJobsLimit());
+    m_spinBoxDiskIOWritingJobsLimit.setSpecialValueText(tr("Unlimited"));
+    addRow(DISK_IO_WRITING_JOBS_LIMIT, tr("Outstanding disk IO writing jobs limit"), &m_spinBoxDiskIOWritingJobsLimit);
+    m_spinBoxDiskIOHashingJobsLimit.setMinimum(0);
+    m_spinBoxDiskIOHashingJobsLimit.setMaximum(std::numeric_limits<int>::max());
+    m_spinBoxDiskIOHashingJobsLimit.setValue(session->diskIOHashingJobsLimit());
+    m_spinBoxDiskIOHashingJobsLimit.setSpecialValueText(tr("Unlimited"));
+    addRow(DISK_IO_HASHING_JOBS_LIMIT, tr("Outstanding disk IO hashing jobs limit"), &m_spinBoxDiskIOHashingJobsLimit);
+    m_spinBoxDiskIOMovingJobsLimit.setMinimum(0);
+    m_spinBoxDiskIOMovingJobsLimit.setMaximum(std::numeric_limits<int>::max());
+    m_spinBoxDiskIOMovingJobsLimit.setValue(session->diskIOMovingJobsLimit());
+    m_spinBoxDiskIOMovingJobsLimit.setSpecialValueText(tr("Unlimited"));
+    addRow(DISK_IO_MOVING_JOBS_LIMIT, tr("Outstanding disk IO moving jobs limit"), &m_spinBoxDiskIOMovingJobsLimit);
+#if defined(Q_OS_LINUX) || defined(Q_OS_MACOS)
+    // Selective preallocation
+    m_spinBoxPreallocationMinFileSize.setMinimum(0);
+    m_spinBoxPreallocationMinFileSize.setMaximum(std::numeric_limits<int>::max());
+    m_spinBoxPreallocationMinFileSize.setValue(session->preallocationMinFileSize());
+    m_spinBoxPreallocationMinFileSize.setSpecialValueText(tr("Any size"));
+    m_spinBoxPreallocationMinFileSize.setSuffix(tr(" MiB"));
+    m_spinBoxPreallocationMinFileSize.setToolTip(tr("If all files aren't preallocated, preallocate the files of at least this size."));
+    addRow(PREALLOCATION_MIN_FILE_SIZE, tr("Minimum size of selectively preallocated files"), &m_spinBoxPreallocationMinFileSize);
+    QStringList preallocationPaths;
+    for (const Path &path : asConst(session->preallocationPaths()))
+        preallocationPaths.append(path.toString());
+    m_lineEditPreallocationPaths.setText(preallocationPaths.join(u';'));
+    m_lineEditPreallocationPaths.setPlaceholderText(tr("Any path"));
+    m_lineEditPreallocationPaths.setToolTip(tr("If all files aren't preallocated, preallocate the files of the torrents saved in these folders. Use ';' to split multiple entries."));
+    addRow(PREALLOCATION_PATHS, tr("Save paths of selectively preallocated files"), &m_lineEditPreallocationPaths);
+#endif
+    // File extents statistics
+    m_checkBoxFileExtentsStats.setChecked(session->isFileExtentsStatsEnabled());
+    m_checkBoxFileExtentsStats.setToolTip(tr("Count the extents of torrent files when they are checked or released. It requires to access all the files, so it can slow down the startup."));
+    addRow(FILE_EXTENTS_STATS, tr("Collect file extents statistics (Linux only)"), &m_checkBoxFileExtentsStats);
     // Disk IO type
     m_comboBoxDiskIOType.addItem(tr("Default"), QVariant::fromValue(BitTorrent::DiskIOType::Default));
     m_comboBoxDiskIOType.addItem(tr("Memory mapped files"), QVariant::fromValue(BitTorrent::DiskIOType::MMap));
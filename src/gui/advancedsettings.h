@@ -92,7 +92,14 @@ private:
     QCheckBox m_checkBoxCoalesceRW;
 #else
     QComboBox m_comboBoxDiskIOType;
-    QSpinBox m_spinBoxHashingThreads;
+    QSpinBox m_spinBoxHashingThreads, m_spinBoxReadCacheSize, m_spinBoxDiskIOJobsLimit, m_spinBoxDiskIOReadingJobsLimit, m_spinBoxDiskIOWritingJobsLimit,
+             m_spinBoxDiskIOHashingJobsLimit, m_spinBoxDiskIOMovingJobsLimit;
+    QCheckBox m_checkBoxFileExtentsStats;
+#endif
+
+#if defined(QBT_USES_LIBTORRENT2) && (defined(Q_OS_LINUX) || defined(Q_OS_MACOS))
+    QSpinBox m_spinBoxPreallocationMinFileSize;
+    QLineEdit m_lineEditPreallocationPaths;
 #endif
 
 #if defined(QBT_USES_LIBTORRENT2) && !defined(Q_OS_LINUX) && !defined(Q_OS_MACOS)
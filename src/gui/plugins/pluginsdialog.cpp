@@ -37,8 +37,10 @@
 #include <QMessageBox>
 #include <QMimeData>
 #include <QSignalBlocker>
+#include <QTimer>
 
 #include "base/path.h"
+#include "base/utils/misc.h"
 #include "gui/autoexpandabledialog.h"
 #include "gui/uithememanager.h"
 #include "gui/utils.h"
@@ -46,19 +48,36 @@
 
 #define SETTINGS_KEY(name) u"PluginsDialog/" name
 
+using namespace std::chrono_literals;
+
+const std::chrono::milliseconds STATISTICS_REFRESH_INTERVAL = 2s;
+
 enum PluginColumns
 {
     PLUGIN_ID,
     PLUGIN_NAME,
     PLUGIN_VERSION,
     PLUGIN_INVOCABLE,
-    PLUGIN_STATE
+    PLUGIN_STATE,
+    PLUGIN_CALLS,
+    PLUGIN_TIME,
+    PLUGIN_MEMORY
 };
 
+namespace
+{
+    QString formatTime(const std::chrono::nanoseconds time)
+    {
+        const auto msecs = std::chrono::duration<double, std::milli>(time).count();
+        return PluginsDialog::tr("%1 ms", "e.g.: 12.5 ms").arg(msecs, 0, 'f', 1);
+    }
+}
+
 PluginsDialog::PluginsDialog(PluginsEngine *pluginsEngine, QWidget *parent)
     : QDialog(parent)
     , m_ui {new Ui::PluginsDialog}
     , m_pluginsEngine {pluginsEngine}
+    , m_statisticsRefreshTimer {new QTimer(this)}
     , m_storeDialogSize {SETTINGS_KEY(u"Size"_s)}
     , m_storeHeaderState {SETTINGS_KEY(u"HeaderState"_s)}
     , m_storeLastPath {SETTINGS_KEY(u"LastUsedPath"_s)}
@@ -89,6 +108,9 @@ PluginsDialog::PluginsDialog(PluginsEngine *pluginsEngine, QWidget *parent)
     connect(m_pluginsEngine, &PluginsEngine::pluginUninstallationFailed, this, &PluginsDialog::pluginUninstallationFailed);
     connect(m_pluginsEngine, &PluginsEngine::pluginEnabledChanged, this, &PluginsDialog::pluginEnabledChanged);
 
+    connect(m_statisticsRefreshTimer, &QTimer::timeout, this, &PluginsDialog::refreshStatistics);
+    m_statisticsRefreshTimer->start(STATISTICS_REFRESH_INTERVAL);
+
     if (const QSize dialogSize = m_storeDialogSize; dialogSize.isValid())
         resize(dialogSize);
 
@@ -141,7 +163,7 @@ void PluginsDialog::onActionInstallTriggered()
 {
     const QStringList pathsList = QFileDialog::getOpenFileNames(
             nullptr, tr("Select plugins"), m_storeLastPath.get(QDir::homePath())
-            , (tr("qBittorrent plugin") + u" (*.lua)"));
+            , (tr("qBittorrent plugin") + u" (*.lua *.luac)"));
 
     for (const QString &pathStr : pathsList)
         installPlugin(Path(pathStr));
@@ -250,6 +272,38 @@ void PluginsDialog::loadPlugins()
         addNewPlugin(pluginInfo);
 }
 
+void PluginsDialog::refreshStatistics()
+{
+    for (int i = 0; i < m_ui->pluginsTree->topLevelItemCount(); ++i)
+        updatePluginStatistics(m_ui->pluginsTree->topLevelItem(i));
+}
+
+void PluginsDialog::updatePluginStatistics(QTreeWidgetItem *item)
+{
+    const auto statistics = m_pluginsEngine->pluginStatistics(item->text(PLUGIN_ID));
+    if (!statistics)
+        return;
+
+    item->setText(PLUGIN_CALLS, QString::number(statistics->callCount));
+    item->setText(PLUGIN_TIME, formatTime(statistics->totalTime));
+    item->setText(PLUGIN_MEMORY, Utils::Misc::friendlyUnit(statistics->heapSize));
+
+    QStringList handlersInfo;
+    handlersInfo.reserve(statistics->handlers.size());
+    for (const auto &[handlerName, handlerStatistics] : statistics->handlers.asKeyValueRange())
+    {
+        handlersInfo.append(tr("%1: calls: %2, total: %3, peak: %4")
+                .arg(handlerName, QString::number(handlerStatistics.callCount)
+                        , formatTime(handlerStatistics.totalTime), formatTime(handlerStatistics.peakTime)));
+    }
+    handlersInfo.sort();
+
+    const QString handlersToolTip = handlersInfo.join(u'\n');
+    item->setToolTip(PLUGIN_CALLS, handlersToolTip);
+    item->setToolTip(PLUGIN_TIME, handlersToolTip);
+    item->setToolTip(PLUGIN_MEMORY, tr("Peak: %1").arg(Utils::Misc::friendlyUnit(statistics->peakHeapSize)));
+}
+
 void PluginsDialog::addNewPlugin(const PluginInfo &pluginInfo)
 {
     auto *item = new QTreeWidgetItem(m_ui->pluginsTree);
@@ -269,6 +323,7 @@ void PluginsDialog::addNewPlugin(const PluginInfo &pluginInfo)
     }
 
     item->setText(PLUGIN_VERSION, pluginInfo.version.toString());
+    updatePluginStatistics(item);
 }
 
 void PluginsDialog::updatePlugin(const PluginInfo &pluginInfo)
@@ -280,10 +335,22 @@ void PluginsDialog::updatePlugin(const PluginInfo &pluginInfo)
     item->setText(PLUGIN_NAME, pluginInfo.name);
     item->setText(PLUGIN_INVOCABLE, (pluginInfo.invocable ? tr("Yes") : tr("No")));
     item->setText(PLUGIN_VERSION, pluginInfo.version.toString());
+    updatePluginStatistics(item);
 }
 
 void PluginsDialog::installPlugin(const Path &pluginPath)
 {
+    // Bytecode isn't verified by Lua so precompiled plugin can do anything native code can do
+    if (pluginPath.hasExtension(u".luac"_s))
+    {
+        const QString message = tr("Plugin '%1' is precompiled. Its code can't be verified, so it may get unrestricted access to your system."
+                " Install it only if you trust its source. Do you want to install it?").arg(pluginPath.filename());
+        const QMessageBox::StandardButton button = QMessageBox::warning(
+            this, tr("Plugin install"), message, (QMessageBox::Yes | QMessageBox::No), QMessageBox::No);
+        if (button != QMessageBox::Yes)
+            return;
+    }
+
     if (m_pluginsEngine->installPlugin(pluginPath))
     {
         startAsyncOp();
@@ -35,6 +35,7 @@
 #include "base/settingvalue.h"
 
 class QDropEvent;
+class QTimer;
 class QTreeWidgetItem;
 
 namespace Net
@@ -83,6 +84,8 @@ private slots:
 
 private:
     void loadPlugins();
+    void refreshStatistics();
+    void updatePluginStatistics(QTreeWidgetItem *item);
     void addNewPlugin(const PluginInfo &pluginInfo);
     void updatePlugin(const PluginInfo &pluginInfo);
     void installPlugin(const Path &pluginPath);
@@ -91,6 +94,7 @@ private:
 
     Ui::PluginsDialog *m_ui = nullptr;
     PluginsEngine *m_pluginsEngine = nullptr;
+    QTimer *m_statisticsRefreshTimer = nullptr;
 
     SettingValue<QSize> m_storeDialogSize;
     SettingValue<QByteArray> m_storeHeaderState;
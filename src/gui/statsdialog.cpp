@@ -50,8 +50,10 @@ StatsDialog::StatsDialog(QWidget *parent)
     m_ui->setupUi(this);
 
 #ifdef QBT_USES_LIBTORRENT2
-    m_ui->labelCacheHitsText->hide();
-    m_ui->labelCacheHits->hide();
+    // Cache hits are reported only by our own piece read cache
+    const bool isReadCacheEnabled = (BitTorrent::Session::instance()->readCacheSize() > 0);
+    m_ui->labelCacheHitsText->setVisible(isReadCacheEnabled);
+    m_ui->labelCacheHits->setVisible(isReadCacheEnabled);
 #endif
 
     connect(m_ui->buttonBox, &QDialogButtonBox::clicked, this, &StatsDialog::close);
@@ -87,13 +89,11 @@ void StatsDialog::update()
                 ((atd > 0) && (atu > 0))
                 ? Utils::String::fromDouble(static_cast<qreal>(atu) / atd, 2)
                 : u"-"_s);
-#ifndef QBT_USES_LIBTORRENT2
     // Cache hits
     const qreal readRatio = cs.readRatio;
     m_ui->labelCacheHits->setText(u"%1%"_s.arg((readRatio > 0)
         ? Utils::String::fromDouble((100 * readRatio), 2)
         : u"0"_s));
-#endif
     // Buffers size
     m_ui->labelTotalBuf->setText(Utils::Misc::friendlyUnit(cs.totalUsedBuffers * 16 * 1024));
 
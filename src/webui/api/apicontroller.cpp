@@ -32,6 +32,7 @@
 
 #include <QHash>
 #include <QJsonDocument>
+#include <QJsonObject>
 #include <QList>
 #include <QMetaObject>
 #include <QScopeGuard>
@@ -112,6 +113,14 @@ void APIController::setResult(const Path &filePath)
     m_result = StreamFileAPIResult {.filePath = filePath};
 }
 
+void APIController::setResult(const QFuture<QJsonObject> &result)
+{
+    m_result = DeferredAPIResult {.future = result.then([](const QJsonObject &resultObj)
+    {
+        return RegularAPIResult {.data = QJsonDocument(resultObj)};
+    })};
+}
+
 void APIController::setStatus(const APIStatus status)
 {
     Q_ASSERT(std::holds_alternative<RegularAPIResult>(m_result));
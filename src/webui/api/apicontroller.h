@@ -31,6 +31,7 @@
 #include <variant>
 
 #include <QtContainerFwd>
+#include <QFuture>
 #include <QObject>
 #include <QString>
 #include <QVariant>
@@ -55,7 +56,13 @@ struct StreamFileAPIResult
     Path filePath;
 };
 
-using APIResult = std::variant<RegularAPIResult, StreamFileAPIResult>;
+// The result that becomes available later (e.g. it is computed in another thread)
+struct DeferredAPIResult
+{
+    QFuture<RegularAPIResult> future;
+};
+
+using APIResult = std::variant<RegularAPIResult, StreamFileAPIResult, DeferredAPIResult>;
 
 class APIController : public ApplicationComponent<QObject>
 {
@@ -77,6 +84,7 @@ protected:
     void setResult(const QJsonObject &result);
     void setResult(const QByteArray &result, const QString &mimeType = {}, const QString &filename = {});
     void setResult(const Path &filePath);
+    void setResult(const QFuture<QJsonObject> &result);
 
     void setStatus(APIStatus status);
 
@@ -383,11 +383,15 @@ void AppController::preferencesAction()
     // RSS settings
     data[u"rss_refresh_interval"_s] = RSS::Session::instance()->refreshInterval();
     data[u"rss_fetch_delay"_s] = static_cast<qlonglong>(RSS::Session::instance()->fetchDelay().count());
+    data[u"rss_adaptive_refresh_enabled"_s] = RSS::Session::instance()->isAdaptiveRefreshEnabled();
+    data[u"rss_min_refresh_interval"_s] = RSS::Session::instance()->minRefreshInterval();
+    data[u"rss_max_refresh_interval"_s] = RSS::Session::instance()->maxRefreshInterval();
     data[u"rss_max_articles_per_feed"_s] = RSS::Session::instance()->maxArticlesPerFeed();
     data[u"rss_processing_enabled"_s] = RSS::Session::instance()->isProcessingEnabled();
     data[u"rss_auto_downloading_enabled"_s] = RSS::AutoDownloader::instance()->isProcessingEnabled();
     data[u"rss_download_repack_proper_episodes"_s] = RSS::AutoDownloader::instance()->downloadRepacks();
     data[u"rss_smart_episode_filters"_s] = RSS::AutoDownloader::instance()->smartEpisodeFilters().join(u'\n');
+    data[u"rss_max_previously_matched_episodes"_s] = RSS::AutoDownloader::instance()->maxPreviouslyMatchedEpisodes();
 
     // Advanced settings
     // qBitorrent preferences
@@ -452,6 +456,22 @@ void AppController::preferencesAction()
     data[u"disk_cache_ttl"_s] = session->diskCacheTTL();
     // Disk queue size
     data[u"disk_queue_size"_s] = session->diskQueueSize();
+    // Read cache size
+    data[u"read_cache_size"_s] = session->readCacheSize();
+    // Disk IO jobs limits
+    data[u"disk_io_jobs_limit"_s] = session->diskIOJobsLimit();
+    data[u"disk_io_reading_jobs_limit"_s] = session->diskIOReadingJobsLimit();
+    data[u"disk_io_writing_jobs_limit"_s] = session->diskIOWritingJobsLimit();
+    data[u"disk_io_hashing_jobs_limit"_s] = session->diskIOHashingJobsLimit();
+    data[u"disk_io_moving_jobs_limit"_s] = session->diskIOMovingJobsLimit();
+    // Selective preallocation
+    data[u"preallocation_min_file_size"_s] = session->preallocationMinFileSize();
+    QStringList preallocationPathsStringList;
+    for (const Path &path : asConst(session->preallocationPaths()))
+        preallocationPathsStringList << path.toString();
+    data[u"preallocation_paths"_s] = preallocationPathsStringList.join(u'\n');
+    // File extents statistics
+    data[u"file_extents_stats_enabled"_s] = session->isFileExtentsStatsEnabled();
     // Disk IO Type
     data[u"disk_io_type"_s] = static_cast<int>(session->diskIOType());
     // Disk IO read mode
@@ -999,6 +1019,12 @@ void AppController::setPreferencesAction()
         RSS::Session::instance()->setRefreshInterval(it.value().toInt());
     if (hasKey(u"rss_fetch_delay"_s))
         RSS::Session::instance()->setFetchDelay(std::chrono::seconds(it.value().toLongLong()));
+    if (hasKey(u"rss_adaptive_refresh_enabled"_s))
+        RSS::Session::instance()->setAdaptiveRefreshEnabled(it.value().toBool());
+    if (hasKey(u"rss_min_refresh_interval"_s))
+        RSS::Session::instance()->setMinRefreshInterval(it.value().toInt());
+    if (hasKey(u"rss_max_refresh_interval"_s))
+        RSS::Session::instance()->setMaxRefreshInterval(it.value().toInt());
     if (hasKey(u"rss_max_articles_per_feed"_s))
         RSS::Session::instance()->setMaxArticlesPerFeed(it.value().toInt());
     if (hasKey(u"rss_processing_enabled"_s))
@@ -1009,6 +1035,8 @@ void AppController::setPreferencesAction()
         RSS::AutoDownloader::instance()->setDownloadRepacks(it.value().toBool());
     if (hasKey(u"rss_smart_episode_filters"_s))
         RSS::AutoDownloader::instance()->setSmartEpisodeFilters(it.value().toString().split(u'\n'));
+    if (hasKey(u"rss_max_previously_matched_episodes"_s))
+        RSS::AutoDownloader::instance()->setMaxPreviouslyMatchedEpisodes(it.value().toInt());
 
     // Advanced settings
     // qBittorrent preferences
@@ -1117,6 +1145,33 @@ void AppController::setPreferencesAction()
     // Disk queue size
     if (hasKey(u"disk_queue_size"_s))
         session->setDiskQueueSize(it.value().toLongLong());
+    // Read cache size
+    if (hasKey(u"read_cache_size"_s))
+        session->setReadCacheSize(it.value().toInt());
+    // Disk IO jobs limits
+    if (hasKey(u"disk_io_jobs_limit"_s))
+        session->setDiskIOJobsLimit(it.value().toInt());
+    if (hasKey(u"disk_io_reading_jobs_limit"_s))
+        session->setDiskIOReadingJobsLimit(it.value().toInt());
+    if (hasKey(u"disk_io_writing_jobs_limit"_s))
+        session->setDiskIOWritingJobsLimit(it.value().toInt());
+    if (hasKey(u"disk_io_hashing_jobs_limit"_s))
+        session->setDiskIOHashingJobsLimit(it.value().toInt());
+    if (hasKey(u"disk_io_moving_jobs_limit"_s))
+        session->setDiskIOMovingJobsLimit(it.value().toInt());
+    // Selective preallocation
+    if (hasKey(u"preallocation_min_file_size"_s))
+        session->setPreallocationMinFileSize(it.value().toInt());
+    if (hasKey(u"preallocation_paths"_s))
+    {
+        PathList preallocationPaths;
+        for (const QString &path : asConst(it.value().toString().split(u'\n', Qt::SkipEmptyParts)))
+            preallocationPaths.append(Path(path.trimmed()));
+        session->setPreallocationPaths(preallocationPaths);
+    }
+    // File extents statistics
+    if (hasKey(u"file_extents_stats_enabled"_s))
+        session->setFileExtentsStatsEnabled(it.value().toBool());
     // Disk IO Type
     if (hasKey(u"disk_io_type"_s))
         session->setDiskIOType(static_cast<BitTorrent::DiskIOType>(it.value().toInt()));
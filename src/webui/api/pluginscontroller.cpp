@@ -0,0 +1,112 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "pluginscontroller.h"
+
+#include <chrono>
+
+#include <QJsonArray>
+#include <QJsonObject>
+
+#include "base/global.h"
+#include "base/plugins/pluginsengine.h"
+
+const QString KEY_PLUGIN_ID = u"id"_s;
+const QString KEY_PLUGIN_NAME = u"name"_s;
+const QString KEY_PLUGIN_ENABLED = u"enabled"_s;
+const QString KEY_PLUGIN_CALL_COUNT = u"callCount"_s;
+const QString KEY_PLUGIN_TOTAL_TIME = u"totalTime"_s;
+const QString KEY_PLUGIN_PEAK_TIME = u"peakTime"_s;
+const QString KEY_PLUGIN_HEAP_SIZE = u"heapSize"_s;
+const QString KEY_PLUGIN_PEAK_HEAP_SIZE = u"peakHeapSize"_s;
+const QString KEY_PLUGIN_HANDLERS = u"handlers"_s;
+
+namespace
+{
+    qint64 toMicroseconds(const std::chrono::nanoseconds time)
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(time).count();
+    }
+}
+
+// Returns the statistics of the installed plugins in JSON format.
+// The return value is an array of dictionaries.
+// The dictionary keys are:
+//   - "id": plugin ID
+//   - "name": plugin name
+//   - "enabled": whether plugin is enabled
+//   - "callCount": total number of handler calls
+//   - "totalTime": total time spent in handlers (microseconds)
+//   - "peakTime": longest single handler call (microseconds)
+//   - "heapSize": current Lua heap size (bytes)
+//   - "peakHeapSize": peak Lua heap size (bytes)
+//   - "handlers": dictionary of per-handler statistics keyed by handler name,
+//                 each having "callCount", "totalTime" and "peakTime" fields
+void PluginsController::statisticsAction()
+{
+    QJsonArray pluginsList;
+
+    // Plugins engine is initialized only after BitTorrent session is restored
+    const PluginsEngine *pluginsEngine = PluginsEngine::instance();
+    if (!pluginsEngine)
+    {
+        setResult(pluginsList);
+        return;
+    }
+
+    for (const PluginInfo &pluginInfo : asConst(pluginsEngine->allPlugins()))
+    {
+        const auto statistics = pluginsEngine->pluginStatistics(pluginInfo.id);
+        if (!statistics)
+            continue;
+
+        QJsonObject handlers;
+        for (const auto &[handlerName, handlerStatistics] : statistics->handlers.asKeyValueRange())
+        {
+            handlers[handlerName] = QJsonObject {
+                {KEY_PLUGIN_CALL_COUNT, handlerStatistics.callCount},
+                {KEY_PLUGIN_TOTAL_TIME, toMicroseconds(handlerStatistics.totalTime)},
+                {KEY_PLUGIN_PEAK_TIME, toMicroseconds(handlerStatistics.peakTime)}
+            };
+        }
+
+        pluginsList.append(QJsonObject {
+            {KEY_PLUGIN_ID, pluginInfo.id},
+            {KEY_PLUGIN_NAME, pluginInfo.name},
+            {KEY_PLUGIN_ENABLED, pluginInfo.enabled},
+            {KEY_PLUGIN_CALL_COUNT, statistics->callCount},
+            {KEY_PLUGIN_TOTAL_TIME, toMicroseconds(statistics->totalTime)},
+            {KEY_PLUGIN_PEAK_TIME, toMicroseconds(statistics->peakTime)},
+            {KEY_PLUGIN_HEAP_SIZE, statistics->heapSize},
+            {KEY_PLUGIN_PEAK_HEAP_SIZE, statistics->peakHeapSize},
+            {KEY_PLUGIN_HANDLERS, handlers}
+        });
+    }
+
+    setResult(pluginsList);
+}
@@ -28,6 +28,7 @@
 
 #include "rsscontroller.h"
 
+#include <QFuture>
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
@@ -256,3 +257,33 @@ void RSSController::matchingArticlesAction()
 
     setResult(jsonObj);
 }
+
+void RSSController::dryRunRulesAction()
+{
+    const QFuture<QJsonObject> result = RSS::AutoDownloader::instance()->dryRunRules()
+        .then([](const QList<RSS::RuleDryRunResult> &results)
+    {
+        QJsonObject jsonObj;
+        for (const RSS::RuleDryRunResult &result : results)
+        {
+            QJsonObject matchedArticles;
+            qsizetype matchedArticlesCount = 0;
+            for (auto it = result.matchedArticles.cbegin(); it != result.matchedArticles.cend(); ++it)
+            {
+                matchedArticles.insert(it.key(), QJsonArray::fromStringList(it.value()));
+                matchedArticlesCount += it.value().size();
+            }
+
+            jsonObj.insert(result.ruleName, QJsonObject {
+                {u"evaluatedArticlesCount"_s, result.evaluatedArticlesCount},
+                {u"matchedArticlesCount"_s, matchedArticlesCount},
+                {u"evaluationTime"_s, result.evaluationTime},
+                {u"matchedArticles"_s, matchedArticles}
+            });
+        }
+
+        return jsonObj;
+    });
+
+    setResult(result);
+}
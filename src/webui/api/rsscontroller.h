@@ -54,4 +54,5 @@ private slots:
     void cloneRuleAction();
     void rulesAction();
     void matchingArticlesAction();
+    void dryRunRulesAction();
 };
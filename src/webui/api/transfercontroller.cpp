@@ -28,9 +28,13 @@
 
 #include "transfercontroller.h"
 
+#include <QHash>
+#include <QJsonArray>
 #include <QJsonObject>
 #include <QList>
 
+#include "base/bittorrent/diskiostats.h"
+#include "base/bittorrent/infohash.h"
 #include "base/bittorrent/peeraddress.h"
 #include "base/bittorrent/peerinfo.h"
 #include "base/bittorrent/session.h"
@@ -54,6 +58,17 @@ const QString KEY_TRANSFER_DL_LIMIT = u"dl_limit"_s;
 const QString KEY_TRANSFER_ALT_UP_LIMIT = u"alt_up_limit"_s;
 const QString KEY_TRANSFER_ALT_DL_LIMIT = u"alt_dl_limit"_s;
 
+namespace
+{
+    QJsonArray toJsonArray(const BitTorrent::DiskIOLatencyHistogram &histogram)
+    {
+        QJsonArray jsonArray;
+        for (const qint64 count : histogram)
+            jsonArray.append(count);
+        return jsonArray;
+    }
+}
+
 // Returns the global transfer information in JSON format.
 // The return value is a JSON-formatted dictionary.
 // The dictionary keys are:
@@ -190,3 +205,39 @@ void TransferController::banPeersAction()
 
     setResult(QString());
 }
+
+// Returns disk I/O statistics of the torrents in JSON format.
+// The return value is a JSON-formatted dictionary where keys are torrent hashes.
+// Each value is a dictionary with the following keys:
+//   - "read_bytes", "written_bytes": amount of data read/written since torrent is loaded
+//   - "read_count", "write_count", "hash_count": number of completed operations
+//   - "pending_count": number of submitted but not completed operations
+//   - "read_latency", "write_latency", "hash_latency": number of operations by latency,
+//     bucket bounds are 0.1, 1, 10, 100 and 1000 milliseconds
+//   - "file_extents_count", "fragmented_files_count": number of extents of the torrent files
+//     and number of files having more than one extent (-1 if unknown or not collected)
+void TransferController::diskIOStatsAction()
+{
+    const QHash<BitTorrent::TorrentID, BitTorrent::DiskIOStats> diskIOStats = BitTorrent::Session::instance()->diskIOStats();
+
+    QJsonObject dict;
+    for (auto it = diskIOStats.cbegin(); it != diskIOStats.cend(); ++it)
+    {
+        const BitTorrent::DiskIOStats &stats = it.value();
+        dict[it.key().toString()] = QJsonObject {
+            {u"read_bytes"_s, stats.readBytes},
+            {u"written_bytes"_s, stats.writtenBytes},
+            {u"read_count"_s, stats.readCount},
+            {u"write_count"_s, stats.writeCount},
+            {u"hash_count"_s, stats.hashCount},
+            {u"pending_count"_s, stats.pendingCount},
+            {u"read_latency"_s, toJsonArray(stats.readLatency)},
+            {u"write_latency"_s, toJsonArray(stats.writeLatency)},
+            {u"hash_latency"_s, toJsonArray(stats.hashLatency)},
+            {u"file_extents_count"_s, stats.fileExtentsCount},
+            {u"fragmented_files_count"_s, stats.fragmentedFilesCount}
+        };
+    }
+
+    setResult(dict);
+}
@@ -50,4 +50,5 @@ private slots:
     void getSpeedLimitsAction();
     void setSpeedLimitsAction();
     void banPeersAction();
+    void diskIOStatsAction();
 };
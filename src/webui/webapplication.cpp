@@ -63,6 +63,9 @@
 #include "api/authcontroller.h"
 #include "api/clientdatacontroller.h"
 #include "api/logcontroller.h"
+#ifdef ENABLE_PLUGINS
+#include "api/pluginscontroller.h"
+#endif
 #include "api/rsscontroller.h"
 #include "api/searchcontroller.h"
 #include "api/synccontroller.h"
@@ -167,6 +170,48 @@ namespace
 
         return languages.join(u'\n');
     }
+
+    void fillAPIResponse(Http::Response &response, const RegularAPIResult &result)
+    {
+        if (result.data.isNull())
+        {
+            response.status = {.code = 204};
+        }
+        else
+        {
+            switch (result.status)
+            {
+            case APIStatus::Async:
+                response.status = {.code = 202};
+                break;
+            case APIStatus::Ok:
+                response.status = {.code = 200};
+                break;
+            }
+
+            switch (result.data.userType())
+            {
+            case QMetaType::QJsonDocument:
+                response.headers.insert(Http::HEADER_CONTENT_TYPE, Http::CONTENT_TYPE_JSON);
+                response.content = result.data.toJsonDocument().toJson(QJsonDocument::Compact);
+                break;
+            case QMetaType::QByteArray:
+                {
+                    const auto resultData = result.data.toByteArray();
+                    response.headers.insert(Http::HEADER_CONTENT_TYPE, (!result.mimeType.isEmpty() ? result.mimeType : Http::CONTENT_TYPE_TXT));
+                    if (!result.filename.isEmpty())
+                        response.headers.insert(Http::HEADER_CONTENT_DISPOSITION, u"attachment; filename=\"%1\""_s.arg(result.filename));
+                    response.content = resultData;
+                }
+                break;
+            case QMetaType::QString:
+            default:
+                response.headers.insert(Http::HEADER_CONTENT_TYPE, Http::CONTENT_TYPE_TXT);
+                response.content = result.data.toString().toUtf8();
+                break;
+            }
+        }
+    }
 }
 
 WebApplication::WebApplication(IApplication *app, QObject *parent)
@@ -400,46 +445,27 @@ void WebApplication::processAPIRequest(const QString &endpoint, const Http::Head
             response.headers.insert(Http::HEADER_SET_COOKIE, QString::fromLatin1(cookie.toRawForm()));
         }
 
-        const auto result = std::get<RegularAPIResult>(apiResult);
-        if (result.data.isNull())
-        {
-            response.status = {.code = 204};
-        }
-        else
+        if (std::holds_alternative<DeferredAPIResult>(apiResult))
         {
-            switch (result.status)
-            {
-            case APIStatus::Async:
-                response.status = {.code = 202};
-                break;
-            case APIStatus::Ok:
-                response.status = {.code = 200};
-                break;
-            }
-
-            switch (result.data.userType())
-            {
-            case QMetaType::QJsonDocument:
-                response.headers.insert(Http::HEADER_CONTENT_TYPE, Http::CONTENT_TYPE_JSON);
-                response.content = result.data.toJsonDocument().toJson(QJsonDocument::Compact);
-                break;
-            case QMetaType::QByteArray:
+            // Response writer is destroyed along with the connection so the continuation is canceled in that case
+            std::get<DeferredAPIResult>(apiResult).future
+                .then(&responseWriter, [&responseWriter, response](const RegularAPIResult &result) mutable
                 {
-                    const auto resultData = result.data.toByteArray();
-                    response.headers.insert(Http::HEADER_CONTENT_TYPE, (!result.mimeType.isEmpty() ? result.mimeType : Http::CONTENT_TYPE_TXT));
-                    if (!result.filename.isEmpty())
-                        response.headers.insert(Http::HEADER_CONTENT_DISPOSITION, u"attachment; filename=\"%1\""_s.arg(result.filename));
-                    response.content = resultData;
-                }
-                break;
-            case QMetaType::QString:
-            default:
-                response.headers.insert(Http::HEADER_CONTENT_TYPE, Http::CONTENT_TYPE_TXT);
-                response.content = result.data.toString().toUtf8();
-                break;
-            }
+                    fillAPIResponse(response, result);
+                    responseWriter.setResponse(response);
+                })
+                .onCanceled(&responseWriter, [&responseWriter, commonHeaders]
+                {
+                    const InternalServerErrorHTTPError error;
+                    Http::Response response {.status = error.status(), .headers = commonHeaders};
+                    response.headers.insert(Http::HEADER_CONTENT_TYPE, Http::CONTENT_TYPE_TXT);
+                    response.content = error.status().text.toUtf8();
+                    responseWriter.setResponse(response);
+                });
+            return;
         }
 
+        fillAPIResponse(response, std::get<RegularAPIResult>(apiResult));
         responseWriter.setResponse(response);
     }
     catch (const APIError &error)
@@ -914,6 +940,9 @@ void WebApplication::sessionStartImpl(const QString &sessionId, const WebSession
 
     m_currentSession->registerAPIController(u"app"_s, [app = app(), parent = m_currentSession] { return new AppController(app, parent); });
     m_currentSession->registerAPIController(u"log"_s, [app = app(), parent = m_currentSession] { return new LogController(app, parent); });
+#ifdef ENABLE_PLUGINS
+    m_currentSession->registerAPIController(u"plugins"_s, [app = app(), parent = m_currentSession] { return new PluginsController(app, parent); });
+#endif
     m_currentSession->registerAPIController(u"rss"_s, [app = app(), parent = m_currentSession] { return new RSSController(app, parent); });
     m_currentSession->registerAPIController(u"torrents"_s, [app = app(), parent = m_currentSession] { return new TorrentsController(app, parent); });
     m_currentSession->registerAPIController(u"transfer"_s, [app = app(), parent = m_currentSession] { return new TransferController(app, parent); });
@@ -58,7 +58,7 @@
 using namespace std::chrono_literals;
 using namespace Qt::Literals::StringLiterals;
 
-inline const Utils::Version<3, 2> API_VERSION {2, 16, 1};
+inline const Utils::Version<3, 2> API_VERSION {2, 17, 0};
 
 class QNetworkCookie;
 
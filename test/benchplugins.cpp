@@ -0,0 +1,214 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include <memory>
+#include <vector>
+
+#include <QDateTime>
+#include <QDir>
+#include <QObject>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include "base/global.h"
+#include "base/logger.h"
+#include "base/path.h"
+#include "base/plugins/plugin.h"
+#include "base/plugins/pluginsengine.h"
+#include "base/profile.h"
+#include "base/tag.h"
+#include "base/utils/fs.h"
+#include "mocktorrent.h"
+
+namespace
+{
+    Path testPluginsPath()
+    {
+        return Path(QString::fromUtf8(__FILE__)).parentPath() / Path(u"testdata/plugins"_s);
+    }
+}
+
+// Measures the cost of calling plugin event handlers and accessing
+// torrent properties from Lua against a synthetic set of torrents.
+// The events are delivered through PluginsEngine so that its dispatching is measured as well.
+// Run it with `cmake --build <build> --target benchmark`.
+class BenchPlugins final : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(BenchPlugins)
+
+public:
+    BenchPlugins() = default;
+
+private slots:
+    void initTestCase()
+    {
+        QVERIFY(m_profileDir.isValid());
+        Profile::initInstance(Path(m_profileDir.path()), {}, false);
+        Logger::initInstance();
+
+        // plugins engine loads the plugins installed in the profile
+        const Path pluginsPath = specialFolderLocation(SpecialFolder::Data) / Path(u"plugins"_s);
+        QVERIFY(Utils::Fs::mkpath(pluginsPath));
+        for (const QString &fileName : QDir(testPluginsPath().data()).entryList({u"*.lua"_s}, QDir::Files))
+            QVERIFY(Utils::Fs::copyFile((testPluginsPath() / Path(fileName)), (pluginsPath / Path(fileName))));
+
+        PluginsEngine::initInstance();
+
+        const int torrentsCount = 5000;
+        m_torrents.reserve(torrentsCount);
+        m_torrentPtrs.reserve(torrentsCount);
+        for (int i = 0; i < torrentsCount; ++i)
+        {
+            auto torrent = std::make_unique<MockTorrent>(MockTorrent::Data {
+                .name = u"Torrent %1"_s.arg(i),
+                .category = ((i % 3) == 0) ? QString() : u"category%1"_s.arg(i % 10),
+                .tags = {Tag(u"tag%1"_s.arg(i % 5)), Tag(u"tag%1"_s.arg(i % 7))},
+                .savePath = Path(u"/downloads/%1"_s.arg(i % 10)),
+                .totalSize = (static_cast<qlonglong>(i) + 1) * 1024 * 1024 * 1024,
+                .progress = (i % 4) / 4.0,
+                .uploadPayloadRate = i * 10,
+                .downloadPayloadRate = i * 20,
+                .addedTime = QDateTime::currentDateTime()
+            });
+            m_torrentPtrs.append(torrent.get());
+            m_torrents.push_back(std::move(torrent));
+        }
+    }
+
+    void cleanupTestCase()
+    {
+        PluginsEngine::freeInstance();
+        Logger::freeInstance();
+        Profile::freeInstance();
+    }
+
+    void benchTorrentsUpdatedEvent_data() const
+    {
+        QTest::addColumn<int>("torrentsCount");
+
+        QTest::newRow("100 torrents") << 100;
+        QTest::newRow("1000 torrents") << 1000;
+        QTest::newRow("5000 torrents") << 5000;
+    }
+
+    void benchTorrentsUpdatedEvent() const
+    {
+        QFETCH(const int, torrentsCount);
+
+        enablePlugin(u"EventHandlers"_s);
+        const QList<BitTorrent::Torrent *> torrents = m_torrentPtrs.first(torrentsCount);
+
+        QBENCHMARK
+        {
+            PluginsEngine::instance()->deliverEvent("onTorrentsUpdated", torrents);
+        }
+    }
+
+    void benchSingleTorrentEvent() const
+    {
+        enablePlugin(u"EventHandlers"_s);
+        BitTorrent::Torrent *torrent = m_torrentPtrs.first();
+
+        QBENCHMARK
+        {
+            PluginsEngine::instance()->deliverEvent("onTorrentAdded", torrent);
+        }
+    }
+
+    void benchPropertyAccess_data() const
+    {
+        QTest::addColumn<QString>("propertyName");
+
+        for (const QString &propertyName : {u"id"_s, u"name"_s, u"category"_s, u"tags"_s, u"savePath"_s
+                , u"progress"_s, u"totalSize"_s, u"addedTime"_s, u"shareLimits"_s, u"trackerStatuses"_s})
+        {
+            QTest::newRow(propertyName.toLatin1().constData()) << propertyName;
+        }
+    }
+
+    // Measures accessing the property of 1000 torrents from Lua, so the plugin function
+    // is called directly since it isn't an event handler
+    void benchPropertyAccess() const
+    {
+        QFETCH(const QString, propertyName);
+
+        auto loadResult = Plugin::load(testPluginsPath() / Path(u"PropertyAccess.lua"_s));
+        QVERIFY2(loadResult.has_value(), qUtf8Printable(loadResult.error()));
+
+        const std::shared_ptr<Plugin> plugin = loadResult.value();
+        const QList<BitTorrent::Torrent *> torrents = m_torrentPtrs.first(1000);
+        const QByteArray propertyNameUtf8 = propertyName.toUtf8();
+
+        QBENCHMARK
+        {
+            plugin->call("accessProperty", torrents, propertyNameUtf8.constData());
+        }
+    }
+
+    void benchMemoryGrowth_data() const
+    {
+        QTest::addColumn<QString>("pluginID");
+
+        QTest::newRow("stateless") << u"EventHandlers"_s;
+        QTest::newRow("stateful") << u"StatefulHandlers"_s;
+    }
+
+    // Reports the growth of Lua heap after delivering 100 events of all the torrents
+    void benchMemoryGrowth() const
+    {
+        QFETCH(const QString, pluginID);
+
+        enablePlugin(pluginID);
+        const qint64 initialHeapSize = PluginsEngine::instance()->pluginStatistics(pluginID)->heapSize;
+
+        for (int i = 0; i < 100; ++i)
+            PluginsEngine::instance()->deliverEvent("onTorrentsUpdated", m_torrentPtrs);
+
+        const qint64 heapSize = PluginsEngine::instance()->pluginStatistics(pluginID)->heapSize;
+        QTest::setBenchmarkResult((heapSize - initialHeapSize), QTest::BytesAllocated);
+    }
+
+private:
+    // Only the benchmarked plugin handles the events
+    void enablePlugin(const QString &pluginID) const
+    {
+        PluginsEngine *engine = PluginsEngine::instance();
+        QVERIFY(engine->pluginInfo(pluginID).has_value());
+        const QList<QString> pluginIDs = engine->allPlugins().keys();
+        for (const QString &id : pluginIDs)
+            engine->setPluginEnabled(id, (id == pluginID));
+    }
+
+    QTemporaryDir m_profileDir;
+    std::vector<std::unique_ptr<MockTorrent>> m_torrents;
+    QList<BitTorrent::Torrent *> m_torrentPtrs;
+};
+
+QTEST_GUILESS_MAIN(BenchPlugins)
+#include "benchplugins.moc"
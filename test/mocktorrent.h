@@ -0,0 +1,232 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <utility>
+
+#include <QBitArray>
+#include <QDateTime>
+#include <QFuture>
+#include <QList>
+#include <QString>
+#include <QUrl>
+
+#include "base/bittorrent/downloadpriority.h"
+#include "base/bittorrent/infohash.h"
+#include "base/bittorrent/peeraddress.h"
+#include "base/bittorrent/peerinfo.h"
+#include "base/bittorrent/sslparameters.h"
+#include "base/bittorrent/torrent.h"
+#include "base/bittorrent/torrentinfo.h"
+#include "base/bittorrent/trackerentry.h"
+#include "base/bittorrent/trackerentrystatus.h"
+#include "base/path.h"
+#include "base/tag.h"
+#include "base/tagset.h"
+
+// Minimal in-memory implementation of BitTorrent::Torrent
+// intended to feed the code under test with synthetic torrents.
+class MockTorrent final : public BitTorrent::Torrent
+{
+public:
+    struct Data
+    {
+        BitTorrent::InfoHash infoHash;
+        QString name;
+        QString category;
+        TagSet tags;
+        Path savePath;
+        qlonglong totalSize = 0;
+        qreal progress = 0;
+        int uploadPayloadRate = 0;
+        int downloadPayloadRate = 0;
+        QDateTime addedTime;
+    };
+
+    explicit MockTorrent(Data data, QObject *parent = nullptr)
+        : BitTorrent::Torrent(parent)
+        , m_data {std::move(data)}
+    {
+    }
+
+    // Properties backed by the mock data
+    bool hasMetadata() const override { return true; }
+    int filesCount() const override { return 1; }
+    BitTorrent::Session *session() const override { return nullptr; }
+    BitTorrent::InfoHash infoHash() const override { return m_data.infoHash; }
+    QString name() const override { return m_data.name; }
+    void setName(const QString &name) override { m_data.name = name; }
+    QString category() const override { return m_data.category; }
+    bool belongsToCategory(const QString &category) const override { return m_data.category == category; }
+    bool setCategory(const QString &category) override { m_data.category = category; return true; }
+    TagSet tags() const override { return m_data.tags; }
+    bool hasTag(const Tag &tag) const override { return m_data.tags.contains(tag); }
+    bool addTag(const Tag &tag) override { return m_data.tags.insert(tag).second; }
+    bool removeTag(const Tag &tag) override { return m_data.tags.remove(tag); }
+    void clearTags() override { m_data.tags.clear(); }
+    Path savePath() const override { return m_data.savePath; }
+    void setSavePath(const Path &savePath) override { m_data.savePath = savePath; }
+    qlonglong totalSize() const override { return m_data.totalSize; }
+    qlonglong wantedSize() const override { return m_data.totalSize; }
+    qlonglong pieceLength() const override { return 4 * 1024 * 1024; }
+    int piecesCount() const override { return static_cast<int>(m_data.totalSize / pieceLength()); }
+    qreal progress() const override { return m_data.progress; }
+    QDateTime addedTime() const override { return m_data.addedTime; }
+    int uploadPayloadRate() const override { return m_data.uploadPayloadRate; }
+    int downloadPayloadRate() const override { return m_data.downloadPayloadRate; }
+    qreal realRatio() const override { return 0; }
+    int queuePosition() const override { return -1; }
+    QString currentTracker() const override { return {}; }
+    QList<BitTorrent::TrackerEntryStatus> trackers() const override { return {}; }
+    const BitTorrent::ShareLimits &shareLimits() const override { return m_shareLimits; }
+    void setShareLimits(BitTorrent::ShareLimits shareLimits) override { m_shareLimits = shareLimits; }
+    BitTorrent::ShareLimits effectiveShareLimits() const override { return m_shareLimits; }
+    BitTorrent::TorrentState state() const override
+    {
+        if (m_isStopped)
+            return (m_data.progress < 1) ? BitTorrent::TorrentState::StoppedDownloading : BitTorrent::TorrentState::StoppedUploading;
+        return (m_data.progress < 1) ? BitTorrent::TorrentState::Downloading : BitTorrent::TorrentState::Uploading;
+    }
+    bool isStopped() const override { return m_isStopped; }
+    void stop() override { m_isStopped = true; }
+    void start(BitTorrent::TorrentOperatingMode) override { m_isStopped = false; }
+
+    // Everything else is irrelevant for the mock
+    Path filePath(int) const override { return {}; }
+    qlonglong fileSize(int) const override { return {}; }
+    Path actualStorageLocation() const override { return {}; }
+    Path actualFilePath(int) const override { return {}; }
+    QList<BitTorrent::DownloadPriority> filePriorities() const override { return {}; }
+    QList<qreal> filesProgress() const override { return {}; }
+    QFuture<QList<qreal>> fetchAvailableFileFractions() const override { return {}; }
+    void renameFile(int, const Path &) override {}
+    void prioritizeFiles(const QList<BitTorrent::DownloadPriority> &) override {}
+    void flushCache() const override {}
+    void doRenameFolder(const Path &, const Path &) override {}
+    QDateTime creationDate() const override { return {}; }
+    QString creator() const override { return {}; }
+    QString comment() const override { return {}; }
+    void setComment(const QString &) override {}
+    bool isPrivate() const override { return {}; }
+    qlonglong completedSize() const override { return {}; }
+    qlonglong wastedSize() const override { return {}; }
+    bool isAutoTMMEnabled() const override { return {}; }
+    void setAutoTMMEnabled(bool) override {}
+    Path downloadPath() const override { return {}; }
+    void setDownloadPath(const Path &) override {}
+    Path rootPath() const override { return {}; }
+    Path contentPath() const override { return {}; }
+    int piecesHave() const override { return {}; }
+    QDateTime completedTime() const override { return {}; }
+    QDateTime lastSeenComplete() const override { return {}; }
+    qlonglong activeTime() const override { return {}; }
+    qlonglong finishedTime() const override { return {}; }
+    qlonglong timeSinceUpload() const override { return {}; }
+    qlonglong timeSinceDownload() const override { return {}; }
+    qlonglong timeSinceActivity() const override { return {}; }
+    PathList filePaths() const override { return {}; }
+    PathList actualFilePaths() const override { return {}; }
+    BitTorrent::TorrentInfo info() const override { return {}; }
+    bool isFinished() const override { return {}; }
+    bool isQueued() const override { return {}; }
+    bool isForced() const override { return {}; }
+    bool isChecking() const override { return {}; }
+    bool isDownloading() const override { return {}; }
+    bool isMoving() const override { return {}; }
+    bool isUploading() const override { return {}; }
+    bool isCompleted() const override { return {}; }
+    bool isActive() const override { return {}; }
+    bool isInactive() const override { return {}; }
+    bool isErrored() const override { return {}; }
+    bool isSequentialDownload() const override { return {}; }
+    bool hasFirstLastPiecePriority() const override { return {}; }
+    bool hasMissingFiles() const override { return {}; }
+    bool hasError() const override { return {}; }
+    QList<QUrl> urlSeeds() const override { return {}; }
+    QString error() const override { return {}; }
+    qlonglong totalDownload() const override { return {}; }
+    qlonglong totalUpload() const override { return {}; }
+    qlonglong eta() const override { return {}; }
+    int seedsCount() const override { return {}; }
+    int peersCount() const override { return {}; }
+    int leechsCount() const override { return {}; }
+    int totalSeedsCount() const override { return {}; }
+    int totalPeersCount() const override { return {}; }
+    int totalLeechersCount() const override { return {}; }
+    int downloadLimit() const override { return {}; }
+    int uploadLimit() const override { return {}; }
+    bool superSeeding() const override { return {}; }
+    bool isDHTDisabled() const override { return {}; }
+    bool isPEXDisabled() const override { return {}; }
+    bool isLSDDisabled() const override { return {}; }
+    QBitArray pieces() const override { return {}; }
+    qreal distributedCopies() const override { return {}; }
+    qreal popularity() const override { return {}; }
+    qlonglong totalPayloadUpload() const override { return {}; }
+    qlonglong totalPayloadDownload() const override { return {}; }
+    int connectionsCount() const override { return {}; }
+    int connectionsLimit() const override { return {}; }
+    qlonglong nextAnnounce() const override { return {}; }
+    BitTorrent::TorrentAnnounceStatus announceStatus() const override { return {}; }
+    void setSequentialDownload(bool) override {}
+    void setFirstLastPiecePriority(bool) override {}
+    void forceReannounce(int) override {}
+    void forceDHTAnnounce() override {}
+    void forceRecheck() override {}
+    void setUploadLimit(int) override {}
+    void setDownloadLimit(int) override {}
+    void setSuperSeeding(bool) override {}
+    void setDHTDisabled(bool) override {}
+    void setPEXDisabled(bool) override {}
+    void setLSDDisabled(bool) override {}
+    void addTrackers(QList<BitTorrent::TrackerEntry>) override {}
+    void removeTrackers(const QStringList &) override {}
+    void replaceTrackers(QList<BitTorrent::TrackerEntry>) override {}
+    void addUrlSeeds(const QList<QUrl> &) override {}
+    void removeUrlSeeds(const QList<QUrl> &) override {}
+    bool connectPeer(const BitTorrent::PeerAddress &) override { return {}; }
+    void clearPeers() override {}
+    void setMetadata(const BitTorrent::TorrentInfo &) override {}
+    StopCondition stopCondition() const override { return {}; }
+    void setStopCondition(StopCondition) override {}
+    BitTorrent::SSLParameters getSSLParameters() const override { return {}; }
+    void setSSLParameters(const BitTorrent::SSLParameters &) override {}
+    QString createMagnetURI() const override { return {}; }
+    nonstd::expected<QByteArray, QString> exportToBuffer() const override { return {}; }
+    nonstd::expected<void, QString> exportToFile(const Path &) const override { return {}; }
+    QFuture<QList<BitTorrent::PeerInfo>> fetchPeerInfo() const override { return {}; }
+    QFuture<QList<QUrl>> fetchURLSeeds() const override { return {}; }
+    QFuture<QList<int>> fetchPieceAvailability() const override { return {}; }
+    QFuture<QBitArray> fetchDownloadingPieces() const override { return {}; }
+
+private:
+    Data m_data;
+    BitTorrent::ShareLimits m_shareLimits;
+    bool m_isStopped = false;
+};
@@ -0,0 +1,186 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include <string_view>
+#include <vector>
+
+#include <libtorrent/bencode.hpp>
+#include <libtorrent/create_torrent.hpp>
+#include <libtorrent/entry.hpp>
+#include <libtorrent/version.hpp>
+
+#include <QByteArray>
+#include <QFile>
+#include <QList>
+#include <QObject>
+#include <QStringList>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include "base/bittorrent/lttypecast.h"
+#include "base/bittorrent/piecehasher.h"
+#include "base/global.h"
+#include "base/path.h"
+#include "base/utils/fs.h"
+
+Q_DECLARE_METATYPE(lt::create_flags_t)
+
+namespace
+{
+    const int PIECE_SIZE = 64 * 1024;
+
+    void writeFile(const Path &filePath, const qint64 size)
+    {
+        QByteArray data {size, Qt::Uninitialized};
+        for (qint64 i = 0; i < size; ++i)
+            data[i] = static_cast<char>((i * 31) % 251);
+
+        Utils::Fs::mkpath(filePath.parentPath());
+        QFile file {filePath.data()};
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        QCOMPARE(file.write(data), size);
+    }
+
+    lt::create_torrent makeTorrent(const Path &sourcePath, [[maybe_unused]] const lt::create_flags_t flags)
+    {
+#if LIBTORRENT_VERSION_NUM >= 20100
+        return lt::create_torrent(lt::list_files(sourcePath.toString().toStdString(), [](std::string_view) { return true; }), PIECE_SIZE, flags);
+#else
+        lt::file_storage files;
+        lt::add_files(files, sourcePath.toString().toStdString());
+#ifdef QBT_USES_LIBTORRENT2
+        return lt::create_torrent(files, PIECE_SIZE, flags);
+#else
+        return lt::create_torrent(files, PIECE_SIZE, -1, flags);
+#endif
+#endif
+    }
+
+    QByteArray hashedData(const lt::create_torrent &torrent)
+    {
+        lt::entry entry = torrent.generate();
+        lt::entry result;
+        result["info"] = entry["info"];
+#ifdef QBT_USES_LIBTORRENT2
+        if (entry.find_key("piece layers"))
+            result["piece layers"] = entry["piece layers"];
+#endif
+
+        std::vector<char> buffer;
+        lt::bencode(std::back_inserter(buffer), result);
+        return {buffer.data(), static_cast<qsizetype>(buffer.size())};
+    }
+}
+
+class TestBittorrentPieceHasher final : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(TestBittorrentPieceHasher)
+
+public:
+    TestBittorrentPieceHasher() = default;
+
+private slots:
+    void testHashPieces_data() const
+    {
+        QTest::addColumn<lt::create_flags_t>("flags");
+        QTest::addColumn<QStringList>("fileNames");
+        QTest::addColumn<QList<qint64>>("fileSizes");
+
+        // files that are smaller than a block, than a piece and that span several pieces
+        const QStringList smallFileNames {u"a.bin"_s, u"b.bin"_s, u"sub/c.bin"_s, u"sub/d.bin"_s};
+        const QList<qint64> smallFileSizes {10, ((PIECE_SIZE / 2) + 123), ((PIECE_SIZE * 5) + 4567), (PIECE_SIZE * 2)};
+        // files that span several read chunks (4 MiB) so that chunks end inside files
+        // and pieces (of v1 torrents) cross the boundaries of files within chunks
+        const QStringList largeFileNames {u"a.bin"_s, u"sub/b.bin"_s, u"sub/c.bin"_s};
+        const QList<qint64> largeFileSizes {((5 * 1024 * 1024) + 123), 4567, ((9 * 1024 * 1024) + (PIECE_SIZE / 3))};
+
+        const auto addRows = [&](const char *name, const lt::create_flags_t flags)
+        {
+            QTest::addRow("%s, small files", name) << flags << smallFileNames << smallFileSizes;
+            QTest::addRow("%s, several chunks", name) << flags << largeFileNames << largeFileSizes;
+        };
+
+#ifdef QBT_USES_LIBTORRENT2
+        addRows("v1", lt::create_torrent::v1_only);
+        addRows("v2", lt::create_torrent::v2_only);
+        addRows("hybrid", lt::create_flags_t {});
+#else
+        addRows("v1", lt::create_flags_t {});
+        addRows("v1 aligned", lt::create_torrent::optimize_alignment);
+#endif
+    }
+
+    void testHashPieces() const
+    {
+        QFETCH(const lt::create_flags_t, flags);
+        QFETCH(const QStringList, fileNames);
+        QFETCH(const QList<qint64>, fileSizes);
+
+        const QTemporaryDir tempDir;
+        QVERIFY(tempDir.isValid());
+
+        const Path basePath {tempDir.path()};
+        const Path sourcePath = basePath / Path(u"content"_s);
+        for (qsizetype i = 0; i < fileNames.size(); ++i)
+            writeFile(sourcePath / Path(fileNames[i]), fileSizes[i]);
+
+        lt::create_torrent expectedTorrent = makeTorrent(sourcePath, flags);
+        lt::set_piece_hashes(expectedTorrent, basePath.toString().toStdString());
+
+        // the pieces are hashed in two passes so that chunks are split by the gaps
+        // between non-consecutive pieces as well (e.g. when hashing is resumed)
+        lt::create_torrent torrent = makeTorrent(sourcePath, flags);
+        std::vector<lt::piece_index_t> evenPieces;
+        std::vector<lt::piece_index_t> remainingPieces;
+        for (const lt::piece_index_t piece : torrent.piece_range())
+        {
+            const int pieceIndex = BitTorrent::LT::toUnderlyingType(piece);
+            const bool isEven = ((pieceIndex % 2) == 0);
+            const bool isInFirstHalf = (pieceIndex < (torrent.num_pieces() / 2));
+            ((isEven && isInFirstHalf) ? evenPieces : remainingPieces).push_back(piece);
+        }
+
+        const BitTorrent::PieceHasher pieceHasher {torrent, basePath, 3};
+        int hashedPiecesCount = 0;
+        const auto resultHandler = [&torrent, &hashedPiecesCount](const BitTorrent::PieceHashes &hashes)
+        {
+            BitTorrent::PieceHasher::setPieceHashes(torrent, hashes);
+            ++hashedPiecesCount;
+        };
+        pieceHasher.hashPieces(evenPieces, resultHandler, [] {});
+        QCOMPARE(hashedPiecesCount, static_cast<int>(evenPieces.size()));
+        pieceHasher.hashPieces(remainingPieces, resultHandler, [] {});
+
+        QCOMPARE(hashedPiecesCount, torrent.num_pieces());
+        QCOMPARE(hashedData(torrent), hashedData(expectedTorrent));
+    }
+};
+
+QTEST_APPLESS_MAIN(TestBittorrentPieceHasher)
+#include "testbittorrentpiecehasher.moc"
@@ -0,0 +1,17 @@
+NAME = "Benchmark Event Handlers"
+VERSION = "1.0"
+
+-- Typical "inspect every updated torrent" handler
+function onTorrentsUpdated(torrents)
+    local activeCount = 0
+    for _, torrent in ipairs(torrents) do
+        if torrent.progress < 1 and torrent.category ~= "" and #torrent.tags > 0 then
+            activeCount = activeCount + 1
+        end
+    end
+    return activeCount
+end
+
+function onTorrentAdded(torrent)
+    return torrent.name
+end
@@ -0,0 +1,10 @@
+NAME = "Benchmark Property Access"
+VERSION = "1.0"
+
+function accessProperty(torrents, propertyName)
+    local value
+    for _, torrent in ipairs(torrents) do
+        value = torrent[propertyName]
+    end
+    return value
+end
@@ -0,0 +1,17 @@
+NAME = "Benchmark Stateful Handlers"
+VERSION = "1.0"
+
+-- Keeps per-torrent history like e.g. speed tracking plugins do
+local history = {}
+
+function onTorrentsUpdated(torrents)
+    for _, torrent in ipairs(torrents) do
+        local entry = history[torrent.name]
+        if entry == nil then
+            entry = {samples = 0, lastProgress = 0}
+            history[torrent.name] = entry
+        end
+        entry.samples = entry.samples + 1
+        entry.lastProgress = torrent.progress
+    end
+end
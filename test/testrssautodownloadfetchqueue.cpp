@@ -0,0 +1,237 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include <chrono>
+#include <optional>
+
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QTest>
+
+#include "base/bittorrent/addtorrentparams.h"
+#include "base/global.h"
+#include "base/rss/autodownload_fetchqueue.h"
+
+using namespace std::chrono_literals;
+
+namespace
+{
+    using Status = RSS::Private::WaitingJob::Status;
+
+    const int MAX_ATTEMPTS = 3;
+    const int MAX_FETCHES_PER_HOST = 2;
+    const std::chrono::seconds RETRY_DELAY = 60s;
+    const std::chrono::steady_clock::time_point START_TIME = std::chrono::steady_clock::now();
+
+    RSS::Private::ProcessingJob processingJob(const QString &feedURL)
+    {
+        return {.feedURL = feedURL, .articleData = {}};
+    }
+}
+
+class TestRSSAutoDownloadFetchQueue final : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(TestRSSAutoDownloadFetchQueue)
+
+public:
+    TestRSSAutoDownloadFetchQueue() = default;
+
+private slots:
+    void testAdd() const
+    {
+        RSS::Private::FetchQueue queue {MAX_ATTEMPTS, RETRY_DELAY, MAX_FETCHES_PER_HOST};
+        QVERIFY(queue.add(u"http://a/1.torrent"_s, processingJob(u"feed1"_s), {}));
+        QVERIFY(queue.add(u"http://a/2.torrent"_s, processingJob(u"feed1"_s), {}));
+        QVERIFY(queue.contains(u"http://a/1.torrent"_s));
+
+        // the same torrent accepted from another feed
+        QVERIFY(!queue.add(u"http://a/1.torrent"_s, processingJob(u"feed2"_s), {}));
+        QCOMPARE(queue.job(u"http://a/1.torrent"_s)->job.feedURL, u"feed1"_s);
+
+        QVERIFY(queue.job(u"http://a/1.torrent"_s)->status == Status::Queued);
+        QVERIFY(queue.nextAttemptTime() == std::chrono::steady_clock::time_point());
+        QCOMPARE(queue.takeReady(START_TIME), QList<QString>({u"http://a/1.torrent"_s, u"http://a/2.torrent"_s}));
+        QVERIFY(queue.job(u"http://a/1.torrent"_s)->status == Status::Fetching);
+        QCOMPARE(queue.job(u"http://a/1.torrent"_s)->attempts, 1);
+        QVERIFY(!queue.nextAttemptTime());
+        QVERIFY(queue.takeReady(START_TIME).isEmpty());
+
+        // the same torrent is not fetched again while it is waiting
+        QVERIFY(!queue.add(u"http://a/1.torrent"_s, processingJob(u"feed2"_s), {}));
+        QVERIFY(queue.takeReady(START_TIME).isEmpty());
+    }
+
+    void testTorrentAdded() const
+    {
+        RSS::Private::FetchQueue queue {MAX_ATTEMPTS, RETRY_DELAY, MAX_FETCHES_PER_HOST};
+        QVERIFY(!queue.take(u"http://a/1.torrent"_s));
+
+        queue.add(u"http://a/1.torrent"_s, processingJob(u"feed1"_s), {});
+        queue.add(u"http://a/2.torrent"_s, processingJob(u"feed1"_s), {});
+        QCOMPARE(queue.takeReady(START_TIME), QList<QString>({u"http://a/1.torrent"_s, u"http://a/2.torrent"_s}));
+
+        const std::optional<RSS::Private::WaitingJob> waitingJob = queue.take(u"http://a/1.torrent"_s);
+        QVERIFY(waitingJob);
+        QCOMPARE(waitingJob->job.feedURL, u"feed1"_s);
+        QVERIFY(!queue.contains(u"http://a/1.torrent"_s));
+        QVERIFY(queue.contains(u"http://a/2.torrent"_s));
+
+        // once added, the torrent can be queued again
+        QVERIFY(queue.add(u"http://a/1.torrent"_s, processingJob(u"feed2"_s), {}));
+    }
+
+    void testTorrentAddedWhileQueued() const
+    {
+        RSS::Private::FetchQueue queue {MAX_ATTEMPTS, RETRY_DELAY, MAX_FETCHES_PER_HOST};
+        queue.add(u"http://a/1.torrent"_s, processingJob(u"feed1"_s), {});
+        queue.add(u"http://a/2.torrent"_s, processingJob(u"feed1"_s), {});
+
+        // the same torrent is added from elsewhere before it is fetched
+        QVERIFY(queue.take(u"http://a/1.torrent"_s));
+        QCOMPARE(queue.takeReady(START_TIME), QList<QString>({u"http://a/2.torrent"_s}));
+        QVERIFY(!queue.nextAttemptTime());
+    }
+
+    void testTorrentFailed() const
+    {
+        RSS::Private::FetchQueue queue {MAX_ATTEMPTS, RETRY_DELAY, MAX_FETCHES_PER_HOST};
+        queue.add(u"http://a/1.torrent"_s, processingJob(u"feed1"_s), {});
+
+        // job that isn't being fetched can't fail
+        QVERIFY(!queue.retry(u"http://a/1.torrent"_s, START_TIME));
+        QVERIFY(!queue.retry(u"http://a/2.torrent"_s, START_TIME));
+        QVERIFY(queue.contains(u"http://a/1.torrent"_s));
+
+        auto currentTime = START_TIME;
+        std::chrono::seconds retryDelay = RETRY_DELAY;
+        for (int attempt = 1; attempt < MAX_ATTEMPTS; ++attempt)
+        {
+            QCOMPARE(queue.takeReady(currentTime), QList<QString>({u"http://a/1.torrent"_s}));
+            QCOMPARE(queue.job(u"http://a/1.torrent"_s)->attempts, attempt);
+
+            QVERIFY(queue.retry(u"http://a/1.torrent"_s, currentTime));
+            QVERIFY(queue.job(u"http://a/1.torrent"_s)->status == Status::Queued);
+            QVERIFY(queue.nextAttemptTime() == (currentTime + retryDelay));
+
+            // retry delay is doubled on each attempt
+            QVERIFY(queue.takeReady(currentTime + retryDelay - 1s).isEmpty());
+            currentTime += retryDelay;
+            retryDelay *= 2;
+        }
+
+        QCOMPARE(queue.takeReady(currentTime), QList<QString>({u"http://a/1.torrent"_s}));
+        QCOMPARE(queue.job(u"http://a/1.torrent"_s)->attempts, MAX_ATTEMPTS);
+
+        // giving up after the last attempt
+        QVERIFY(!queue.retry(u"http://a/1.torrent"_s, currentTime));
+        QVERIFY(!queue.contains(u"http://a/1.torrent"_s));
+        QVERIFY(!queue.nextAttemptTime());
+        QVERIFY(!queue.take(u"http://a/1.torrent"_s));
+    }
+
+    void testRetryKeepsOtherJobsReady() const
+    {
+        RSS::Private::FetchQueue queue {MAX_ATTEMPTS, RETRY_DELAY, MAX_FETCHES_PER_HOST};
+        queue.add(u"http://a/1.torrent"_s, processingJob(u"feed1"_s), {});
+        QCOMPARE(queue.takeReady(START_TIME), QList<QString>({u"http://a/1.torrent"_s}));
+        QVERIFY(queue.retry(u"http://a/1.torrent"_s, START_TIME));
+
+        queue.add(u"http://a/2.torrent"_s, processingJob(u"feed1"_s), {});
+        QVERIFY(queue.nextAttemptTime() == START_TIME);
+        QCOMPARE(queue.takeReady(START_TIME), QList<QString>({u"http://a/2.torrent"_s}));
+        QVERIFY(queue.nextAttemptTime() == (START_TIME + RETRY_DELAY));
+        QCOMPARE(queue.takeReady(START_TIME + RETRY_DELAY), QList<QString>({u"http://a/1.torrent"_s}));
+    }
+
+    void testHostFetchesLimit() const
+    {
+        RSS::Private::FetchQueue queue {MAX_ATTEMPTS, RETRY_DELAY, MAX_FETCHES_PER_HOST};
+        queue.add(u"http://a/1.torrent"_s, processingJob(u"feed1"_s), {});
+        queue.add(u"http://a/2.torrent"_s, processingJob(u"feed1"_s), {});
+        queue.add(u"http://a/3.torrent"_s, processingJob(u"feed1"_s), {});
+        queue.add(u"http://a:8080/1.torrent"_s, processingJob(u"feed1"_s), {});
+        queue.add(u"http://b/1.torrent"_s, processingJob(u"feed1"_s), {});
+
+        QCOMPARE(queue.takeReady(START_TIME), QList<QString>({u"http://a/1.torrent"_s, u"http://a/2.torrent"_s
+                , u"http://a:8080/1.torrent"_s, u"http://b/1.torrent"_s}));
+        // the job is blocked until any fetch from its host is finished
+        QVERIFY(!queue.nextAttemptTime());
+        QVERIFY(queue.takeReady(START_TIME).isEmpty());
+
+        queue.take(u"http://a:8080/1.torrent"_s);
+        QVERIFY(!queue.nextAttemptTime());
+
+        // failed fetch releases its slot as well
+        QVERIFY(queue.retry(u"http://a/1.torrent"_s, START_TIME));
+        QVERIFY(queue.nextAttemptTime() == START_TIME);
+        QCOMPARE(queue.takeReady(START_TIME), QList<QString>({u"http://a/3.torrent"_s}));
+
+        // retried job waits for both its delay and a free slot
+        QVERIFY(!queue.nextAttemptTime());
+        QVERIFY(queue.take(u"http://a/2.torrent"_s));
+        QVERIFY(queue.nextAttemptTime() == (START_TIME + RETRY_DELAY));
+        QCOMPARE(queue.takeReady(START_TIME + RETRY_DELAY), QList<QString>({u"http://a/1.torrent"_s}));
+    }
+
+    void testHostFetchDelay() const
+    {
+        RSS::Private::FetchQueue queue {MAX_ATTEMPTS, RETRY_DELAY, MAX_FETCHES_PER_HOST};
+        queue.setFetchDelay(10s);
+        queue.add(u"http://a/1.torrent"_s, processingJob(u"feed1"_s), {});
+        queue.add(u"http://a/2.torrent"_s, processingJob(u"feed1"_s), {});
+        queue.add(u"http://b/1.torrent"_s, processingJob(u"feed1"_s), {});
+
+        QCOMPARE(queue.takeReady(START_TIME), QList<QString>({u"http://a/1.torrent"_s, u"http://b/1.torrent"_s}));
+        QVERIFY(queue.nextAttemptTime() == (START_TIME + 10s));
+        QVERIFY(queue.takeReady(START_TIME + 9s).isEmpty());
+        QCOMPARE(queue.takeReady(START_TIME + 10s), QList<QString>({u"http://a/2.torrent"_s}));
+
+        // the spacing applies to the requests of finished fetches too
+        queue.take(u"http://a/1.torrent"_s);
+        queue.take(u"http://a/2.torrent"_s);
+        queue.add(u"http://a/3.torrent"_s, processingJob(u"feed1"_s), {});
+        QVERIFY(queue.nextAttemptTime() == (START_TIME + 20s));
+        QCOMPARE(queue.takeReady(START_TIME + 20s), QList<QString>({u"http://a/3.torrent"_s}));
+    }
+
+    void testReplaceFeedURL() const
+    {
+        RSS::Private::FetchQueue queue {MAX_ATTEMPTS, RETRY_DELAY, MAX_FETCHES_PER_HOST};
+        queue.add(u"http://a/1.torrent"_s, processingJob(u"feed1"_s), {});
+        queue.add(u"http://a/2.torrent"_s, processingJob(u"feed2"_s), {});
+
+        queue.replaceFeedURL(u"feed1"_s, u"feed3"_s);
+        QCOMPARE(queue.job(u"http://a/1.torrent"_s)->job.feedURL, u"feed3"_s);
+        QCOMPARE(queue.job(u"http://a/2.torrent"_s)->job.feedURL, u"feed2"_s);
+    }
+};
+
+QTEST_APPLESS_MAIN(TestRSSAutoDownloadFetchQueue)
+#include "testrssautodownloadfetchqueue.moc"
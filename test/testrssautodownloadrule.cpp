@@ -0,0 +1,126 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+
+#include <QDateTime>
+#include <QObject>
+#include <QRegularExpression>
+#include <QStringList>
+#include <QTest>
+#include <QVariantHash>
+
+#include "base/global.h"
+#include "base/rss/rss_article.h"
+#include "base/rss/rss_autodownloadrule.h"
+
+namespace
+{
+    RSS::SmartFilterSettings smartFilterSettings(const QString &filter = u"s(\\d+)e(\\d+)"_s)
+    {
+        const QString regex = u"(?:_|\\b)(?:%1)(?:_|\\b)"_s.arg(filter);
+        return {.episodeRegex = QRegularExpression(regex, QRegularExpression::CaseInsensitiveOption)
+                , .downloadRepacks = true};
+    }
+
+    QVariantHash articleData(const QString &title)
+    {
+        return {{RSS::Article::KeyTitle, title}, {RSS::Article::KeyDate, QDateTime::currentDateTime()}};
+    }
+
+    RSS::AutoDownloadRule smartFilterRule(const QStringList &previouslyMatchedEpisodes)
+    {
+        RSS::AutoDownloadRule rule {u"rule"_s};
+        rule.setUseSmartFilter(true);
+        rule.setPreviouslyMatchedEpisodes(previouslyMatchedEpisodes);
+        return rule;
+    }
+}
+
+class TestRSSAutoDownloadRule final : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(TestRSSAutoDownloadRule)
+
+public:
+    TestRSSAutoDownloadRule() = default;
+
+private slots:
+    void testLimitPreviouslyMatchedEpisodes() const
+    {
+        {
+            RSS::AutoDownloadRule rule = smartFilterRule({u"1x1"_s, u"1x2"_s, u"1x3"_s});
+            QVERIFY(!rule.limitPreviouslyMatchedEpisodes(0));
+            QCOMPARE(rule.previouslyMatchedEpisodes(), QStringList({u"1x1"_s, u"1x2"_s, u"1x3"_s}));
+            QVERIFY(!rule.limitPreviouslyMatchedEpisodes(3));
+            QCOMPARE(rule.previouslyMatchedEpisodes(), QStringList({u"1x1"_s, u"1x2"_s, u"1x3"_s}));
+        }
+
+        {
+            // the oldest episodes are dropped first
+            RSS::AutoDownloadRule rule = smartFilterRule({u"1x1"_s, u"1x2"_s, u"1x3"_s});
+            QVERIFY(rule.limitPreviouslyMatchedEpisodes(2));
+            QCOMPARE(rule.previouslyMatchedEpisodes(), QStringList({u"1x2"_s, u"1x3"_s}));
+
+            // dropped episodes don't prevent matching anymore
+            const RSS::SmartFilterSettings settings = smartFilterSettings();
+            QVERIFY(rule.matches(articleData(u"Show S01E01"_s), settings));
+            QVERIFY(!rule.matches(articleData(u"Show S01E02"_s), settings));
+            QVERIFY(!rule.matches(articleData(u"Show S01E03"_s), settings));
+        }
+
+        {
+            // newly accepted episodes are appended so they are dropped last
+            RSS::AutoDownloadRule rule = smartFilterRule({u"1x1"_s, u"1x2"_s});
+            QVERIFY(rule.accepts(articleData(u"Show S01E03"_s), smartFilterSettings()));
+            QVERIFY(rule.limitPreviouslyMatchedEpisodes(2));
+            QCOMPARE(rule.previouslyMatchedEpisodes(), QStringList({u"1x2"_s, u"1x3"_s}));
+        }
+    }
+
+    void testPreviouslyMatchedEpisodesCaseFolding() const
+    {
+        {
+            RSS::AutoDownloadRule rule = smartFilterRule({u"1x2"_s, u"1x2-repack"_s});
+            const RSS::SmartFilterSettings settings = smartFilterSettings();
+            QVERIFY(!rule.matches(articleData(u"Show S01E02 REPACK"_s), settings));
+            QVERIFY(rule.matches(articleData(u"Show S01E02 PROPER"_s), settings));
+        }
+
+        {
+            // episodes captured by custom filters are compared regardless of letter case as well
+            RSS::AutoDownloadRule rule = smartFilterRule({u"One"_s});
+            const RSS::SmartFilterSettings settings = smartFilterSettings(u"part\\.([a-z]+)"_s);
+            QVERIFY(!rule.matches(articleData(u"Show Part.ONE"_s), settings));
+            QVERIFY(!rule.matches(articleData(u"Show part.one"_s), settings));
+            QVERIFY(rule.matches(articleData(u"Show Part.Two"_s), settings));
+        }
+    }
+};
+
+QTEST_APPLESS_MAIN(TestRSSAutoDownloadRule)
+#include "testrssautodownloadrule.moc"
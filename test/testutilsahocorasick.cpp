@@ -0,0 +1,99 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include <QObject>
+#include <QTest>
+
+#include "base/global.h"
+#include "base/utils/ahocorasick.h"
+
+class TestUtilsAhoCorasick final : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(TestUtilsAhoCorasick)
+
+public:
+    TestUtilsAhoCorasick() = default;
+
+private slots:
+    void testFindAll() const
+    {
+        const Utils::AhoCorasick matcher {{u"he"_s, u"she"_s, u"his"_s, u"hers"_s}};
+        QCOMPARE(matcher.keywordsCount(), 4);
+
+        QCOMPARE(matcher.findAll(u"ushers"), (QList<qsizetype> {1, 0, 3}));
+        QCOMPARE(matcher.findAll(u"history"), (QList<qsizetype> {2}));
+        QCOMPARE(matcher.findAll(u"hehehe"), (QList<qsizetype> {0}));
+        QCOMPARE(matcher.findAll(u"xyz"), QList<qsizetype>());
+        QCOMPARE(matcher.findAll(u""), QList<qsizetype>());
+    }
+
+    void testOverlappingKeywords() const
+    {
+        const Utils::AhoCorasick matcher {{u"abcd"_s, u"bc"_s, u"c"_s, u"bcx"_s}};
+
+        QCOMPARE(matcher.findAll(u"abcx"), (QList<qsizetype> {1, 2, 3}));
+        QCOMPARE(matcher.findAll(u"abcd"), (QList<qsizetype> {1, 2, 0}));
+    }
+
+    void testDuplicateAndEmptyKeywords() const
+    {
+        const Utils::AhoCorasick matcher {{u"abc"_s, u""_s, u"abc"_s}};
+
+        QCOMPARE(matcher.findAll(u"xabcx"), (QList<qsizetype> {0, 2}));
+        QVERIFY(!matcher.containsAny(u"xyz"));
+
+        const Utils::AhoCorasick emptyMatcher;
+        QCOMPARE(emptyMatcher.keywordsCount(), 0);
+        QCOMPARE(emptyMatcher.findAll(u"abc"), QList<qsizetype>());
+        QVERIFY(!emptyMatcher.containsAny(u"abc"));
+    }
+
+    void testCaseSensitivity() const
+    {
+        const Utils::AhoCorasick caseSensitiveMatcher {{u"Ubuntu"_s}};
+        QVERIFY(caseSensitiveMatcher.containsAny(u"Ubuntu 24.04"));
+        QVERIFY(!caseSensitiveMatcher.containsAny(u"ubuntu 24.04"));
+
+        const Utils::AhoCorasick caseInsensitiveMatcher {{u"Ubuntu"_s, u"DEBIAN"_s}, Qt::CaseInsensitive};
+        QCOMPARE(caseInsensitiveMatcher.findAll(u"debian and UBUNTU"), (QList<qsizetype> {1, 0}));
+    }
+
+    void testContainsAny() const
+    {
+        const Utils::AhoCorasick matcher {{u"1080p"_s, u"720p"_s}};
+
+        QVERIFY(matcher.containsAny(u"Show.S01E01.720p.WEB"));
+        QVERIFY(matcher.containsAny(u"Show.S01E01.1080p.WEB"));
+        QVERIFY(!matcher.containsAny(u"Show.S01E01.480p.WEB"));
+        QVERIFY(!matcher.containsAny(u"Show.S01E01.1080.WEB"));
+    }
+};
+
+QTEST_APPLESS_MAIN(TestUtilsAhoCorasick)
+#include "testutilsahocorasick.moc"